@@ -0,0 +1,123 @@
+// Compact binary graph format, a CSR (compressed sparse row) adjacency of an undirected graph.
+//
+// All fields are little-endian:
+//
+//   header   24 bytes: magic 'ICSR', u32 version, u32 flags, u32 n, u32 m, u32 reserved
+//   offsets  int32[n + 1], edges of vertex v are targets[offsets[v]] ... targets[offsets[v + 1] - 1]
+//   targets  int32[m]
+//   weights  float32[m], only when flags has BINARY_GRAPH_WEIGHTS set
+//
+// Every undirected edge is stored once, under its first endpoint of the edges array. The offsets and
+// targets sections are laid out exactly as the loader expects them in module memory, so a file is
+// streamed there chunk by chunk without building a JS array of the edges.
+
+const BINARY_GRAPH_MAGIC = 0x52534349; // 'ICSR'
+const BINARY_GRAPH_VERSION = 1;
+const BINARY_GRAPH_HEADER_SIZE = 24;
+const BINARY_GRAPH_WEIGHTS = 1;
+
+// @edges: undirected edges list as in runCommunityDetection; @weights: optional weight of every edge
+function writeBinaryGraph(n, edges, weights = null) {
+    const m = edges.length / 2;
+
+    if (weights && weights.length !== m) {
+        throw new Error('writeBinaryGraph: weights length has to equal the number of edges.');
+    }
+
+    const size = BINARY_GRAPH_HEADER_SIZE + 4 * (n + 1 + m) + (weights ? 4 * m : 0);
+    const bytes = new Uint8Array(size);
+    const view = new DataView(bytes.buffer);
+
+    view.setUint32(0, BINARY_GRAPH_MAGIC, true);
+    view.setUint32(4, BINARY_GRAPH_VERSION, true);
+    view.setUint32(8, weights ? BINARY_GRAPH_WEIGHTS : 0, true);
+    view.setUint32(12, n, true);
+    view.setUint32(16, m, true);
+
+    // Counting sort of the edges by their first endpoint
+    const offsets = new Int32Array(n + 1);
+    for (let e = 0; e < m; e++) {
+        const from = edges[2 * e];
+        if (!(from >= 0 && from < n) || !(edges[2 * e + 1] >= 0 && edges[2 * e + 1] < n)) {
+            throw new Error(`writeBinaryGraph: edge ${e} has a vertex out of range [0, ${n}).`);
+        }
+        offsets[from + 1]++;
+    }
+    for (let v = 0; v < n; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    const offsetsStart = BINARY_GRAPH_HEADER_SIZE;
+    const targetsStart = offsetsStart + 4 * (n + 1);
+    const weightsStart = targetsStart + 4 * m;
+
+    for (let v = 0; v <= n; v++) {
+        view.setInt32(offsetsStart + 4 * v, offsets[v], true);
+    }
+
+    const next = offsets.slice(0, n);
+    for (let e = 0; e < m; e++) {
+        const i = next[edges[2 * e]]++;
+        view.setInt32(targetsStart + 4 * i, edges[2 * e + 1], true);
+        if (weights) {
+            view.setFloat32(weightsStart + 4 * i, weights[e], true);
+        }
+    }
+
+    return bytes;
+}
+
+function readBinaryGraphHeader(bytes) {
+    const view = new DataView(bytes.buffer, bytes.byteOffset, BINARY_GRAPH_HEADER_SIZE);
+
+    if (view.getUint32(0, true) !== BINARY_GRAPH_MAGIC) {
+        throw new Error('loadBinaryGraph: not a binary graph (bad magic).');
+    }
+
+    const version = view.getUint32(4, true);
+    if (version !== BINARY_GRAPH_VERSION) {
+        throw new Error(`loadBinaryGraph: unsupported format version ${version}.`);
+    }
+
+    return {
+        weighted: (view.getUint32(8, true) & BINARY_GRAPH_WEIGHTS) !== 0,
+        n: view.getUint32(12, true),
+        m: view.getUint32(16, true)
+    };
+}
+
+// Yields the source as Uint8Array chunks: a Buffer/typed array/ArrayBuffer, a Node.js readable stream
+// (or any async iterable) or a WHATWG ReadableStream such as the body of a fetch() response
+async function* binaryChunks(source) {
+    if (source instanceof ArrayBuffer) {
+        yield new Uint8Array(source);
+    } else if (ArrayBuffer.isView(source)) {
+        yield new Uint8Array(source.buffer, source.byteOffset, source.byteLength);
+    } else if (source && typeof source.getReader === 'function') {
+        const reader = source.getReader();
+        try {
+            for (;;) {
+                const { done, value } = await reader.read();
+                if (done) {
+                    break;
+                }
+                yield value;
+            }
+        } finally {
+            reader.releaseLock();
+        }
+    } else if (source && typeof source[Symbol.asyncIterator] === 'function') {
+        for await (const chunk of source) {
+            yield typeof chunk === 'string' ? Buffer.from(chunk, 'binary') : chunk;
+        }
+    } else {
+        throw new Error('loadBinaryGraph: expected a stream, an ArrayBuffer or a typed array.');
+    }
+}
+
+module.exports = {
+    BINARY_GRAPH_HEADER_SIZE,
+    writeBinaryGraph,
+    readBinaryGraphHeader,
+    binaryChunks
+};
@@ -13,12 +13,15 @@ LAPACK_SRC_FILES=`find igraph/src/lapack -name '*.c'`
 GLPK_SRC_FILES=`find igraph/optional/glpk \( -name '*.c' -o -name '*.cc' \)`
 WALKTRAP_FILES=`find igraph/src -maxdepth 1 -name 'walktrap*.cpp'`
 SPINGLASS_FILES="igraph/src/clustertool.cpp igraph/src/pottsmodel_2.cpp igraph/src/NetRoutines.cpp igraph/src/NetDataTypes.cpp"
+KMEANS_FILES="igraph/src/scg_kmeans.c" # the rest of scg is left out
 
-SRC_FILES="$F2C_SRC_FILES $MAIN_SRC_FILES $LAPACK_SRC_FILES $GLPK_SRC_FILES $WALKTRAP_FILES $SPINGLASS_FILES"
+SRC_FILES="$F2C_SRC_FILES $MAIN_SRC_FILES $LAPACK_SRC_FILES $GLPK_SRC_FILES $WALKTRAP_FILES $SPINGLASS_FILES $KMEANS_FILES"
 
 # default developement mode and asm.js
 ENV=dev
 WASM=1
+NATIVE=0
+SIMD=0
 
 #https://stackoverflow.com/questions/192249/how-do-i-parse-command-line-arguments-in-bash
 for i in "$@"; do
@@ -31,6 +34,14 @@ for i in "$@"; do
     WASM=0
     shift
     ;;
+    -n|--native)
+    NATIVE=1
+    shift
+    ;;
+    -s|--simd)
+    SIMD=1
+    shift
+    ;;
     *)
     echo "Unknown option: $i"
     ;;
@@ -47,22 +58,80 @@ else
   export DEBUG_OPTIONS="-g4 $DEBUG_FLAGS"
 fi
 
-if [[ $WASM == 0 ]]; then
+if [[ $NATIVE == 1 ]]; then
+  echo ">>> NATIVE MODE"
+  export OUT_DIR=dist/native
+  if [[ "$ENV" == dev ]]; then
+    export DEBUG_OPTIONS="-g $DEBUG_FLAGS" # -g4 is emcc only
+  fi
+elif [[ $WASM == 0 ]]; then
   echo ">>> ASM.JS MODE"
   export OUT_DIR=dist/asm
   export DEBUG_OPTIONS=$DEBUG_FLAGS # -g4 debug in asm.js mode not possible
+elif [[ $SIMD == 1 ]]; then
+  echo ">>> WASM SIMD MODE"
+  export OUT_DIR=dist/wasm-simd
 else
   echo ">>> WASM MODE"
   export OUT_DIR=dist/wasm
 fi
 
+# Vectorized kernels (igraph/src/igraph_simd_internal.h)
+if [[ $SIMD == 1 ]]; then
+  if [[ $WASM == 0 && $NATIVE == 0 ]]; then
+    echo "SIMD is not available in asm.js mode"
+    exit 1
+  fi
+  SIMD_OPTIONS="-DIGRAPH_SIMD"
+  if [[ $NATIVE == 0 ]]; then
+    SIMD_OPTIONS="$SIMD_OPTIONS -msimd128"
+  fi
+fi
+
 if [[ "$ENV" == dev ]]; then
   echo "debug options: $DEBUG_OPTIONS"
 fi
 
-export LDFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS}"
-export CFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS}"
-export CXXFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS}"
+export LDFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS} ${SIMD_OPTIONS}"
+export CFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS} ${SIMD_OPTIONS}"
+export CXXFLAGS="${OPTIMIZE_OPTIONS} ${DEBUG_OPTIONS} ${SIMD_OPTIONS}"
+
+if [[ $NATIVE == 1 ]]; then
+  # Node.js N-API addon from the same sources, compiled with the system compiler
+  NODE_INCLUDE=`node -p "require('path').resolve(process.execPath, '../../include/node')"`
+  OBJ_DIR=build/native
+  mkdir -p $OUT_DIR $OBJ_DIR
+
+  INCLUDES="-I $CURR_DIR/igraph/ -I $CURR_DIR/igraph/src -I $CURR_DIR/igraph/include/ \
+    -I $CURR_DIR/igraph/optional/glpk/ -I $NODE_INCLUDE"
+
+  OBJ_FILES=""
+  for SRC in $SRC_FILES; do
+    OBJ=$OBJ_DIR/`echo $SRC | tr '/' '_'`.o
+    case $SRC in
+      *.c) ${CC:-cc} ${CFLAGS} -fPIC $INCLUDES -c $SRC -o $OBJ || exit 1 ;;
+      *) ${CXX:-c++} ${CXXFLAGS} -fPIC $INCLUDES -c $SRC -o $OBJ || exit 1 ;;
+    esac
+    OBJ_FILES="$OBJ_FILES $OBJ"
+  done
+
+  # Linking through an archive leaves out the igraph modules the runners do not use,
+  # some of them reference sources excluded above
+  rm -f $OBJ_DIR/libigraph.a
+  ar rcs $OBJ_DIR/libigraph.a $OBJ_FILES || exit 1
+
+  # native/addon.c includes $SRC_MAIN
+  ${CC:-cc} ${CFLAGS} -fPIC $INCLUDES -c native/addon.c -o $OBJ_DIR/addon.o || exit 1
+
+  # Node.js symbols are resolved when the addon is loaded
+  if [[ `uname` == Darwin ]]; then
+    NATIVE_LDFLAGS="-undefined dynamic_lookup"
+  fi
+
+  ${CXX:-c++} ${LDFLAGS} -shared $NATIVE_LDFLAGS $OBJ_DIR/addon.o $OBJ_DIR/libigraph.a \
+    -o $OUT_DIR/community-detection.node
+  exit $?
+fi
 
 # Set EMCC_DEBUG=1 to see verbose emcc output
 # https://developers.google.com/web/updates/2019/01/emscripten-npm
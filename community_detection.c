@@ -1,9 +1,19 @@
 /* -*- mode: C -*-  */
 
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
 #include <igraph.h>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#else
+// Native addon build (native/addon.c), progress is forwarded to the JS handler by the addon
+#define EMSCRIPTEN_KEEPALIVE
+void native_progress_handler(igraph_real_t percent);
+#endif
 #include "config.h"
 #include "debug.h"
+#include "scg_headers.h"
 
 enum algorithm_name{
     EDGE_BETWEENNESS,
@@ -16,6 +26,9 @@ enum algorithm_name{
     OPTIMAL,
     SPINGLASS,
     WALKTRAP,
+    FLUID_COMMUNITIES,
+    HRG,
+    SPECTRAL,
 
     // MODIFICATIONS
 
@@ -93,144 +106,994 @@ size_t modularities_found_size;
 
 igraph_real_t membership_modularity_result;
 
+// hrg: parents in the consensus tree of the n vertices and of its k internal vertices, then the weights of these
+igraph_real_t* dendrogram_result;
+size_t dendrogram_size; // zero when the algorithm gives no dendrogram
+igraph_real_t dendrogram_loglikelihood;
+
+igraph_real_t* generated_edges_result;
+size_t generated_edges_size;
+igraph_real_t* planted_membership_result; // zero when the generator has no planted partition
+
+// modularity, coverage, then sizes, internal edges, external edges, conductance and density of every community
+igraph_real_t* score_result;
+
+// number of communities k, offsets of the n vertices and the end, then the communities of every vertex
+igraph_real_t* overlapping_result;
+size_t overlapping_size;
+
+// number of resolutions r run, quality, modularity and number of communities of each, then r memberships
+igraph_real_t* sweep_result;
+size_t sweep_size;
+
+// modularity of the consensus membership, the membership, then the stability of every vertex
+igraph_real_t* consensus_result;
+
+// personalized pagerank: k score vectors of n, or the conductance of k sweep cut communities, offsets of the k
+// communities and the end, then their vertices
+igraph_real_t* pagerank_result;
+size_t pagerank_size;
+
+// number of triangles, triangles and local clustering coefficient of the n vertices, then triangles of the m edges
+igraph_real_t* triangle_result;
+
+int arena_mode = 0; // igraph's scratch memory of a run comes from an arena released at its end
+
+int component_mode_min_size = 0; // positive runs the algorithm on every component of at least this many vertices
+
+int core_pruning_k = 0; // positive runs the algorithm on the k-core, the peeled vertices join a neighbor's community
+
+const igraph_real_t *edge_weights = 0; // positive weight of every edge of the next runs, zero for unweighted runs
+
+// A graph kept in module memory between runs (loadBinaryGraph), indexed once when it is loaded
+typedef struct {
+    igraph_t graph;
+    igraph_vector_t weights;  // of every edge, empty when the graph is unweighted
+    struct local_push *push;  // scratch of localCommunities, built by its first call on the graph
+} loaded_graph_t;
+
+loaded_graph_t *run_graph = 0; // graph of the next runs in place of their edges buffer, zero to use the buffer
+
 int progress_handler(const char *message, igraph_real_t percent, void* data) {
     IGRAPH_UNUSED(data);
 
+#ifdef __EMSCRIPTEN__
     EM_ASM({
         if (console && console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER) {
             console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER($0);
         }
     }, percent);
+#else
+    native_progress_handler(percent);
+#endif
 
     return IGRAPH_SUCCESS;
 }
 
-// ASSUMPTION: all graphs unweighted so far and undirected
-int runCommunityDetection(
-    enum algorithm_name algorithm,
-    igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
-    const igraph_real_t *seed_membership
-) {
-    igraph_set_progress_handler(progress_handler);
+// Endpoints of the edges of a run read without building a graph: interleaved in the edges buffer, or the from and
+// to vectors of the loaded graph set by setRunGraph
+typedef struct {
+    const igraph_real_t *from;
+    const igraph_real_t *to;
+    size_t stride;
+    size_t m;
+} run_edges_t;
+
+#define RUN_EDGE_FROM(edges, e) ((igraph_integer_t) (edges)->from[(e) * (edges)->stride])
+#define RUN_EDGE_TO(edges, e) ((igraph_integer_t) (edges)->to[(e) * (edges)->stride])
+
+static run_edges_t runEdges(const igraph_real_t *edges, size_t edges_len) {
+    run_edges_t run_edges;
+
+    if (run_graph != 0) {
+        run_edges.from = VECTOR(run_graph->graph.from);
+        run_edges.to = VECTOR(run_graph->graph.to);
+        run_edges.stride = 1;
+        run_edges.m = igraph_ecount(&run_graph->graph);
+    } else {
+        run_edges.from = edges;
+        run_edges.to = edges + 1;
+        run_edges.stride = 2;
+        run_edges.m = edges_len / 2;
+    }
+
+    return run_edges;
+}
+
+// Whether every edge endpoint is a vertex in [0, n); the edges of a loaded graph were checked by finishGraphLoader
+static int validRunEdges(igraph_integer_t n, const run_edges_t *run_edges) {
+    size_t e;
+
+    if (run_graph != 0) {
+        return 1;
+    }
+    for (e = 0; e < run_edges->m; e++) {
+        igraph_real_t from = run_edges->from[e * run_edges->stride], to = run_edges->to[e * run_edges->stride];
+        if (!(from >= 0 && from < n && to >= 0 && to < n)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Graph of a run on an edges buffer: the loaded graph set by setRunGraph, else @g created from the buffer, stored in
+// @graph. closeRunGraph destroys @g in the latter case only, a loaded graph is never changed by a run. Fails with
+// IGRAPH_EINVAL on an odd buffer length or an endpoint out of [0, n), which igraph_create would grow the graph for.
+static int openRunGraph(igraph_t *g, const igraph_t **graph, igraph_integer_t n, const igraph_real_t *edges,
+                        size_t edges_len) {
+    run_edges_t run_edges = runEdges(edges, edges_len);
+    igraph_vector_t edges_v;
+    int result;
+
+    if (run_graph != 0) {
+        *graph = &run_graph->graph;
+        return 0;
+    }
+    if (edges_len % 2 != 0 || !validRunEdges(n, &run_edges)) {
+        return IGRAPH_EINVAL;
+    }
 
-    // Init graph from edges
-    igraph_t g;
-    igraph_vector_t edges_v, degree;
     igraph_vector_view(&edges_v, edges, edges_len);
+    result = igraph_create(g, &edges_v, n, IGRAPH_UNDIRECTED);
+    if (result != 0) {
+        return result;
+    }
 
-    igraph_create(&g, &edges_v, n, IGRAPH_UNDIRECTED);
+    *graph = g;
+    return 0;
+}
 
-    // Init seed membership vector
-    igraph_vector_t seed_membership_v;
+static void closeRunGraph(igraph_t *g, const igraph_t *graph) {
+    if (graph == g) {
+        igraph_destroy(g);
+    }
+}
 
-    if (seed_membership != 0) {
-        igraph_vector_view(&seed_membership_v, seed_membership, n);
+// Optional parameters of the runners, zero means igraph's default
+typedef struct {
+    const igraph_real_t *seed_membership;
+
+    // weight of every edge of the graph run on, zero when unweighted; set from edge_weights by runCommunityDetection
+    const igraph_vector_t *weights;
+
+    // share of the edges, or of their weight, of the whole graph in the component of a per component run; the
+    // modularity based algorithms scale their resolution by it, so that they optimize the modularity of the whole
+    // graph. Zero for the whole graph.
+    igraph_real_t component_share;
+
+    // label propagation and fluid communities, update by color classes instead of one vertex at a time
+    int semi_synchronous;
+
+    // fluid communities and spectral, always set by their runners; a negative rng_seed keeps igraph's random
+    // state, also of hrg
+    int no_of_communities;
+    igraph_real_t rng_seed;
+
+    // spectral, columns of the embedding, zero is one per community
+    int dimensions;
+
+    // hrg, always set by its runner
+    int hrg_chains;
+    int hrg_steps;
+    int hrg_exchange_period;
+    int hrg_samples;
+
+    // leading eigenvector
+    igraph_real_t arpack_tol;
+    int arpack_ncv;
+
+    // spinglass, always set by its runner
+    int spins;
+    igraph_real_t start_temp;
+    igraph_real_t stop_temp;
+    igraph_real_t cool_fact;
+    igraph_real_t gamma;
+    int replicas;
+} run_options_t;
+
+static const run_options_t default_run_options;
+
+// Cut of a tree of highest modularity, every vertex of the tree is either a community or split into the
+// best cuts of its children; modularity adds up over the communities. Internal vertices have larger ids than their
+// children, so going up the ids visits the children first.
+static void treeCutMembership(const igraph_t *g, const igraph_vector_t *parents, igraph_vector_t *membership) {
+    long int no_of_nodes = igraph_vcount(g), no_of_edges = igraph_ecount(g);
+    long int size = igraph_vector_size(parents), i, e, no_of_communities = 0;
+    igraph_vector_t depth, internal, degree, best, children_best, head;
+
+    igraph_vector_init(&depth, size);
+    igraph_vector_init(&internal, size); // edges within the subtree
+    igraph_vector_init(&degree, size);
+    igraph_vector_init(&best, size);
+    igraph_vector_init(&children_best, size);
+    igraph_vector_init(&head, size); // the community of the cut the vertex is in
+
+    for (i = size - 1; i >= 0; i--) {
+        long int parent = VECTOR(*parents)[i];
+        VECTOR(depth)[i] = parent < 0 ? 0 : VECTOR(depth)[parent] + 1;
     }
 
-    // Init result structures
-    igraph_vector_t modularity, membership;
-    igraph_vector_init(&modularity, 0);
-    igraph_vector_init(&membership, 0);
+    // An edge is within the subtree of the lowest common ancestor of its ends and every one above it
+    for (e = 0; e < no_of_edges; e++) {
+        long int from = IGRAPH_FROM(g, e), to = IGRAPH_TO(g, e);
+
+        VECTOR(degree)[from] += 1;
+        VECTOR(degree)[to] += 1;
+        while (from != to && from >= 0 && to >= 0) {
+            if (VECTOR(depth)[from] < VECTOR(depth)[to]) {
+                to = VECTOR(*parents)[to];
+            } else {
+                from = VECTOR(*parents)[from];
+            }
+        }
+        if (from == to) {
+            VECTOR(internal)[from] += 1;
+        }
+    }
 
-    // Init max modularity
-    igraph_real_t max_modularity = -2; // -2 due to modularity is in range of [-1, 1]
+    for (i = 0; i < size; i++) {
+        long int parent = VECTOR(*parents)[i];
+        igraph_real_t a = VECTOR(degree)[i] / (2.0 * no_of_edges);
+        igraph_real_t q = VECTOR(internal)[i] / no_of_edges - a * a;
+
+        VECTOR(best)[i] = i >= no_of_nodes && VECTOR(children_best)[i] > q ? VECTOR(children_best)[i] : q;
+        if (parent >= 0) {
+            VECTOR(internal)[parent] += VECTOR(internal)[i];
+            VECTOR(degree)[parent] += VECTOR(degree)[i];
+            VECTOR(children_best)[parent] += VECTOR(best)[i];
+        }
+    }
+
+    // A vertex is split when its children do better, the first vertex not split going down is the community
+    for (i = size - 1; i >= 0; i--) {
+        long int parent = VECTOR(*parents)[i];
+        igraph_bool_t split = i >= no_of_nodes && VECTOR(best)[i] == VECTOR(children_best)[i];
+
+        if (parent >= 0 && VECTOR(head)[parent] >= 0) {
+            VECTOR(head)[i] = VECTOR(head)[parent];
+        } else {
+            VECTOR(head)[i] = split ? -1 : no_of_communities++;
+        }
+    }
+
+    igraph_vector_resize(membership, no_of_nodes);
+    for (i = 0; i < no_of_nodes; i++) {
+        VECTOR(*membership)[i] = VECTOR(head)[i];
+    }
+
+    igraph_vector_destroy(&head);
+    igraph_vector_destroy(&children_best);
+    igraph_vector_destroy(&best);
+    igraph_vector_destroy(&degree);
+    igraph_vector_destroy(&internal);
+    igraph_vector_destroy(&depth);
+}
 
+// The binary dendrogram of an HRG as a tree in the format of the consensus tree: vertices first, then the internal
+// vertices, renumbered in reverse breadth-first order from the root so that they follow their children
+static void hrgTreeParents(const igraph_hrg_t *hrg, igraph_vector_t *parents) {
+    long int n = igraph_hrg_size(hrg), root = 0, head = 0, tail = 0, i;
+    igraph_vector_long_t queue;
+    igraph_vector_bool_t is_child;
+
+    // The root is the internal vertex no other one has as a child
+    igraph_vector_bool_init(&is_child, n - 1);
+    for (i = 0; i < n - 1; i++) {
+        if (VECTOR(hrg->left)[i] < 0) {
+            VECTOR(is_child)[(long int) -VECTOR(hrg->left)[i] - 1] = 1;
+        }
+        if (VECTOR(hrg->right)[i] < 0) {
+            VECTOR(is_child)[(long int) -VECTOR(hrg->right)[i] - 1] = 1;
+        }
+    }
+    while (VECTOR(is_child)[root]) {
+        root++;
+    }
+    igraph_vector_bool_destroy(&is_child);
+
+    igraph_vector_long_init(&queue, n - 1);
+    VECTOR(queue)[tail++] = root;
+    igraph_vector_resize(parents, 2 * n - 1);
+    VECTOR(*parents)[2 * n - 2] = -1;
+    while (head < tail) {
+        long int internal = VECTOR(queue)[head], id = 2 * n - 2 - head, c;
+
+        head++;
+        for (c = 0; c < 2; c++) {
+            long int child = c == 0 ? VECTOR(hrg->left)[internal] : VECTOR(hrg->right)[internal];
+
+            if (child >= 0) {
+                VECTOR(*parents)[child] = id;
+            } else {
+                VECTOR(*parents)[2 * n - 2 - tail] = id;
+                VECTOR(queue)[tail++] = -child - 1;
+            }
+        }
+    }
+    igraph_vector_long_destroy(&queue);
+}
+
+// Spectral clustering: the vertices are embedded by the eigenvectors of the largest eigenvalues of D^-1/2 A D^-1/2,
+// the rows are scaled to unit length and split into k clusters by k-means. Isolated vertices have no embedding, they
+// are a community each.
+static void spectralMembership(const igraph_t *g, int k, int dimensions, igraph_vector_t *membership) {
+    igraph_integer_t n = igraph_vcount(g), sub_n;
+    igraph_vector_t degree, isolated, centers, sub_membership;
+    igraph_vector_int_t labels;
+    igraph_matrix_t embedding;
+    igraph_arpack_options_t options;
+    igraph_t sub_g;
+    igraph_real_t norm;
+    long int i, c, v, next_id;
+
+    igraph_vector_init(&degree, 0);
+    igraph_degree(g, &degree, igraph_vss_all(), IGRAPH_ALL, /*loops*/ 1);
+    igraph_vector_init(&isolated, 0);
+    for (v = 0; v < n; v++) {
+        if (VECTOR(degree)[v] == 0) {
+            igraph_vector_push_back(&isolated, v);
+        }
+    }
+
+    // Deleting keeps the order of the other vertices
+    igraph_copy(&sub_g, g);
+    igraph_delete_vertices(&sub_g, igraph_vss_vector(&isolated));
+    igraph_vector_destroy(&isolated);
+    sub_n = igraph_vcount(&sub_g);
+
+    // ARPACK needs fewer eigenvalues than vertices
+    if (k > sub_n) {
+        k = sub_n;
+    }
+    if (dimensions <= 0) {
+        dimensions = k;
+    }
+    if (dimensions >= sub_n) {
+        dimensions = sub_n > 1 ? sub_n - 1 : 1;
+    }
+
+    igraph_vector_init(&sub_membership, sub_n);
+    if (k > 1) {
+        igraph_matrix_init(&embedding, 0, 0);
+        igraph_arpack_options_init(&options);
+        igraph_laplacian_spectral_embedding(&sub_g, dimensions, /*weights*/ 0, IGRAPH_EIGEN_LA, IGRAPH_ALL,
+                                            IGRAPH_EMBEDDING_DAD, /*scaled*/ 0, &embedding, /*Y*/ 0, /*D*/ 0,
+                                            &options);
+
+        for (i = 0; i < sub_n; i++) {
+            norm = 0;
+            for (c = 0; c < dimensions; c++) {
+                norm += MATRIX(embedding, i, c) * MATRIX(embedding, i, c);
+            }
+            if (norm > 0) {
+                norm = 1 / sqrt(norm);
+                for (c = 0; c < dimensions; c++) {
+                    MATRIX(embedding, i, c) *= norm;
+                }
+            }
+        }
+
+        // The matrix is column major, as k-means expects
+        igraph_vector_init(&centers, 0);
+        igraph_vector_int_init(&labels, sub_n);
+        igraph_i_kmeans_plusplus(&embedding.data, sub_n, dimensions, &centers, k, VECTOR(labels), /*maxiter*/ 100);
+        for (i = 0; i < sub_n; i++) {
+            VECTOR(sub_membership)[i] = VECTOR(labels)[i];
+        }
+        igraph_vector_int_destroy(&labels);
+        igraph_vector_destroy(&centers);
+        igraph_matrix_destroy(&embedding);
+
+        // k-means may leave a cluster empty
+        igraph_reindex_membership(&sub_membership, 0, 0);
+    }
+    igraph_destroy(&sub_g);
+
+    igraph_vector_resize(membership, n);
+    next_id = sub_n > 0 ? igraph_vector_max(&sub_membership) + 1 : 0;
+    for (v = 0, i = 0; v < n; v++) {
+        VECTOR(*membership)[v] = VECTOR(degree)[v] > 0 ? VECTOR(sub_membership)[i++] : next_id++;
+    }
+    igraph_vector_destroy(&sub_membership);
+    igraph_vector_destroy(&degree);
+}
+
+// Runs the algorithm on g, max_modularity is left at -2 when the algorithm reports modularity instead
+static int runAlgorithm(
+    enum algorithm_name algorithm, const igraph_t *g, igraph_vector_t *seed_membership,
+    const run_options_t *run_options,
+    igraph_vector_t *membership, igraph_vector_t *modularity, igraph_real_t *max_modularity
+) {
     // Algorithm specific variables
     igraph_real_t codelength; // for infomap
 
     igraph_integer_t nb_clusters; // for leiden
+    igraph_vector_t degree;
 
     igraph_arpack_options_t options; // for leading_eigenvector
 
     igraph_matrix_t merges; // for walktrap
 
+    igraph_t simple_g; // for fluid communities
+    igraph_integer_t no_of_communities;
+
+    igraph_hrg_t hrg; // for hrg
+    igraph_vector_t parents, tree_weights, tree_parents;
+    long int no_of_nodes = igraph_vcount(g);
+
+    const igraph_vector_t *weights = run_options->weights;
+    igraph_real_t resolution = run_options->component_share > 0 ? run_options->component_share : 1;
+    int result = 0;
+
     // Run algorithm
     switch(algorithm) {
         case EDGE_BETWEENNESS:
-            igraph_community_edge_betweenness(&g, 0, 0, 0, 0, &modularity, &membership, IGRAPH_UNDIRECTED, 0);
+            result = igraph_community_edge_betweenness(g, 0, 0, 0, 0, modularity, membership, IGRAPH_UNDIRECTED, 0);
             break;
         case FAST_GREEDY:
-            igraph_community_fastgreedy(&g, 0, 0, &modularity, &membership);
+            result = igraph_community_fastgreedy(g, weights, 0, modularity, membership);
             break;
         case INFOMAP:
             // Consider nb_trials as parameter
-            igraph_community_infomap(&g, 0, 0, /*nb_trials*/ 5, &membership, &codelength);
-            igraph_modularity(&g, &membership, &max_modularity, 0);
+            result = igraph_community_infomap(g, weights, 0, /*nb_trials*/ 5, membership, &codelength);
+            if (result == 0) {
+                result = igraph_modularity(g, membership, max_modularity, weights);
+            }
             break;
         case LABEL_PROPAGATION:
-            igraph_community_label_propagation(&g, &membership, 0, /*initial*/ 0, /*fixed*/ 0, &max_modularity);
+            if (run_options->semi_synchronous) {
+                result = igraph_community_label_propagation_semisync(g, membership, weights, /*initial*/ 0,
+                                                                     /*fixed*/ 0, max_modularity);
+            } else {
+                result = igraph_community_label_propagation(g, membership, weights, /*initial*/ 0, /*fixed*/ 0,
+                                                            max_modularity);
+            }
             break;
         case LEADING_EIGENVECTOR:
             igraph_arpack_options_init(&options);
+            options.tol = run_options->arpack_tol;
+            options.ncv = run_options->arpack_ncv;
 
             // Consider steps as parameter; when steps == -1 then automatically should be set to number of vertices
-            igraph_community_leading_eigenvector(&g, /*weights*/ 0, /*merges*/ 0, &membership, /*steps*/ -1,
-                                                 /*options*/ &options, &max_modularity, /*start*/ 0, /*eigenvalues*/ 0,
-                                                 /*eigenvectors*/ 0, /*history*/ 0, /*callback*/ 0,
-                                                 /*callback_extra*/ 0);
+            result = igraph_community_leading_eigenvector(g, weights, /*merges*/ 0, membership, /*steps*/ -1,
+                                                          /*options*/ &options, max_modularity, /*start*/ 0,
+                                                          /*eigenvalues*/ 0, /*eigenvectors*/ 0, /*history*/ 0,
+                                                          /*callback*/ 0, /*callback_extra*/ 0);
             break;
         case LOUVAIN:
-            igraph_community_multilevel(&g, 0, &membership, 0, &modularity);
+            result = igraph_community_multilevel_resolution(g, weights, resolution, membership, 0, modularity);
             break;
         case LEIDEN:
-            igraph_vector_init(&degree, igraph_vcount(&g));
-            igraph_degree(&g, &degree, igraph_vss_all(), IGRAPH_ALL, 1);
+            igraph_vector_init(&degree, igraph_vcount(g));
+            igraph_strength(g, &degree, igraph_vss_all(), IGRAPH_ALL, 1, weights);
 
-            // Consider parameters to add, this one is modularity based approach
-            igraph_community_leiden(&g, NULL, &degree, 1.0 / (2 * igraph_ecount(&g)), 0.01, 0,
-                                    &membership, &nb_clusters, &max_modularity);
+            // Consider parameters to add, this one is modularity based approach; the degrees sum to twice the
+            // total edge weight
+            result = igraph_community_leiden(g, weights, &degree, resolution / igraph_vector_sum(&degree), 0.01, 0,
+                                             membership, &nb_clusters, max_modularity);
 
             igraph_vector_destroy(&degree);
             break;
         case OPTIMAL:
-            igraph_community_optimal_modularity(&g, &max_modularity, &membership, /*weights*/ 0);
+            result = igraph_community_optimal_modularity_resolution(g, resolution, max_modularity, membership, weights);
             break;
         case SPINGLASS:
-            // Consider spins, starttemp, stoptemp, coolfact, update_rule, gamma as parameters
-            igraph_community_spinglass(&g, /*weights*/ 0, &max_modularity, /*temperature*/ 0, &membership,
-                                       /*csize*/ 0, /*spins*/ 25, /*parallel update*/ 0, /*start temperature*/ 1.0,
-                                       /*stop temperature*/ 0.01, /*cooling factor*/ 0.99,
-                                       IGRAPH_SPINCOMM_UPDATE_CONFIG, /*gamma*/ 1.0,
-                                       IGRAPH_SPINCOMM_IMP_ORIG, /*gamma-=*/ 0);
+            // Replicas share the network and the start temperature, modularity of each one is reported
+            result = igraph_community_spinglass_replicas(g, weights, max_modularity, /*temperature*/ 0, membership,
+                                                         /*csize*/ 0, run_options->spins, /*parallel update*/ 0,
+                                                         run_options->start_temp, run_options->stop_temp,
+                                                         run_options->cool_fact, IGRAPH_SPINCOMM_UPDATE_CONFIG,
+                                                         resolution * run_options->gamma, run_options->replicas,
+                                                         modularity);
             break;
         case WALKTRAP:
             igraph_matrix_init(&merges, 0, 0);
 
             // Consider steps as parameter
-            igraph_community_walktrap(&g, /*wights*/ 0, /*steps*/ 4, &merges, &modularity, &membership);
+            result = igraph_community_walktrap(g, weights, /*steps*/ 4, &merges, modularity, membership);
 
             igraph_matrix_destroy(&merges);
             break;
+        case FLUID_COMMUNITIES:
+            // At most one community per vertex, a component of a per component run may be smaller than k
+            no_of_communities = run_options->no_of_communities;
+            if (no_of_communities > igraph_vcount(g)) {
+                no_of_communities = igraph_vcount(g);
+            }
+
+            // Fluid communities accepts simple graphs only, modularity is still of the original graph
+            igraph_copy(&simple_g, g);
+            igraph_simplify(&simple_g, /*multiple*/ 1, /*loops*/ 1, /*edge_comb*/ 0);
+            if (run_options->semi_synchronous) {
+                result = igraph_community_fluid_communities_semisync(&simple_g, no_of_communities, membership, 0);
+            } else {
+                result = igraph_community_fluid_communities(&simple_g, no_of_communities, membership, 0);
+            }
+            igraph_destroy(&simple_g);
+
+            if (result == 0) {
+                result = igraph_modularity(g, membership, max_modularity, 0);
+            }
+            break;
+
+
+        case HRG:
+            if (no_of_nodes < 3) {
+                igraph_vector_resize(membership, no_of_nodes);
+                igraph_vector_null(membership);
+                igraph_modularity(g, membership, max_modularity, 0);
+                break;
+            }
+
+            igraph_hrg_init(&hrg, no_of_nodes);
+            igraph_vector_init(&parents, 0);
+            igraph_vector_init(&tree_weights, 0);
+            result = igraph_hrg_fit_chains(g, &hrg, &parents, &tree_weights, run_options->hrg_chains,
+                                           run_options->hrg_steps, run_options->hrg_exchange_period,
+                                           run_options->hrg_samples, &dendrogram_loglikelihood);
+            if (result != 0) {
+                igraph_vector_destroy(&tree_weights);
+                igraph_vector_destroy(&parents);
+                igraph_hrg_destroy(&hrg);
+                break;
+            }
+
+            // The consensus tree is the dendrogram result
+            destroyBuffer(dendrogram_result);
+            dendrogram_size = igraph_vector_size(&parents) + igraph_vector_size(&tree_weights);
+            dendrogram_result = createBuffer(dendrogram_size);
+            igraph_vector_copy_to(&parents, dendrogram_result);
+            igraph_vector_copy_to(&tree_weights, dendrogram_result + igraph_vector_size(&parents));
+
+            // The consensus tree merges uncertain splits into many-way vertices, whose vertex children would be
+            // singletons in any cut, so the communities come from the best binary dendrogram
+            igraph_vector_init(&tree_parents, 0);
+            hrgTreeParents(&hrg, &tree_parents);
+            treeCutMembership(g, &tree_parents, membership);
+            igraph_vector_destroy(&tree_parents);
+            igraph_modularity(g, membership, max_modularity, 0);
+
+            igraph_vector_destroy(&tree_weights);
+            igraph_vector_destroy(&parents);
+            igraph_hrg_destroy(&hrg);
+            break;
+        case SPECTRAL:
+            spectralMembership(g, run_options->no_of_communities, run_options->dimensions, membership);
+            igraph_modularity(g, membership, max_modularity, 0);
+            break;
 
 
         // MODIFICATIONS
 
         case FAST_GREEDY_SEED:
-            igraph_community_fastgreedy_seed(&g, 0, 0, &modularity, &membership, &seed_membership_v);
+            result = igraph_community_fastgreedy_seed(g, 0, 0, modularity, membership, seed_membership);
             break;
 
         case LOUVAIN_SEED:
-            igraph_community_multilevel_seed(&g, 0, &membership, 0, &modularity,
-                                             &seed_membership_v, /*meta nodes first*/ 1);
+            result = igraph_community_multilevel_seed(g, weights, membership, 0, modularity,
+                                                      seed_membership, /*meta nodes first*/ 1);
             break;
 
         case EDGE_BETWEENNESS_SEED:
-            igraph_community_edge_betweenness_seed(&g, 0, 0, 0, 0, &modularity, &membership,
-                                                   IGRAPH_UNDIRECTED, 0, &seed_membership_v);
+            result = igraph_community_edge_betweenness_seed(g, 0, 0, 0, 0, modularity, membership,
+                                                            IGRAPH_UNDIRECTED, 0, seed_membership);
             break;
         default:
             return 1;
     }
 
+    return result;
+}
+
+// Runs the algorithm on every connected component with at least component_mode_min_size vertices, the smaller
+// ones are a community each. Community ids of the components follow each other, modularity is of the whole graph.
+static int runPerComponent(
+    enum algorithm_name algorithm, const igraph_t *g, igraph_vector_t *seed_membership,
+    const run_options_t *run_options,
+    igraph_vector_t *membership, igraph_vector_t *modularity, igraph_real_t *max_modularity
+) {
+    igraph_integer_t n = igraph_vcount(g), m = igraph_ecount(g);
+    igraph_integer_t no_of_components, no_of_seeds = 0, nb_clusters, next_id = 0;
+    igraph_vector_t components, sizes, vertex_start, vertices, local_ids, edge_start, edges;
+    igraph_vector_t sub_edges, sub_membership, sub_modularity, sub_seed_membership, seed_ids;
+    igraph_vector_t weights, sub_weights;
+    igraph_real_t sub_max_modularity, total_weight;
+    run_options_t sub_options = *run_options;
+    igraph_t sub_g;
+    long int c, i, v, e;
+    int result = 0;
+
+    igraph_vector_init(&components, 0);
+    igraph_vector_init(&sizes, 0);
+    igraph_clusters(g, &components, &sizes, &no_of_components, IGRAPH_WEAK);
+
+    // Vertices grouped by component, the position in the group is the id in the component graph
+    igraph_vector_init(&vertex_start, no_of_components + 1);
+    igraph_vector_init(&vertices, n);
+    igraph_vector_init(&local_ids, 0);
+    for (c = 0; c < no_of_components; c++) {
+        VECTOR(vertex_start)[c + 1] = VECTOR(vertex_start)[c] + VECTOR(sizes)[c];
+    }
+    igraph_vector_update(&local_ids, &vertex_start); // next free position of every component
+    for (v = 0; v < n; v++) {
+        long int pos = VECTOR(local_ids)[(long int) VECTOR(components)[v]]++;
+        VECTOR(vertices)[pos] = v;
+    }
+    igraph_vector_resize(&local_ids, n);
+    for (c = 0; c < no_of_components; c++) {
+        long int start = VECTOR(vertex_start)[c];
+        for (i = 0; i < VECTOR(sizes)[c]; i++) {
+            VECTOR(local_ids)[(long int) VECTOR(vertices)[start + i]] = i;
+        }
+    }
+
+    // Edges grouped by component, with the vertex ids of the component graph, and their weights
+    igraph_vector_init(&edge_start, no_of_components + 1);
+    igraph_vector_init(&edges, 2 * m);
+    igraph_vector_init(&weights, run_options->weights != 0 ? m : 0);
+    for (e = 0; e < m; e++) {
+        VECTOR(edge_start)[(long int) VECTOR(components)[IGRAPH_FROM(g, e)] + 1] += 1;
+    }
+    for (c = 0; c < no_of_components; c++) {
+        VECTOR(edge_start)[c + 1] += VECTOR(edge_start)[c];
+    }
+    for (e = 0; e < m; e++) {
+        long int from = IGRAPH_FROM(g, e);
+        long int pos = VECTOR(edge_start)[(long int) VECTOR(components)[from]]++;
+        VECTOR(edges)[2 * pos] = VECTOR(local_ids)[from];
+        VECTOR(edges)[2 * pos + 1] = VECTOR(local_ids)[(long int) IGRAPH_TO(g, e)];
+        if (run_options->weights != 0) {
+            VECTOR(weights)[pos] = VECTOR(*run_options->weights)[e];
+        }
+    }
+    for (c = no_of_components; c > 0; c--) {
+        VECTOR(edge_start)[c] = VECTOR(edge_start)[c - 1];
+    }
+    VECTOR(edge_start)[0] = 0;
+    total_weight = run_options->weights != 0 ? igraph_vector_sum(&weights) : m;
+
+    // Seed communities are renumbered from zero in every component
+    if (seed_membership != 0) {
+        no_of_seeds = n > 0 ? igraph_vector_max(seed_membership) + 1 : 0;
+    }
+    igraph_vector_init(&seed_ids, no_of_seeds > 0 ? no_of_seeds : 0);
+    igraph_vector_fill(&seed_ids, -1);
+    igraph_vector_init(&sub_seed_membership, 0);
+
+    igraph_vector_init(&sub_membership, 0);
+    igraph_vector_init(&sub_modularity, 0);
+    igraph_vector_resize(membership, n);
+
+    for (c = 0; c < no_of_components && result == 0; c++) {
+        long int start = VECTOR(vertex_start)[c], size = VECTOR(sizes)[c];
+
+        if (size < component_mode_min_size || size < 2) {
+            for (i = 0; i < size; i++) {
+                VECTOR(*membership)[(long int) VECTOR(vertices)[start + i]] = next_id;
+            }
+            next_id++;
+            continue;
+        }
+
+        igraph_vector_view(&sub_edges, VECTOR(edges) + 2 * (long int) VECTOR(edge_start)[c],
+                           2 * (long int) (VECTOR(edge_start)[c + 1] - VECTOR(edge_start)[c]));
+        igraph_create(&sub_g, &sub_edges, size, IGRAPH_UNDIRECTED);
+        if (run_options->weights != 0) {
+            igraph_vector_view(&sub_weights, VECTOR(weights) + (long int) VECTOR(edge_start)[c],
+                               (long int) (VECTOR(edge_start)[c + 1] - VECTOR(edge_start)[c]));
+            sub_options.weights = &sub_weights;
+            sub_options.component_share = igraph_vector_sum(&sub_weights) / total_weight;
+        } else {
+            sub_options.component_share = (VECTOR(edge_start)[c + 1] - VECTOR(edge_start)[c]) / total_weight;
+        }
+
+        if (seed_membership != 0) {
+            igraph_integer_t next_seed_id = 0;
+
+            igraph_vector_resize(&sub_seed_membership, size);
+            for (i = 0; i < size; i++) {
+                long int seed_id = VECTOR(*seed_membership)[(long int) VECTOR(vertices)[start + i]];
+                if (seed_id >= 0 && VECTOR(seed_ids)[seed_id] < 0) {
+                    VECTOR(seed_ids)[seed_id] = next_seed_id++;
+                }
+                VECTOR(sub_seed_membership)[i] = seed_id >= 0 ? VECTOR(seed_ids)[seed_id] : -1;
+            }
+            for (i = 0; i < size; i++) {
+                long int seed_id = VECTOR(*seed_membership)[(long int) VECTOR(vertices)[start + i]];
+                if (seed_id >= 0) {
+                    VECTOR(seed_ids)[seed_id] = -1;
+                }
+            }
+        }
+
+        sub_max_modularity = -2;
+        igraph_vector_clear(&sub_modularity);
+        result = runAlgorithm(algorithm, &sub_g, seed_membership != 0 ? &sub_seed_membership : 0, &sub_options,
+                              &sub_membership, &sub_modularity, &sub_max_modularity);
+
+        if (result == 0) {
+            igraph_reindex_membership(&sub_membership, 0, &nb_clusters);
+            for (i = 0; i < size; i++) {
+                VECTOR(*membership)[(long int) VECTOR(vertices)[start + i]] = next_id + VECTOR(sub_membership)[i];
+            }
+            next_id += nb_clusters;
+        }
+
+        igraph_destroy(&sub_g);
+    }
+
+    if (result == 0) {
+        igraph_vector_clear(modularity);
+        igraph_modularity(g, membership, max_modularity, run_options->weights);
+    }
+
+    igraph_vector_destroy(&sub_modularity);
+    igraph_vector_destroy(&sub_membership);
+    igraph_vector_destroy(&sub_seed_membership);
+    igraph_vector_destroy(&seed_ids);
+    igraph_vector_destroy(&weights);
+    igraph_vector_destroy(&edges);
+    igraph_vector_destroy(&edge_start);
+    igraph_vector_destroy(&local_ids);
+    igraph_vector_destroy(&vertices);
+    igraph_vector_destroy(&vertex_start);
+    igraph_vector_destroy(&sizes);
+    igraph_vector_destroy(&components);
+
+    return result;
+}
+
+static int runOnGraph(
+    enum algorithm_name algorithm, const igraph_t *g, igraph_vector_t *seed_membership,
+    const run_options_t *run_options,
+    igraph_vector_t *membership, igraph_vector_t *modularity, igraph_real_t *max_modularity
+) {
+    if (component_mode_min_size > 0) {
+        return runPerComponent(algorithm, g, seed_membership, run_options, membership, modularity, max_modularity);
+    }
+    return runAlgorithm(algorithm, g, seed_membership, run_options, membership, modularity, max_modularity);
+}
+
+// Runs the algorithm on the core_pruning_k-core only. The peeled vertices get the community of the neighbor they
+// are reached from by a breadth-first search starting at the core; those without a path to the core are a community
+// per component. An empty core, or one of the whole graph, runs the algorithm on the whole graph.
+static int runOnCore(
+    enum algorithm_name algorithm, const igraph_t *g, igraph_vector_t *seed_membership,
+    const run_options_t *run_options,
+    igraph_vector_t *membership, igraph_vector_t *modularity, igraph_real_t *max_modularity
+) {
+    igraph_integer_t n = igraph_vcount(g), m = igraph_ecount(g);
+    igraph_integer_t no_of_seeds = 0, nb_clusters;
+    igraph_vector_t coreness, core_ids, core_edges, core_weights, core_membership, core_seed_membership, seed_ids;
+    run_options_t core_options = *run_options;
+    igraph_dqueue_t queue;
+    igraph_adjlist_t adjlist;
+    igraph_real_t core_max_modularity = -2;
+    igraph_t core_g;
+    long int core_n = 0, i, v, e;
+    int result;
+
+    igraph_vector_init(&coreness, 0);
+    igraph_coreness(g, &coreness, IGRAPH_ALL);
+
+    // Id of every core vertex in the core graph, -1 for the peeled ones
+    igraph_vector_init(&core_ids, n);
+    for (v = 0; v < n; v++) {
+        VECTOR(core_ids)[v] = VECTOR(coreness)[v] >= core_pruning_k ? core_n++ : -1;
+    }
+    igraph_vector_destroy(&coreness);
+
+    if (core_n == 0 || core_n == n) {
+        igraph_vector_destroy(&core_ids);
+        return runOnGraph(algorithm, g, seed_membership, run_options, membership, modularity, max_modularity);
+    }
+
+    igraph_vector_init(&core_edges, 0);
+    igraph_vector_init(&core_weights, 0);
+    igraph_vector_reserve(&core_edges, 2 * m);
+    for (e = 0; e < m; e++) {
+        long int from = VECTOR(core_ids)[(long int) IGRAPH_FROM(g, e)], to = VECTOR(core_ids)[(long int) IGRAPH_TO(g, e)];
+        if (from >= 0 && to >= 0) {
+            igraph_vector_push_back(&core_edges, from);
+            igraph_vector_push_back(&core_edges, to);
+            if (run_options->weights != 0) {
+                igraph_vector_push_back(&core_weights, VECTOR(*run_options->weights)[e]);
+            }
+        }
+    }
+    if (run_options->weights != 0) {
+        core_options.weights = &core_weights;
+    }
+    igraph_create(&core_g, &core_edges, core_n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&core_edges);
+
+    // Seed communities of the core vertices, renumbered from zero
+    igraph_vector_init(&core_seed_membership, 0);
+    if (seed_membership != 0) {
+        igraph_integer_t next_seed_id = 0;
+
+        no_of_seeds = n > 0 ? igraph_vector_max(seed_membership) + 1 : 0;
+        igraph_vector_init(&seed_ids, no_of_seeds > 0 ? no_of_seeds : 0);
+        igraph_vector_fill(&seed_ids, -1);
+        igraph_vector_resize(&core_seed_membership, core_n);
+        for (v = 0; v < n; v++) {
+            long int core_id = VECTOR(core_ids)[v], seed_id = VECTOR(*seed_membership)[v];
+            if (core_id < 0) {
+                continue;
+            }
+            if (seed_id >= 0 && VECTOR(seed_ids)[seed_id] < 0) {
+                VECTOR(seed_ids)[seed_id] = next_seed_id++;
+            }
+            VECTOR(core_seed_membership)[core_id] = seed_id >= 0 ? VECTOR(seed_ids)[seed_id] : -1;
+        }
+        igraph_vector_destroy(&seed_ids);
+    }
+
+    igraph_vector_init(&core_membership, 0);
+    result = runOnGraph(algorithm, &core_g, seed_membership != 0 ? &core_seed_membership : 0, &core_options,
+                        &core_membership, modularity, &core_max_modularity);
+    igraph_destroy(&core_g);
+    igraph_vector_destroy(&core_weights);
+    igraph_vector_destroy(&core_seed_membership);
+
+    if (result != 0) {
+        igraph_vector_destroy(&core_membership);
+        igraph_vector_destroy(&core_ids);
+        return result;
+    }
+
+    igraph_reindex_membership(&core_membership, 0, &nb_clusters);
+
+    // Breadth-first search from the core, every peeled vertex joins the community of the vertex it is reached from
+    igraph_vector_resize(membership, n);
+    igraph_dqueue_init(&queue, n);
+    for (v = 0; v < n; v++) {
+        long int core_id = VECTOR(core_ids)[v];
+        VECTOR(*membership)[v] = core_id >= 0 ? VECTOR(core_membership)[core_id] : -1;
+        if (core_id >= 0) {
+            igraph_dqueue_push(&queue, v);
+        }
+    }
+    igraph_vector_destroy(&core_membership);
+    igraph_vector_destroy(&core_ids);
+
+    igraph_adjlist_init(g, &adjlist, IGRAPH_ALL);
+    for (i = 0; i <= n; i++) {
+        // A vertex without a path to the core starts a new community when the queue runs empty
+        while (!igraph_dqueue_empty(&queue)) {
+            long int from = igraph_dqueue_pop(&queue);
+            igraph_vector_int_t *neighbors = igraph_adjlist_get(&adjlist, from);
+            long int j, degree = igraph_vector_int_size(neighbors);
+
+            for (j = 0; j < degree; j++) {
+                long int to = VECTOR(*neighbors)[j];
+                if (VECTOR(*membership)[to] < 0) {
+                    VECTOR(*membership)[to] = VECTOR(*membership)[from];
+                    igraph_dqueue_push(&queue, to);
+                }
+            }
+        }
+        if (i < n && VECTOR(*membership)[i] < 0) {
+            VECTOR(*membership)[i] = nb_clusters++;
+            igraph_dqueue_push(&queue, i);
+        }
+    }
+    igraph_adjlist_destroy(&adjlist);
+    igraph_dqueue_destroy(&queue);
+
+    igraph_vector_clear(modularity);
+    igraph_modularity(g, membership, max_modularity, run_options->weights);
+
+    return 0;
+}
+
+// ASSUMPTION: all graphs undirected; weighted when edge_weights is set, for the algorithms taking weights only
+int runCommunityDetection(
+    enum algorithm_name algorithm,
+    igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+    const run_options_t *run_options
+) {
+    const igraph_real_t *seed_membership = run_options->seed_membership;
+    run_options_t weighted_options = *run_options;
+    igraph_vector_t weights_v;
+    int result;
+
+    if (edge_weights != 0) {
+        switch (algorithm) {
+            case EDGE_BETWEENNESS:
+            case EDGE_BETWEENNESS_SEED:
+            case FAST_GREEDY_SEED:
+            case FLUID_COMMUNITIES:
+            case HRG:
+            case SPECTRAL:
+                return 1;
+            default:
+                break;
+        }
+    }
+
+    igraph_set_progress_handler(progress_handler);
+
+    if (arena_mode) {
+        igraph_memory_arena_begin();
+    }
+
+    // Init graph from edges, or the loaded graph
+    igraph_t graph;
+    const igraph_t *g;
+
+    result = openRunGraph(&graph, &g, n, edges, edges_len);
+    if (result != 0) {
+        if (arena_mode) {
+            igraph_memory_arena_end();
+        }
+        return result;
+    }
+
+    if (edge_weights != 0) {
+        igraph_vector_view(&weights_v, edge_weights, igraph_ecount(g));
+        weighted_options.weights = &weights_v;
+        run_options = &weighted_options;
+    }
+
+    // Init seed membership vector
+    igraph_vector_t seed_membership_v;
+
+    if (seed_membership != 0) {
+        igraph_vector_view(&seed_membership_v, seed_membership, n);
+    }
+
+    // Init result structures
+    igraph_vector_t modularity, membership;
+    igraph_vector_init(&modularity, 0);
+    igraph_vector_init(&membership, 0);
+
+    // Init max modularity
+    igraph_real_t max_modularity = -2; // -2 due to modularity is in range of [-1, 1]
+
+    // Seeded once, a per component run draws the components from one random sequence
+    if ((algorithm == FLUID_COMMUNITIES || algorithm == HRG || algorithm == SPECTRAL) && run_options->rng_seed >= 0) {
+        igraph_rng_seed(igraph_rng_default(), (unsigned long) run_options->rng_seed);
+    }
+
+    // Run algorithm
+    if (core_pruning_k > 0) {
+        result = runOnCore(algorithm, g, seed_membership != 0 ? &seed_membership_v : 0, run_options,
+                           &membership, &modularity, &max_modularity);
+    } else {
+        result = runOnGraph(algorithm, g, seed_membership != 0 ? &seed_membership_v : 0, run_options,
+                            &membership, &modularity, &max_modularity);
+    }
+
+    // The dendrograms of the components are not joined, nor do they hold the peeled vertices
+    if (component_mode_min_size > 0 || core_pruning_k > 0) {
+        destroyBuffer(dendrogram_result);
+        dendrogram_result = 0;
+        dendrogram_size = 0;
+    }
+
+    if (result != 0) {
+        igraph_vector_destroy(&membership);
+        igraph_vector_destroy(&modularity);
+        closeRunGraph(&graph, g);
+        if (arena_mode) {
+            igraph_memory_arena_end();
+        }
+        return result;
+    }
+
     if (max_modularity != -2) {
-        igraph_vector_push_back(&modularity, max_modularity);
+        if (igraph_vector_empty(&modularity)) {
+            igraph_vector_push_back(&modularity, max_modularity);
+        }
     } else {
         max_modularity = VECTOR(modularity)[igraph_vector_which_max(&modularity)];
     }
 
     membership_modularity_result = max_modularity;
 
-    IGRAPH_DEBUG(show_results(&g, &modularity, 0, &membership, seed_membership != 0 ? &seed_membership_v : 0, stdout));
+    IGRAPH_DEBUG(show_results((igraph_t *) g, &modularity, 0, &membership, seed_membership != 0 ? &seed_membership_v : 0, stdout));
 
     // Copy result to C arrays
     membership_result = createBuffer(igraph_vector_size(&membership));
@@ -245,7 +1108,11 @@ int runCommunityDetection(
     igraph_vector_destroy(&modularity);
 
     // Destroy graph
-    igraph_destroy(&g);
+    closeRunGraph(&graph, g);
+
+    if (arena_mode) {
+        igraph_memory_arena_end();
+    }
 
     return 0;
 }
@@ -255,52 +1122,99 @@ int runCommunityDetection(
 
 EMSCRIPTEN_KEEPALIVE
 int edgeBetweenness(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(EDGE_BETWEENNESS, n, edges, edges_len, 0);
+    return runCommunityDetection(EDGE_BETWEENNESS, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int fastGreedy(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(FAST_GREEDY, n, edges, edges_len, 0);
+    return runCommunityDetection(FAST_GREEDY, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int infomap(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(INFOMAP, n, edges, edges_len, 0);
+    return runCommunityDetection(INFOMAP, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
-int labelPropagation(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(LABEL_PROPAGATION, n, edges, edges_len, 0);
+int labelPropagation(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len, int semi_synchronous) {
+    run_options_t options = default_run_options;
+    options.semi_synchronous = semi_synchronous;
+    return runCommunityDetection(LABEL_PROPAGATION, n, edges, edges_len, &options);
 }
 
 EMSCRIPTEN_KEEPALIVE
-int leadingEigenvector(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(LEADING_EIGENVECTOR, n, edges, edges_len, 0);
+int leadingEigenvector(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                       igraph_real_t arpack_tol, int arpack_ncv) {
+    run_options_t options = default_run_options;
+    options.arpack_tol = arpack_tol;
+    options.arpack_ncv = arpack_ncv;
+    return runCommunityDetection(LEADING_EIGENVECTOR, n, edges, edges_len, &options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int louvain(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(LOUVAIN, n, edges, edges_len, 0);
+    return runCommunityDetection(LOUVAIN, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int leiden(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(LEIDEN, n, edges, edges_len, 0);
+    return runCommunityDetection(LEIDEN, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int optimal(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(OPTIMAL, n, edges, edges_len, 0);
+    return runCommunityDetection(OPTIMAL, n, edges, edges_len, &default_run_options);
 }
 
 EMSCRIPTEN_KEEPALIVE
-int spinglass(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(SPINGLASS, n, edges, edges_len, 0);
+int spinglass(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+              int spins, igraph_real_t start_temp, igraph_real_t stop_temp,
+              igraph_real_t cool_fact, igraph_real_t gamma, int replicas) {
+    run_options_t options = default_run_options;
+    options.spins = spins;
+    options.start_temp = start_temp;
+    options.stop_temp = stop_temp;
+    options.cool_fact = cool_fact;
+    options.gamma = gamma;
+    options.replicas = replicas;
+    return runCommunityDetection(SPINGLASS, n, edges, edges_len, &options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int walktrap(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
-    return runCommunityDetection(WALKTRAP, n, edges, edges_len, 0);
+    return runCommunityDetection(WALKTRAP, n, edges, edges_len, &default_run_options);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int fluidCommunities(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                     int no_of_communities, igraph_real_t rng_seed, int semi_synchronous) {
+    run_options_t options = default_run_options;
+    options.no_of_communities = no_of_communities;
+    options.rng_seed = rng_seed;
+    options.semi_synchronous = semi_synchronous;
+    return runCommunityDetection(FLUID_COMMUNITIES, n, edges, edges_len, &options);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int hrg(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+        int chains, int steps, int exchange_period, int samples, igraph_real_t rng_seed) {
+    run_options_t options = default_run_options;
+    options.hrg_chains = chains;
+    options.hrg_steps = steps;
+    options.hrg_exchange_period = exchange_period;
+    options.hrg_samples = samples;
+    options.rng_seed = rng_seed;
+    return runCommunityDetection(HRG, n, edges, edges_len, &options);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int spectral(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+             int no_of_communities, int dimensions, igraph_real_t rng_seed) {
+    run_options_t options = default_run_options;
+    options.no_of_communities = no_of_communities;
+    options.dimensions = dimensions;
+    options.rng_seed = rng_seed;
+    return runCommunityDetection(SPECTRAL, n, edges, edges_len, &options);
 }
 
 // MODIFICATIONS
@@ -308,19 +1222,25 @@ int walktrap(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
 EMSCRIPTEN_KEEPALIVE
 int fastGreedySeed(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
                    const igraph_real_t *seed_membership) {
-    return runCommunityDetection(FAST_GREEDY_SEED, n, edges, edges_len, seed_membership);
+    run_options_t options = default_run_options;
+    options.seed_membership = seed_membership;
+    return runCommunityDetection(FAST_GREEDY_SEED, n, edges, edges_len, &options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int louvainSeed(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
                 const igraph_real_t *seed_membership) {
-    return runCommunityDetection(LOUVAIN_SEED, n, edges, edges_len, seed_membership);
+    run_options_t options = default_run_options;
+    options.seed_membership = seed_membership;
+    return runCommunityDetection(LOUVAIN_SEED, n, edges, edges_len, &options);
 }
 
 EMSCRIPTEN_KEEPALIVE
 int edgeBetweennessSeed(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
                         const igraph_real_t *seed_membership) {
-    return runCommunityDetection(EDGE_BETWEENNESS_SEED, n, edges, edges_len, seed_membership);
+    run_options_t options = default_run_options;
+    options.seed_membership = seed_membership;
+    return runCommunityDetection(EDGE_BETWEENNESS_SEED, n, edges, edges_len, &options);
 }
 
 // Compare communities API
@@ -354,21 +1274,1925 @@ igraph_real_t compareCommunitiesARI(const igraph_real_t *c1, const igraph_real_t
     return compareCommunities(c1, c2, len, IGRAPH_COMMCMP_ADJUSTED_RAND);
 }
 
-// Helpers
+// Partition quality API
 
+// Scores a membership vector with community ids in [0, no_of_communities) in a single pass over the edges, weighted
+// by edge_weights when set. Returns 1 when an id or an edge endpoint is out of range; loops count as internal edges,
+// as in igraph_modularity.
 EMSCRIPTEN_KEEPALIVE
-igraph_real_t* getMembershipPointer() {
-    return membership_result;
-}
+int scoreMembership(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                    const igraph_real_t *membership, igraph_integer_t no_of_communities,
+                    igraph_real_t resolution) {
+    run_edges_t run_edges = runEdges(edges, edges_len);
+    igraph_real_t *sizes, *internal, *external, *conductance, *density;
+    igraph_real_t m = 0, internal_sum = 0, modularity = 0;
+    igraph_integer_t c, v;
+    size_t e;
+
+    for (v = 0; v < n; v++) {
+        if (membership[v] < 0 || membership[v] >= no_of_communities) {
+            return 1;
+        }
+    }
+    if (!validRunEdges(n, &run_edges)) {
+        return 1;
+    }
 
-EMSCRIPTEN_KEEPALIVE
-double* getModularitiesFoundPointer() {
-    return modularities_found_result;
-}
+    score_result = calloc(2 + 5 * (size_t) no_of_communities, sizeof(igraph_real_t));
+    sizes = score_result + 2;
+    internal = sizes + no_of_communities;
+    external = internal + no_of_communities;
+    conductance = external + no_of_communities;
+    density = conductance + no_of_communities;
 
-EMSCRIPTEN_KEEPALIVE
-size_t getModularitiesFoundSize() {
-    return modularities_found_size;
+    for (v = 0; v < n; v++) {
+        sizes[(igraph_integer_t) membership[v]] += 1;
+    }
+
+    for (e = 0; e < run_edges.m; e++) {
+        igraph_integer_t c1 = membership[RUN_EDGE_FROM(&run_edges, e)];
+        igraph_integer_t c2 = membership[RUN_EDGE_TO(&run_edges, e)];
+        igraph_real_t w = edge_weights != 0 ? edge_weights[e] : 1;
+
+        m += w;
+        if (c1 == c2) {
+            internal[c1] += w;
+        } else {
+            external[c1] += w;
+            external[c2] += w;
+        }
+    }
+
+    for (c = 0; c < no_of_communities; c++) {
+        igraph_real_t volume = 2 * internal[c] + external[c];
+        igraph_real_t cut_volume = volume < 2 * m - volume ? volume : 2 * m - volume;
+        igraph_real_t pairs = sizes[c] * (sizes[c] - 1) / 2;
+
+        internal_sum += internal[c];
+        modularity += internal[c] / m - resolution * (volume / 2 / m) * (volume / 2 / m);
+        conductance[c] = cut_volume > 0 ? external[c] / cut_volume : 0;
+        density[c] = pairs > 0 ? internal[c] / pairs : 0;
+    }
+
+    score_result[0] = m > 0 ? modularity : IGRAPH_NAN;
+    score_result[1] = m > 0 ? internal_sum / m : IGRAPH_NAN;
+
+    return 0;
+}
+
+// Overlapping communities API
+
+// igraph_maximal_cliques_callback goes over the vertices in order of coreness and reports every clique from its
+// first vertex in that order, as the first vertex of the clique, together with later vertices only. Once the cliques
+// of a vertex are reported, it is in no later clique. The index of a vertex therefore keeps the cliques that can
+// still share k - 1 vertices with a later one only until then, and one clique of every community afterwards.
+typedef struct {
+    igraph_integer_t k;
+    igraph_vector_int_t parent; // union-find over the cliques
+    igraph_vector_int_t overlap; // vertices an earlier clique shares with the current one, valid when stamp matches
+    igraph_vector_int_t stamp;
+    igraph_vector_int_t live; // vertices of every clique whose cliques are not all reported yet
+    igraph_vector_int_t owner; // last vertex a clique was added to the communities of, as the root of its community
+    igraph_vector_int_t *cliques; // cliques of every vertex with at least k - 1 live vertices
+    igraph_vector_int_t *communities; // a clique of every community of every vertex, possibly more once they merge
+    long int current; // first vertex of the cliques reported last, -1 before the first one
+} clique_percolation_t;
+
+static long int findClique(igraph_vector_int_t *parent, long int c) {
+    while (VECTOR(*parent)[c] != c) {
+        VECTOR(*parent)[c] = VECTOR(*parent)[VECTOR(*parent)[c]]; // path halving
+        c = VECTOR(*parent)[c];
+    }
+    return c;
+}
+
+static void addCliqueCommunity(clique_percolation_t *cp, long int v, long int c) {
+    long int root = findClique(&cp->parent, c);
+
+    if (VECTOR(cp->owner)[root] != v) {
+        VECTOR(cp->owner)[root] = v;
+        igraph_vector_int_push_back(&cp->communities[v], c);
+    }
+}
+
+// All the cliques of @v are reported: they lose a live vertex, @v keeps their communities only
+static void finishCliqueVertex(clique_percolation_t *cp, long int v) {
+    igraph_vector_int_t *cliques = &cp->cliques[v];
+    long int i;
+
+    for (i = 0; i < igraph_vector_int_size(cliques); i++) {
+        VECTOR(cp->live)[VECTOR(*cliques)[i]] -= 1;
+        addCliqueCommunity(cp, v, VECTOR(*cliques)[i]);
+    }
+    igraph_vector_int_destroy(cliques);
+    igraph_vector_int_init(cliques, 0);
+}
+
+// Called with every maximal clique of at least k vertices, joins it with the earlier cliques it shares k - 1 of
+// them with. An earlier clique with less than k - 1 live vertices cannot share that many with this one or any later
+// one, it leaves the index of the vertices it is found at.
+static igraph_bool_t cliquePercolationHandler(igraph_vector_t *clique, void *arg) {
+    clique_percolation_t *cp = arg;
+    long int id = igraph_vector_int_size(&cp->parent), size = igraph_vector_size(clique), i, j, kept;
+
+    if (VECTOR(*clique)[0] != cp->current) {
+        if (cp->current >= 0) {
+            finishCliqueVertex(cp, cp->current);
+        }
+        cp->current = VECTOR(*clique)[0];
+    }
+
+    igraph_vector_int_push_back(&cp->parent, id);
+    igraph_vector_int_push_back(&cp->overlap, 0);
+    igraph_vector_int_push_back(&cp->stamp, -1);
+    igraph_vector_int_push_back(&cp->live, size);
+    igraph_vector_int_push_back(&cp->owner, -1);
+
+    for (i = 0; i < size; i++) {
+        long int v = VECTOR(*clique)[i];
+        igraph_vector_int_t *cliques = &cp->cliques[v];
+
+        for (j = 0, kept = 0; j < igraph_vector_int_size(cliques); j++) {
+            long int c = VECTOR(*cliques)[j];
+            if (VECTOR(cp->live)[c] < cp->k - 1) {
+                addCliqueCommunity(cp, v, c);
+                continue;
+            }
+            VECTOR(*cliques)[kept++] = c;
+
+            if (VECTOR(cp->stamp)[c] != id) {
+                VECTOR(cp->stamp)[c] = id;
+                VECTOR(cp->overlap)[c] = 0;
+            }
+            if (++VECTOR(cp->overlap)[c] == cp->k - 1) {
+                VECTOR(cp->parent)[findClique(&cp->parent, c)] = findClique(&cp->parent, id);
+            }
+        }
+        igraph_vector_int_resize(cliques, kept);
+        igraph_vector_int_push_back(cliques, id);
+    }
+
+    igraph_vector_destroy(clique);
+    igraph_free(clique);
+
+    return 1;
+}
+
+static int compareIds(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+// k-clique percolation: communities are the unions of k-cliques reachable from each other through k-cliques sharing
+// k - 1 vertices, the same as of the maximal cliques of at least k vertices sharing k - 1. Cliques are streamed, a
+// vertex in no k-clique is in no community. Multiple edges and loops are ignored.
+EMSCRIPTEN_KEEPALIVE
+int cliquePercolation(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len, igraph_integer_t k) {
+    igraph_t g;
+    const igraph_t *graph;
+    igraph_vector_int_t community, stamp, result;
+    clique_percolation_t cp;
+    long int v, i, no_of_communities = 0;
+    int status;
+
+    if (k < 2) {
+        return 1;
+    }
+
+    // Simplified in place, a loaded graph is copied first
+    status = openRunGraph(&g, &graph, n, edges, edges_len);
+    if (status != 0) {
+        return status;
+    }
+    if (graph != &g) {
+        status = igraph_copy(&g, graph);
+        if (status != 0) {
+            return status;
+        }
+    }
+    status = igraph_simplify(&g, /*multiple*/ 1, /*loops*/ 1, /*edge_comb*/ 0);
+    if (status != 0) {
+        igraph_destroy(&g);
+        return status;
+    }
+
+    cp.k = k;
+    cp.current = -1;
+    igraph_vector_int_init(&cp.parent, 0);
+    igraph_vector_int_init(&cp.overlap, 0);
+    igraph_vector_int_init(&cp.stamp, 0);
+    igraph_vector_int_init(&cp.live, 0);
+    igraph_vector_int_init(&cp.owner, 0);
+    cp.cliques = calloc(n > 0 ? n : 1, sizeof(igraph_vector_int_t));
+    cp.communities = calloc(n > 0 ? n : 1, sizeof(igraph_vector_int_t));
+    for (v = 0; v < n; v++) {
+        igraph_vector_int_init(&cp.cliques[v], 0);
+        igraph_vector_int_init(&cp.communities[v], 0);
+    }
+
+    status = igraph_maximal_cliques_callback(&g, cliquePercolationHandler, &cp, /*min_size*/ k, /*max_size*/ 0);
+
+    // Vertices without cliques of their own are never seen as the first vertex of one
+    for (v = 0; v < n && status == 0; v++) {
+        finishCliqueVertex(&cp, v);
+    }
+
+    if (status != 0) {
+        for (v = 0; v < n; v++) {
+            igraph_vector_int_destroy(&cp.communities[v]);
+            igraph_vector_int_destroy(&cp.cliques[v]);
+        }
+        free(cp.communities);
+        free(cp.cliques);
+        igraph_vector_int_destroy(&cp.owner);
+        igraph_vector_int_destroy(&cp.live);
+        igraph_vector_int_destroy(&cp.stamp);
+        igraph_vector_int_destroy(&cp.overlap);
+        igraph_vector_int_destroy(&cp.parent);
+        igraph_destroy(&g);
+        return status;
+    }
+
+    // Communities are numbered in the order of their first vertex
+    igraph_vector_int_init(&community, igraph_vector_int_size(&cp.parent));
+    igraph_vector_int_fill(&community, -1);
+    igraph_vector_int_init(&stamp, 0); // vertex that got the community last
+    igraph_vector_int_init(&result, n + 1);
+
+    for (v = 0; v < n; v++) {
+        long int start = igraph_vector_int_size(&result);
+
+        for (i = 0; i < igraph_vector_int_size(&cp.communities[v]); i++) {
+            long int root = findClique(&cp.parent, VECTOR(cp.communities[v])[i]);
+
+            if (VECTOR(community)[root] < 0) {
+                VECTOR(community)[root] = no_of_communities++;
+                igraph_vector_int_push_back(&stamp, -1);
+            }
+            if (VECTOR(stamp)[VECTOR(community)[root]] != v) {
+                VECTOR(stamp)[VECTOR(community)[root]] = v;
+                igraph_vector_int_push_back(&result, VECTOR(community)[root]);
+            }
+        }
+        VECTOR(result)[v] = start - (n + 1);
+        qsort(VECTOR(result) + start, igraph_vector_int_size(&result) - start, sizeof(int), compareIds);
+        igraph_vector_int_destroy(&cp.communities[v]);
+        igraph_vector_int_destroy(&cp.cliques[v]);
+    }
+    VECTOR(result)[n] = igraph_vector_int_size(&result) - (n + 1);
+
+    overlapping_size = 1 + igraph_vector_int_size(&result);
+    overlapping_result = createBuffer(overlapping_size);
+    overlapping_result[0] = no_of_communities;
+    for (i = 0; i < igraph_vector_int_size(&result); i++) {
+        overlapping_result[i + 1] = VECTOR(result)[i];
+    }
+
+    free(cp.communities);
+    free(cp.cliques);
+    igraph_vector_int_destroy(&result);
+    igraph_vector_int_destroy(&stamp);
+    igraph_vector_int_destroy(&community);
+    igraph_vector_int_destroy(&cp.owner);
+    igraph_vector_int_destroy(&cp.live);
+    igraph_vector_int_destroy(&cp.stamp);
+    igraph_vector_int_destroy(&cp.overlap);
+    igraph_vector_int_destroy(&cp.parent);
+    igraph_destroy(&g);
+
+    return 0;
+}
+
+
+// Resolution sweep API
+
+// Runs Leiden for every resolution in order, each run starts from the partition of the previous one. The objective
+// is modularity (cpm == 0), with the resolution scaling the null model, or the constant Potts model. A positive
+// stable_steps stops once the partition has not changed for that many resolutions.
+EMSCRIPTEN_KEEPALIVE
+int resolutionSweep(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                    const igraph_real_t *resolutions, size_t resolutions_len, int cpm, int stable_steps) {
+    igraph_t graph;
+    const igraph_t *g;
+    igraph_vector_t degree, membership, previous, qualities, memberships;
+    igraph_integer_t nb_clusters;
+    igraph_real_t quality, modularity;
+    long int r, count = 0, unchanged = 0;
+    size_t m;
+    int result;
+
+    igraph_set_progress_handler(progress_handler);
+
+    result = openRunGraph(&graph, &g, n, edges, edges_len);
+    if (result != 0) {
+        return result;
+    }
+    m = igraph_ecount(g);
+
+    // Modularity weighs the vertices by degree, CPM by one
+    igraph_vector_init(&degree, 0);
+    if (!cpm) {
+        igraph_degree(g, &degree, igraph_vss_all(), IGRAPH_ALL, /*loops*/ 1);
+    }
+
+    igraph_vector_init(&membership, n);
+    igraph_vector_init(&previous, 0);
+    igraph_vector_init(&qualities, 0);
+    igraph_vector_init(&memberships, 0);
+    igraph_vector_reserve(&qualities, 3 * resolutions_len);
+    igraph_vector_reserve(&memberships, (size_t) n * resolutions_len);
+
+    for (r = 0; r < (long int) resolutions_len && (stable_steps <= 0 || unchanged < stable_steps); r++) {
+        igraph_real_t resolution = resolutions[r];
+        if (!cpm && m > 0) {
+            resolution /= 2.0 * m;
+        }
+
+        result = igraph_community_leiden(g, /*edge_weights*/ 0, cpm ? 0 : &degree, resolution, /*beta*/ 0.01,
+                                         /*start*/ r > 0, &membership, &nb_clusters, &quality);
+        if (result != 0) {
+            break;
+        }
+
+        // Community ids by first vertex, equal partitions have equal memberships
+        igraph_reindex_membership(&membership, 0, &nb_clusters);
+        result = igraph_modularity(g, &membership, &modularity, 0);
+        if (result != 0) {
+            break;
+        }
+
+        unchanged = r > 0 && igraph_vector_all_e(&membership, &previous) ? unchanged + 1 : 0;
+        igraph_vector_update(&previous, &membership);
+
+        igraph_vector_push_back(&qualities, quality);
+        igraph_vector_push_back(&qualities, modularity);
+        igraph_vector_push_back(&qualities, nb_clusters);
+        igraph_vector_append(&memberships, &membership);
+        count++;
+
+        progress_handler(0, 100.0 * (r + 1) / resolutions_len, 0);
+    }
+
+    // A failed run leaves no result behind
+    if (result == 0) {
+        sweep_size = 1 + 3 * count + (size_t) n * count;
+        sweep_result = createBuffer(sweep_size);
+        sweep_result[0] = count;
+        igraph_vector_copy_to(&qualities, sweep_result + 1);
+        igraph_vector_copy_to(&memberships, sweep_result + 1 + 3 * count);
+    }
+
+    igraph_vector_destroy(&memberships);
+    igraph_vector_destroy(&qualities);
+    igraph_vector_destroy(&previous);
+    igraph_vector_destroy(&membership);
+    igraph_vector_destroy(&degree);
+    closeRunGraph(&graph, g);
+
+    return result;
+}
+
+// Consensus clustering API
+
+// Runs the algorithm, one of the randomized ones without options, replicates times and weighs every edge by the fraction of the runs putting its endpoints
+// together. The edges of a weight below threshold are dropped and the weighted graph is clustered by Louvain.
+// The stability of a vertex is the mean agreement of the runs with the consensus over its edges: the weight of
+// an edge inside its consensus community, one minus the weight of an edge leaving it; one without edges.
+EMSCRIPTEN_KEEPALIVE
+int consensusCommunities(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len, int algorithm,
+                         int replicates, igraph_real_t threshold, igraph_real_t rng_seed) {
+    igraph_t graph, consensus_g;
+    const igraph_t *g;
+    igraph_vector_t membership, modularity, together, consensus_edges, weights, stability, incident;
+    igraph_real_t max_modularity;
+    igraph_integer_t m;
+    long int r, e, v;
+    int result = 0;
+
+    if (replicates < 1 || (algorithm != INFOMAP && algorithm != LABEL_PROPAGATION && algorithm != LOUVAIN &&
+                           algorithm != LEIDEN)) {
+        return 1;
+    }
+
+    igraph_set_progress_handler(progress_handler);
+
+    result = openRunGraph(&graph, &g, n, edges, edges_len);
+    if (result != 0) {
+        return result;
+    }
+    m = igraph_ecount(g);
+
+    if (rng_seed >= 0) {
+        igraph_rng_seed(igraph_rng_default(), (unsigned long) rng_seed);
+    }
+
+    // Runs putting the endpoints of every edge in one community
+    igraph_vector_init(&together, m);
+    igraph_vector_init(&membership, 0);
+    igraph_vector_init(&modularity, 0);
+    for (r = 0; r < replicates && result == 0; r++) {
+        igraph_vector_clear(&modularity);
+        result = runAlgorithm(algorithm, g, 0, &default_run_options, &membership, &modularity, &max_modularity);
+
+        for (e = 0; e < m && result == 0; e++) {
+            if (VECTOR(membership)[(long int) IGRAPH_FROM(g, e)] == VECTOR(membership)[(long int) IGRAPH_TO(g, e)]) {
+                VECTOR(together)[e] += 1;
+            }
+        }
+
+        progress_handler(0, 100.0 * (r + 1) / replicates, 0);
+    }
+    igraph_vector_destroy(&modularity);
+
+    if (result != 0) {
+        igraph_vector_destroy(&membership);
+        igraph_vector_destroy(&together);
+        closeRunGraph(&graph, g);
+        return result;
+    }
+
+    igraph_vector_scale(&together, 1.0 / replicates);
+
+    // Consensus graph of the edges kept by most runs
+    igraph_vector_init(&consensus_edges, 0);
+    igraph_vector_init(&weights, 0);
+    for (e = 0; e < m; e++) {
+        if (VECTOR(together)[e] >= threshold && VECTOR(together)[e] > 0) {
+            igraph_vector_push_back(&consensus_edges, IGRAPH_FROM(g, e));
+            igraph_vector_push_back(&consensus_edges, IGRAPH_TO(g, e));
+            igraph_vector_push_back(&weights, VECTOR(together)[e]);
+        }
+    }
+    result = igraph_create(&consensus_g, &consensus_edges, n, IGRAPH_UNDIRECTED);
+    if (result == 0) {
+        result = igraph_community_multilevel(&consensus_g, &weights, &membership, 0, 0);
+        igraph_destroy(&consensus_g);
+    }
+    igraph_vector_destroy(&weights);
+    igraph_vector_destroy(&consensus_edges);
+
+    if (result != 0) {
+        igraph_vector_destroy(&membership);
+        igraph_vector_destroy(&together);
+        closeRunGraph(&graph, g);
+        return result;
+    }
+
+    igraph_vector_init(&stability, n);
+    igraph_vector_init(&incident, n);
+    for (e = 0; e < m; e++) {
+        long int from = IGRAPH_FROM(g, e), to = IGRAPH_TO(g, e);
+        igraph_real_t agreement = VECTOR(membership)[from] == VECTOR(membership)[to] ?
+                                  VECTOR(together)[e] : 1 - VECTOR(together)[e];
+        if (from != to) {
+            VECTOR(stability)[from] += agreement;
+            VECTOR(stability)[to] += agreement;
+            VECTOR(incident)[from] += 1;
+            VECTOR(incident)[to] += 1;
+        }
+    }
+    for (v = 0; v < n; v++) {
+        VECTOR(stability)[v] = VECTOR(incident)[v] > 0 ? VECTOR(stability)[v] / VECTOR(incident)[v] : 1;
+    }
+
+    destroyBuffer(consensus_result);
+    consensus_result = createBuffer(1 + 2 * (size_t) n);
+    result = igraph_modularity(g, &membership, consensus_result, 0);
+    if (result == 0) {
+        igraph_vector_copy_to(&membership, consensus_result + 1);
+        igraph_vector_copy_to(&stability, consensus_result + 1 + n);
+    } else {
+        destroyBuffer(consensus_result);
+        consensus_result = 0;
+    }
+
+    igraph_vector_destroy(&incident);
+    igraph_vector_destroy(&stability);
+    igraph_vector_destroy(&membership);
+    igraph_vector_destroy(&together);
+    closeRunGraph(&graph, g);
+
+    return result;
+}
+
+// Personalized PageRank API
+
+#define PAGERANK_BLOCK 8 // restart vectors iterated together, the scores of a vertex are contiguous
+
+// Both directions of every edge in compressed rows, the neighbors of v are targets[offsets[v]] ...
+// targets[offsets[v + 1] - 1]; a loop appears twice in the row of its vertex. The endpoints have to pass
+// validRunEdges.
+static void buildAdjacencyRows(igraph_integer_t n, const run_edges_t *run_edges,
+                               igraph_vector_int_t *offsets, igraph_vector_int_t *targets) {
+    igraph_vector_int_t position;
+    igraph_integer_t v;
+    size_t e;
+
+    igraph_vector_int_init(offsets, n + 1);
+    igraph_vector_int_init(targets, 2 * run_edges->m);
+    for (e = 0; e < run_edges->m; e++) {
+        VECTOR(*offsets)[RUN_EDGE_FROM(run_edges, e) + 1] += 1;
+        VECTOR(*offsets)[RUN_EDGE_TO(run_edges, e) + 1] += 1;
+    }
+    for (v = 0; v < n; v++) {
+        VECTOR(*offsets)[v + 1] += VECTOR(*offsets)[v];
+    }
+
+    igraph_vector_int_copy(&position, offsets);
+    for (e = 0; e < run_edges->m; e++) {
+        igraph_integer_t from = RUN_EDGE_FROM(run_edges, e), to = RUN_EDGE_TO(run_edges, e);
+
+        VECTOR(*targets)[VECTOR(position)[from]++] = to;
+        VECTOR(*targets)[VECTOR(position)[to]++] = from;
+    }
+    igraph_vector_int_destroy(&position);
+}
+
+// Power iteration of the seed sets first ... first + PAGERANK_BLOCK - 1, those from count on are empty. @x gets
+// the scores of column j of vertex v at v * PAGERANK_BLOCK + j; @y and @next are scratch of the same size.
+static void pageRankBlock(igraph_integer_t n, const igraph_vector_int_t *offsets, const igraph_vector_int_t *targets,
+                          const igraph_real_t *seed_sets, int count, int first, igraph_real_t damping,
+                          igraph_real_t tolerance, int max_iterations,
+                          igraph_real_t *x, igraph_real_t *y, igraph_real_t *next) {
+    const igraph_real_t *seeds = seed_sets + count + 1;
+    igraph_real_t dangling[PAGERANK_BLOCK], teleport[PAGERANK_BLOCK], change[PAGERANK_BLOCK];
+    igraph_integer_t v;
+    long int i;
+    int j, iteration;
+
+    memset(x, 0, sizeof(igraph_real_t) * n * PAGERANK_BLOCK);
+    for (j = 0; j < PAGERANK_BLOCK && first + j < count; j++) {
+        long int begin = seed_sets[first + j], end = seed_sets[first + j + 1];
+
+        for (i = begin; i < end; i++) {
+            x[(igraph_integer_t) seeds[i] * PAGERANK_BLOCK + j] += 1.0 / (end - begin);
+        }
+    }
+
+    for (iteration = 0; iteration < max_iterations; iteration++) {
+        igraph_real_t largest_change = 0;
+
+        // Scores spread over the edges, those of vertices without edges go back to the seeds
+        for (j = 0; j < PAGERANK_BLOCK; j++) {
+            dangling[j] = 0;
+            change[j] = 0;
+        }
+        for (v = 0; v < n; v++) {
+            igraph_integer_t degree = VECTOR(*offsets)[v + 1] - VECTOR(*offsets)[v];
+            igraph_real_t *row = y + v * PAGERANK_BLOCK;
+
+            if (degree == 0) {
+                for (j = 0; j < PAGERANK_BLOCK; j++) {
+                    dangling[j] += x[v * PAGERANK_BLOCK + j];
+                    row[j] = 0;
+                }
+            } else {
+                for (j = 0; j < PAGERANK_BLOCK; j++) {
+                    row[j] = x[v * PAGERANK_BLOCK + j] / degree;
+                }
+            }
+        }
+
+        for (v = 0; v < n; v++) {
+            igraph_real_t sum[PAGERANK_BLOCK] = {0};
+            igraph_real_t *row = next + v * PAGERANK_BLOCK;
+
+            for (i = VECTOR(*offsets)[v]; i < VECTOR(*offsets)[v + 1]; i++) {
+                const igraph_real_t *neighbor = y + VECTOR(*targets)[i] * PAGERANK_BLOCK;
+
+                for (j = 0; j < PAGERANK_BLOCK; j++) {
+                    sum[j] += neighbor[j];
+                }
+            }
+            for (j = 0; j < PAGERANK_BLOCK; j++) {
+                row[j] = damping * sum[j];
+            }
+        }
+
+        for (j = 0; j < PAGERANK_BLOCK; j++) {
+            teleport[j] = 1 - damping + damping * dangling[j];
+        }
+        for (j = 0; j < PAGERANK_BLOCK && first + j < count; j++) {
+            long int begin = seed_sets[first + j], end = seed_sets[first + j + 1];
+
+            for (i = begin; i < end; i++) {
+                next[(igraph_integer_t) seeds[i] * PAGERANK_BLOCK + j] += teleport[j] / (end - begin);
+            }
+        }
+
+        for (v = 0; v < n * PAGERANK_BLOCK; v += PAGERANK_BLOCK) {
+            for (j = 0; j < PAGERANK_BLOCK; j++) {
+                change[j] += fabs(next[v + j] - x[v + j]);
+            }
+        }
+        memcpy(x, next, sizeof(igraph_real_t) * n * PAGERANK_BLOCK);
+
+        for (j = 0; j < PAGERANK_BLOCK; j++) {
+            largest_change = change[j] > largest_change ? change[j] : largest_change;
+        }
+        if (largest_change < tolerance) {
+            break;
+        }
+    }
+}
+
+// Adds to @community the prefix of smallest conductance of the vertices with a positive score, in decreasing order
+// of score over degree, and returns its conductance. Prefixes holding every edge are skipped; without any other the
+// community is the whole prefix, of conductance zero.
+static igraph_real_t sweepCut(igraph_integer_t n, const igraph_vector_int_t *offsets,
+                              const igraph_vector_int_t *targets, const igraph_real_t *x, int column,
+                              igraph_vector_bool_t *inside, igraph_vector_t *community) {
+    igraph_vector_t candidates, ratio, order;
+    igraph_real_t volume = 0, cut = 0, total = igraph_vector_int_size(targets);
+    igraph_real_t best = IGRAPH_INFINITY;
+    igraph_integer_t v;
+    long int i, k, best_size = -1;
+
+    igraph_vector_init(&candidates, 0);
+    igraph_vector_init(&ratio, 0);
+    igraph_vector_init(&order, 0);
+    for (v = 0; v < n; v++) {
+        igraph_real_t score = x[v * PAGERANK_BLOCK + column];
+        igraph_integer_t degree = VECTOR(*offsets)[v + 1] - VECTOR(*offsets)[v];
+
+        if (score > 0) {
+            igraph_vector_push_back(&candidates, v);
+            igraph_vector_push_back(&ratio, degree > 0 ? score / degree : score);
+        }
+    }
+    igraph_vector_qsort_ind(&ratio, &order, /*descending*/ 1);
+
+    for (k = 0; k < igraph_vector_size(&order); k++) {
+        igraph_integer_t u = VECTOR(candidates)[(long int) VECTOR(order)[k]];
+        igraph_real_t denominator;
+
+        VECTOR(*inside)[u] = 1;
+        for (i = VECTOR(*offsets)[u]; i < VECTOR(*offsets)[u + 1]; i++) {
+            igraph_integer_t w = VECTOR(*targets)[i];
+
+            volume += 1;
+            if (w != u) {
+                cut += VECTOR(*inside)[w] ? -1 : 1;
+            }
+        }
+
+        denominator = volume < total - volume ? volume : total - volume;
+        if (volume < total && (denominator > 0 ? cut / denominator : 0) < best) {
+            best = denominator > 0 ? cut / denominator : 0;
+            best_size = k + 1;
+        }
+    }
+    if (best_size < 0) {
+        best = 0;
+        best_size = igraph_vector_size(&order);
+    }
+
+    for (k = 0; k < igraph_vector_size(&order); k++) {
+        igraph_integer_t u = VECTOR(candidates)[(long int) VECTOR(order)[k]];
+
+        VECTOR(*inside)[u] = 0;
+        if (k < best_size) {
+            igraph_vector_push_back(community, u);
+        }
+    }
+
+    igraph_vector_destroy(&order);
+    igraph_vector_destroy(&ratio);
+    igraph_vector_destroy(&candidates);
+
+    return best;
+}
+
+// Count seed sets given as count + 1 offsets into the seed vertices that follow them, increasing from zero, and
+// every seed in [0, n)
+static int validSeedSets(igraph_integer_t n, const igraph_real_t *seed_sets, int count) {
+    long int i;
+    int j;
+
+    if (count < 0 || seed_sets[0] != 0) {
+        return 0;
+    }
+    for (j = 0; j < count; j++) {
+        if (seed_sets[j + 1] < seed_sets[j]) {
+            return 0;
+        }
+    }
+    for (i = 0; i < seed_sets[count]; i++) {
+        if (seed_sets[count + 1 + i] < 0 || seed_sets[count + 1 + i] >= n) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Personalized PageRank of count seed sets, given as count + 1 offsets into the seed vertices that follow them.
+// The restart vector of a set is uniform on its vertices, the walk follows an edge with probability @damping.
+// Iterations stop once no score vector changes by @tolerance in L1 norm, or after @max_iterations. The sets are
+// iterated PAGERANK_BLOCK at a time, one pass over the edges updates all of them. Gives count score vectors of n
+// with @sweep zero, else the conductance of the sweep cut community of every set, count + 1 offsets into its
+// vertices, then the vertices. Returns 1 when the offsets are not increasing, or a seed or an edge endpoint is not
+// in [0, n).
+EMSCRIPTEN_KEEPALIVE
+int personalizedPageRank(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                         const igraph_real_t *seed_sets, int count, igraph_real_t damping,
+                         igraph_real_t tolerance, int max_iterations, int sweep) {
+    run_edges_t run_edges = runEdges(edges, edges_len);
+    igraph_vector_int_t offsets, targets;
+    igraph_vector_t header, communities;
+    igraph_vector_bool_t inside;
+    igraph_real_t *x, *y, *next;
+    int first, j;
+
+    if (!validSeedSets(n, seed_sets, count) || !validRunEdges(n, &run_edges)) {
+        return 1;
+    }
+
+    buildAdjacencyRows(n, &run_edges, &offsets, &targets);
+    x = calloc((size_t) n * PAGERANK_BLOCK + 1, sizeof(igraph_real_t));
+    y = calloc((size_t) n * PAGERANK_BLOCK + 1, sizeof(igraph_real_t));
+    next = calloc((size_t) n * PAGERANK_BLOCK + 1, sizeof(igraph_real_t));
+
+    // Conductances then community offsets
+    igraph_vector_init(&header, 2 * (size_t) count + 1);
+    igraph_vector_init(&communities, 0);
+    igraph_vector_bool_init(&inside, n);
+
+    destroyBuffer(pagerank_result);
+    pagerank_result = sweep ? 0 : createBuffer((size_t) count * n);
+    pagerank_size = sweep ? 0 : (size_t) count * n;
+
+    for (first = 0; first < count; first += PAGERANK_BLOCK) {
+        igraph_integer_t v;
+
+        pageRankBlock(n, &offsets, &targets, seed_sets, count, first, damping, tolerance, max_iterations,
+                      x, y, next);
+
+        for (j = 0; j < PAGERANK_BLOCK && first + j < count; j++) {
+            if (sweep) {
+                VECTOR(header)[first + j] = sweepCut(n, &offsets, &targets, x, j, &inside, &communities);
+                VECTOR(header)[count + first + j + 1] = igraph_vector_size(&communities);
+            } else {
+                for (v = 0; v < n; v++) {
+                    pagerank_result[(size_t) (first + j) * n + v] = x[v * PAGERANK_BLOCK + j];
+                }
+            }
+        }
+
+        progress_handler(0, 100.0 * (first + j) / count, 0);
+    }
+
+    if (sweep) {
+        pagerank_size = igraph_vector_size(&header) + igraph_vector_size(&communities);
+        pagerank_result = createBuffer(pagerank_size);
+        igraph_vector_copy_to(&header, pagerank_result);
+        igraph_vector_copy_to(&communities, pagerank_result + igraph_vector_size(&header));
+    }
+
+    igraph_vector_bool_destroy(&inside);
+    igraph_vector_destroy(&communities);
+    igraph_vector_destroy(&header);
+    free(next);
+    free(y);
+    free(x);
+    igraph_vector_int_destroy(&targets);
+    igraph_vector_int_destroy(&offsets);
+
+    return 0;
+}
+
+// Local community API
+
+// Scratch of the push, allocated once for all the seed sets, and for all the calls on a loaded graph; only the
+// touched vertices are reset after a set
+typedef struct local_push {
+    const igraph_t *graph;
+    igraph_lazy_adjlist_t adjlist; // neighbor lists of the pushed vertices only
+    igraph_vector_t pagerank;
+    igraph_vector_t residual;
+    igraph_vector_t degree; // -1 until the vertex is touched by the current seed set
+    igraph_vector_t degree_query;
+    igraph_vector_bool_t queued;
+    igraph_vector_bool_t inside;
+    igraph_vector_int_t touched;
+    igraph_dqueue_t queue;
+} local_push_t;
+
+static igraph_real_t localDegree(local_push_t *push, igraph_integer_t v) {
+    if (VECTOR(push->degree)[v] < 0) {
+        igraph_degree(push->graph, &push->degree_query, igraph_vss_1(v), IGRAPH_ALL, /*loops*/ 1);
+        VECTOR(push->degree)[v] = VECTOR(push->degree_query)[0];
+    }
+    return VECTOR(push->degree)[v];
+}
+
+static void addResidual(local_push_t *push, igraph_integer_t v, igraph_real_t amount, igraph_real_t epsilon) {
+    if (VECTOR(push->degree)[v] < 0) {
+        igraph_vector_int_push_back(&push->touched, v);
+    }
+    VECTOR(push->residual)[v] += amount;
+    if (!VECTOR(push->queued)[v] && VECTOR(push->residual)[v] >= epsilon * localDegree(push, v)) {
+        VECTOR(push->queued)[v] = 1;
+        igraph_dqueue_push(&push->queue, v);
+    }
+}
+
+// Approximate personalized PageRank of the seeds by pushes: a vertex whose residual is at least @epsilon times its
+// degree keeps 1 - damping of it and spreads the rest evenly over its edges. The pushes are bounded by
+// 1 / (epsilon (1 - damping)) in total volume whatever the size of the graph. Then adds the sweep cut community of
+// the pushed vertices to @community and returns its conductance, as sweepCut does.
+static igraph_real_t localCommunity(local_push_t *push, const igraph_real_t *seeds, long int seeds_len,
+                                    igraph_real_t damping, igraph_real_t epsilon, igraph_vector_t *community) {
+    igraph_vector_t candidates, ratio, order;
+    igraph_real_t volume = 0, cut = 0, total = 2.0 * igraph_ecount(push->graph);
+    igraph_real_t best = IGRAPH_INFINITY;
+    long int i, k, best_size = -1;
+
+    for (i = 0; i < seeds_len; i++) {
+        addResidual(push, seeds[i], 1.0 / seeds_len, epsilon);
+    }
+
+    while (!igraph_dqueue_empty(&push->queue)) {
+        igraph_integer_t u = igraph_dqueue_pop(&push->queue);
+        igraph_real_t degree = localDegree(push, u), residual = VECTOR(push->residual)[u];
+        igraph_vector_t *neighbors;
+
+        VECTOR(push->queued)[u] = 0;
+        VECTOR(push->residual)[u] = 0;
+        if (degree == 0) {
+            VECTOR(push->pagerank)[u] += residual;
+            continue;
+        }
+
+        VECTOR(push->pagerank)[u] += (1 - damping) * residual;
+        neighbors = igraph_lazy_adjlist_get(&push->adjlist, u);
+        for (k = 0; k < igraph_vector_size(neighbors); k++) {
+            addResidual(push, VECTOR(*neighbors)[k], damping * residual / degree, epsilon);
+        }
+    }
+
+    // Sweep over the pushed vertices, their neighbor lists are already there
+    igraph_vector_init(&candidates, 0);
+    igraph_vector_init(&ratio, 0);
+    igraph_vector_init(&order, 0);
+    for (i = 0; i < igraph_vector_int_size(&push->touched); i++) {
+        igraph_integer_t v = VECTOR(push->touched)[i];
+        igraph_real_t score = VECTOR(push->pagerank)[v], degree = VECTOR(push->degree)[v];
+
+        if (score > 0) {
+            igraph_vector_push_back(&candidates, v);
+            igraph_vector_push_back(&ratio, degree > 0 ? score / degree : score);
+        }
+    }
+    igraph_vector_qsort_ind(&ratio, &order, /*descending*/ 1);
+
+    for (k = 0; k < igraph_vector_size(&order); k++) {
+        igraph_integer_t u = VECTOR(candidates)[(long int) VECTOR(order)[k]];
+        igraph_vector_t *neighbors = igraph_lazy_adjlist_get(&push->adjlist, u);
+        igraph_real_t denominator;
+
+        VECTOR(push->inside)[u] = 1;
+        for (i = 0; i < igraph_vector_size(neighbors); i++) {
+            igraph_integer_t w = VECTOR(*neighbors)[i];
+
+            volume += 1;
+            if (w != u) {
+                cut += VECTOR(push->inside)[w] ? -1 : 1;
+            }
+        }
+
+        denominator = volume < total - volume ? volume : total - volume;
+        if (volume < total && (denominator > 0 ? cut / denominator : 0) < best) {
+            best = denominator > 0 ? cut / denominator : 0;
+            best_size = k + 1;
+        }
+    }
+    if (best_size < 0) {
+        best = 0;
+        best_size = igraph_vector_size(&order);
+    }
+    for (k = 0; k < best_size; k++) {
+        igraph_vector_push_back(community, VECTOR(candidates)[(long int) VECTOR(order)[k]]);
+    }
+
+    for (i = 0; i < igraph_vector_int_size(&push->touched); i++) {
+        igraph_integer_t v = VECTOR(push->touched)[i];
+
+        VECTOR(push->pagerank)[v] = 0;
+        VECTOR(push->residual)[v] = 0;
+        VECTOR(push->degree)[v] = -1;
+        VECTOR(push->inside)[v] = 0;
+    }
+    igraph_vector_int_clear(&push->touched);
+
+    igraph_vector_destroy(&order);
+    igraph_vector_destroy(&ratio);
+    igraph_vector_destroy(&candidates);
+
+    return best;
+}
+
+static local_push_t* createLocalPush(const igraph_t *graph) {
+    igraph_integer_t n = igraph_vcount(graph);
+    local_push_t *push = calloc(1, sizeof(local_push_t));
+
+    push->graph = graph;
+    igraph_lazy_adjlist_init(graph, &push->adjlist, IGRAPH_ALL, IGRAPH_DONT_SIMPLIFY);
+    igraph_vector_init(&push->pagerank, n);
+    igraph_vector_init(&push->residual, n);
+    igraph_vector_init(&push->degree, n);
+    igraph_vector_fill(&push->degree, -1);
+    igraph_vector_init(&push->degree_query, 1);
+    igraph_vector_bool_init(&push->queued, n);
+    igraph_vector_bool_init(&push->inside, n);
+    igraph_vector_int_init(&push->touched, 0);
+    igraph_dqueue_init(&push->queue, 64);
+
+    return push;
+}
+
+static void destroyLocalPush(local_push_t *push) {
+    igraph_dqueue_destroy(&push->queue);
+    igraph_vector_int_destroy(&push->touched);
+    igraph_vector_bool_destroy(&push->inside);
+    igraph_vector_bool_destroy(&push->queued);
+    igraph_vector_destroy(&push->degree_query);
+    igraph_vector_destroy(&push->degree);
+    igraph_vector_destroy(&push->residual);
+    igraph_vector_destroy(&push->pagerank);
+    igraph_lazy_adjlist_destroy(&push->adjlist);
+    free(push);
+}
+
+// Community around every seed set, given as for personalizedPageRank, from an approximate personalized PageRank
+// pushed out of the seeds; @epsilon trades accuracy for the size of the neighborhood explored. Gives the sweep cut
+// results of personalizedPageRank. Building the graph reads every edge once, the work of a seed set then only
+// depends on its neighborhood; on a loaded graph only the first call builds anything. Returns 1 when the seed sets
+// are not valid or an edge endpoint is not in [0, n).
+EMSCRIPTEN_KEEPALIVE
+int localCommunities(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len,
+                     const igraph_real_t *seed_sets, int count, igraph_real_t damping, igraph_real_t epsilon) {
+    run_edges_t run_edges = runEdges(edges, edges_len);
+    local_push_t *push;
+    igraph_t graph;
+    const igraph_t *g;
+    igraph_vector_t header, communities;
+    int j;
+
+    if (!validSeedSets(n, seed_sets, count) || !validRunEdges(n, &run_edges)) {
+        return 1;
+    }
+
+    // The scratch of a loaded graph stays with it, later calls only pay for the neighborhoods of their seeds
+    if (run_graph != 0) {
+        if (run_graph->push == 0) {
+            run_graph->push = createLocalPush(&run_graph->graph);
+        }
+        push = run_graph->push;
+    } else {
+        if (openRunGraph(&graph, &g, n, edges, edges_len) != 0) {
+            return 1;
+        }
+        push = createLocalPush(g);
+    }
+
+    // Conductances then community offsets
+    igraph_vector_init(&header, 2 * (size_t) count + 1);
+    igraph_vector_init(&communities, 0);
+
+    for (j = 0; j < count; j++) {
+        long int begin = seed_sets[j], end = seed_sets[j + 1];
+
+        VECTOR(header)[j] = localCommunity(push, seed_sets + count + 1 + begin, end - begin, damping, epsilon,
+                                           &communities);
+        VECTOR(header)[count + j + 1] = igraph_vector_size(&communities);
+    }
+
+    destroyBuffer(pagerank_result);
+    pagerank_size = igraph_vector_size(&header) + igraph_vector_size(&communities);
+    pagerank_result = createBuffer(pagerank_size);
+    igraph_vector_copy_to(&header, pagerank_result);
+    igraph_vector_copy_to(&communities, pagerank_result + igraph_vector_size(&header));
+
+    igraph_vector_destroy(&communities);
+    igraph_vector_destroy(&header);
+    if (run_graph == 0) {
+        destroyLocalPush(push);
+        closeRunGraph(&graph, g);
+    }
+
+    return 0;
+}
+
+// Triangle counting API
+
+// Triangles of the graph with loops dropped and multiple edges merged. Every edge between distinct vertices is
+// kept once, oriented from the endpoint of lower degree (then id) to the other, so that a vertex has at most
+// sqrt(2m) out-neighbors whose degree is not smaller than its own. The out-neighbors of u are marked with the
+// pair they are reached by, then every triangle u -> v -> w is found once from u, in O(m^1.5) in total. Gives the
+// number of triangles, the triangles and local clustering coefficient of the n vertices, then the triangles of
+// the m edges, those of the merged edges of a pair being the same and those of loops zero. The clustering
+// coefficient of a vertex with less than two neighbors is zero. Returns 1 when an edge endpoint is not in [0, n).
+EMSCRIPTEN_KEEPALIVE
+int countTriangles(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len) {
+    igraph_vector_int_t degree, offsets, targets, edge_ids, pair_of_edge, mark;
+    igraph_vector_t vertex_triangles, pair_triangles;
+    igraph_real_t *clustering, total = 0;
+    run_edges_t run_edges = runEdges(edges, edges_len);
+    long int e, m = run_edges.m, no_of_pairs = 0, i, j;
+    igraph_integer_t u, v;
+
+    if (!validRunEdges(n, &run_edges)) {
+        return 1;
+    }
+
+    // Orientation by degree
+    igraph_vector_int_init(&degree, n);
+    for (e = 0; e < m; e++) {
+        if (RUN_EDGE_FROM(&run_edges, e) != RUN_EDGE_TO(&run_edges, e)) {
+            VECTOR(degree)[RUN_EDGE_FROM(&run_edges, e)] += 1;
+            VECTOR(degree)[RUN_EDGE_TO(&run_edges, e)] += 1;
+        }
+    }
+#define TRIANGLE_SOURCE(a, b) \
+    (VECTOR(degree)[a] < VECTOR(degree)[b] || (VECTOR(degree)[a] == VECTOR(degree)[b] && (a) < (b)) ? (a) : (b))
+
+    // Out-neighbors of every vertex with the edges reaching them, by counting sort
+    igraph_vector_int_init(&offsets, n + 1);
+    igraph_vector_int_init(&targets, m);
+    igraph_vector_int_init(&edge_ids, m);
+    for (e = 0; e < m; e++) {
+        igraph_integer_t from = RUN_EDGE_FROM(&run_edges, e), to = RUN_EDGE_TO(&run_edges, e);
+
+        if (from != to) {
+            VECTOR(offsets)[TRIANGLE_SOURCE(from, to) + 1] += 1;
+        }
+    }
+    for (u = 0; u < n; u++) {
+        VECTOR(offsets)[u + 1] += VECTOR(offsets)[u];
+    }
+    igraph_vector_int_init(&mark, n);
+    igraph_vector_int_update(&mark, &offsets);
+    igraph_vector_int_resize(&mark, n); // next free position of every vertex
+    for (e = 0; e < m; e++) {
+        igraph_integer_t from = RUN_EDGE_FROM(&run_edges, e), to = RUN_EDGE_TO(&run_edges, e);
+        igraph_integer_t source = TRIANGLE_SOURCE(from, to);
+
+        if (from != to) {
+            long int position = VECTOR(mark)[source]++;
+
+            VECTOR(targets)[position] = source == from ? to : from;
+            VECTOR(edge_ids)[position] = e;
+        }
+    }
+#undef TRIANGLE_SOURCE
+
+    // Merged edges become one pair, the rows are compacted in place to hold every pair once; the mark of a vertex
+    // is its pair in the row being compacted plus one
+    igraph_vector_int_init(&pair_of_edge, m);
+    igraph_vector_int_fill(&pair_of_edge, -1);
+    igraph_vector_int_null(&mark);
+    igraph_vector_int_null(&degree); // distinct neighbors from now on
+    for (u = 0; u < n; u++) {
+        long int begin = VECTOR(offsets)[u], end = VECTOR(offsets)[u + 1];
+
+        VECTOR(offsets)[u] = no_of_pairs;
+        for (i = begin; i < end; i++) {
+            igraph_integer_t w = VECTOR(targets)[i];
+
+            if (VECTOR(mark)[w] == 0) {
+                VECTOR(targets)[no_of_pairs] = w;
+                VECTOR(mark)[w] = ++no_of_pairs;
+                VECTOR(degree)[u] += 1;
+                VECTOR(degree)[w] += 1;
+            }
+            VECTOR(pair_of_edge)[VECTOR(edge_ids)[i]] = VECTOR(mark)[w] - 1;
+        }
+        for (i = VECTOR(offsets)[u]; i < no_of_pairs; i++) {
+            VECTOR(mark)[VECTOR(targets)[i]] = 0;
+        }
+    }
+    if (n > 0) {
+        VECTOR(offsets)[n] = no_of_pairs;
+    }
+    igraph_vector_int_destroy(&edge_ids);
+
+    igraph_vector_init(&vertex_triangles, n);
+    igraph_vector_init(&pair_triangles, no_of_pairs);
+    for (u = 0; u < n; u++) {
+        for (i = VECTOR(offsets)[u]; i < VECTOR(offsets)[u + 1]; i++) {
+            VECTOR(mark)[VECTOR(targets)[i]] = i + 1;
+        }
+        for (i = VECTOR(offsets)[u]; i < VECTOR(offsets)[u + 1]; i++) {
+            v = VECTOR(targets)[i];
+            for (j = VECTOR(offsets)[v]; j < VECTOR(offsets)[v + 1]; j++) {
+                igraph_integer_t w = VECTOR(targets)[j];
+                long int uw = VECTOR(mark)[w] - 1;
+
+                if (uw >= 0) {
+                    VECTOR(vertex_triangles)[u] += 1;
+                    VECTOR(vertex_triangles)[v] += 1;
+                    VECTOR(vertex_triangles)[w] += 1;
+                    VECTOR(pair_triangles)[i] += 1;
+                    VECTOR(pair_triangles)[j] += 1;
+                    VECTOR(pair_triangles)[uw] += 1;
+                    total += 1;
+                }
+            }
+        }
+        for (i = VECTOR(offsets)[u]; i < VECTOR(offsets)[u + 1]; i++) {
+            VECTOR(mark)[VECTOR(targets)[i]] = 0;
+        }
+    }
+
+    destroyBuffer(triangle_result);
+    triangle_result = createBuffer(1 + 2 * (size_t) n + m);
+    triangle_result[0] = total;
+    igraph_vector_copy_to(&vertex_triangles, triangle_result + 1);
+    clustering = triangle_result + 1 + n;
+    for (u = 0; u < n; u++) {
+        igraph_real_t d = VECTOR(degree)[u];
+        clustering[u] = d > 1 ? VECTOR(vertex_triangles)[u] / (d * (d - 1) / 2) : 0;
+    }
+    for (e = 0; e < m; e++) {
+        long int pair = VECTOR(pair_of_edge)[e];
+        triangle_result[1 + 2 * n + e] = pair >= 0 ? VECTOR(pair_triangles)[pair] : 0;
+    }
+
+    igraph_vector_destroy(&pair_triangles);
+    igraph_vector_destroy(&vertex_triangles);
+    igraph_vector_int_destroy(&pair_of_edge);
+    igraph_vector_int_destroy(&mark);
+    igraph_vector_int_destroy(&targets);
+    igraph_vector_int_destroy(&offsets);
+    igraph_vector_int_destroy(&degree);
+
+    return 0;
+}
+
+// Graph generators API, used by the benchmarks
+
+void storeGeneratedGraph(igraph_t *g, const igraph_vector_t *planted_membership) {
+    igraph_vector_t edges;
+
+    igraph_vector_init(&edges, 0);
+    igraph_get_edgelist(g, &edges, 0);
+
+    generated_edges_size = igraph_vector_size(&edges);
+    generated_edges_result = createBuffer(generated_edges_size);
+    igraph_vector_copy_to(&edges, generated_edges_result);
+
+    planted_membership_result = 0;
+    if (planted_membership != 0) {
+        planted_membership_result = createBuffer(igraph_vector_size(planted_membership));
+        igraph_vector_copy_to(planted_membership, planted_membership_result);
+    }
+
+    igraph_vector_destroy(&edges);
+}
+
+// Planted partition of n vertices into equal blocks, edge probabilities p_in inside and p_out between blocks
+EMSCRIPTEN_KEEPALIVE
+int sbmGraph(igraph_integer_t n, int blocks, igraph_real_t p_in, igraph_real_t p_out, unsigned long seed) {
+    igraph_t g;
+    igraph_matrix_t pref_matrix;
+    igraph_vector_int_t block_sizes;
+    igraph_vector_t planted_membership;
+    long int i, j, v;
+
+    igraph_rng_seed(igraph_rng_default(), seed);
+
+    igraph_matrix_init(&pref_matrix, blocks, blocks);
+    igraph_vector_int_init(&block_sizes, blocks);
+    igraph_vector_init(&planted_membership, n);
+
+    for (i = 0; i < blocks; i++) {
+        for (j = 0; j < blocks; j++) {
+            MATRIX(pref_matrix, i, j) = i == j ? p_in : p_out;
+        }
+        VECTOR(block_sizes)[i] = n / blocks + (i < n % blocks ? 1 : 0);
+    }
+    for (i = 0, v = 0; i < blocks; i++) {
+        for (j = 0; j < VECTOR(block_sizes)[i]; j++, v++) {
+            VECTOR(planted_membership)[v] = i;
+        }
+    }
+
+    igraph_sbm_game(&g, n, &pref_matrix, &block_sizes, IGRAPH_UNDIRECTED, /*loops*/ 0);
+    storeGeneratedGraph(&g, &planted_membership);
+
+    igraph_destroy(&g);
+    igraph_vector_destroy(&planted_membership);
+    igraph_vector_int_destroy(&block_sizes);
+    igraph_matrix_destroy(&pref_matrix);
+
+    return 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int staticPowerLawGraph(igraph_integer_t n, igraph_integer_t m, igraph_real_t exponent, unsigned long seed) {
+    igraph_t g;
+
+    igraph_rng_seed(igraph_rng_default(), seed);
+
+    igraph_static_power_law_game(&g, n, m, exponent, /*exponent in*/ -1, /*loops*/ 0, /*multiple*/ 0,
+                                 /*finite size correction*/ 1);
+    storeGeneratedGraph(&g, 0);
+
+    igraph_destroy(&g);
+
+    return 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int barabasiGraph(igraph_integer_t n, igraph_integer_t m, unsigned long seed) {
+    igraph_t g;
+
+    igraph_rng_seed(igraph_rng_default(), seed);
+
+    igraph_barabasi_game(&g, n, /*power*/ 1.0, m, /*outseq*/ 0, /*outpref*/ 0, /*A*/ 1.0, IGRAPH_UNDIRECTED,
+                         IGRAPH_BARABASI_PSUMTREE, /*start from*/ 0);
+    storeGeneratedGraph(&g, 0);
+
+    igraph_destroy(&g);
+
+    return 0;
+}
+
+// Binary graph loading (binary-graph.js). JS streams the offsets, targets and weights sections of a CSR file into
+// the buffer from createGraphLoader, finishGraphLoader indexes it once into a loaded graph that runs take in place
+// of an edges buffer after setRunGraph.
+
+// Loader buffer of n + 1 offsets, m targets and, when @weighted, m weights, all 4 bytes wide; zero when n or m is
+// out of the int32 range of the format or the buffer size does not fit in a size_t
+EMSCRIPTEN_KEEPALIVE
+uint8_t* createGraphLoader(igraph_integer_t n, size_t m, int weighted) {
+    uint64_t words = (uint64_t) n + 1 + (uint64_t) m * (weighted ? 2 : 1);
+
+    if (n < 0 || n == INT32_MAX || m > INT32_MAX || words > SIZE_MAX / sizeof(int32_t)) {
+        return 0;
+    }
+
+    return malloc((size_t) words * sizeof(int32_t));
+}
+
+// Returns the loaded graph, or zero when the CSR data is invalid (offsets not increasing from zero to m, a target
+// not in [0, n) or a weight not positive); frees the loader buffer in any case
+EMSCRIPTEN_KEEPALIVE
+loaded_graph_t* finishGraphLoader(uint8_t *data, igraph_integer_t n, size_t m, int weighted) {
+    const int32_t *offsets = (const int32_t *) data;
+    const int32_t *targets = offsets + n + 1;
+    const float *weights = (const float *) (targets + m);
+    loaded_graph_t *graph = 0;
+    igraph_vector_t edges_v;
+    igraph_integer_t v;
+    size_t e;
+    int valid = offsets[0] == 0 && (size_t) offsets[n] == m;
+
+    for (v = 0; valid && v < n; v++) {
+        valid = offsets[v + 1] >= offsets[v];
+    }
+    for (e = 0; valid && e < m; e++) {
+        valid = targets[e] >= 0 && targets[e] < n && (!weighted || weights[e] > 0);
+    }
+
+    if (valid) {
+        graph = calloc(1, sizeof(loaded_graph_t));
+    }
+    if (graph == 0 || igraph_vector_init(&edges_v, 2 * m) != 0) {
+        free(graph);
+        free(data);
+        return 0;
+    }
+    if (igraph_vector_init(&graph->weights, weighted ? m : 0) != 0) {
+        igraph_vector_destroy(&edges_v);
+        free(graph);
+        free(data);
+        return 0;
+    }
+
+    for (v = 0; v < n; v++) {
+        for (e = offsets[v]; e < (size_t) offsets[v + 1]; e++) {
+            VECTOR(edges_v)[2 * e] = v;
+            VECTOR(edges_v)[2 * e + 1] = targets[e];
+        }
+    }
+    for (e = 0; weighted && e < m; e++) {
+        VECTOR(graph->weights)[e] = weights[e];
+    }
+    free(data);
+
+    igraph_create(&graph->graph, &edges_v, n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&edges_v);
+
+    return graph;
+}
+
+// Weights of the loaded graph in the order of its edges, zero when it is unweighted; valid until destroyLoadedGraph
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getLoadedGraphWeightsPointer(loaded_graph_t *graph) {
+    return igraph_vector_empty(&graph->weights) ? 0 : VECTOR(graph->weights);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void destroyLoadedGraph(loaded_graph_t *graph) {
+    if (run_graph == graph) {
+        run_graph = 0;
+    }
+    if (graph->push != 0) {
+        destroyLocalPush(graph->push);
+    }
+    igraph_vector_destroy(&graph->weights);
+    igraph_destroy(&graph->graph);
+    free(graph);
+}
+
+// Incremental graph building. Edges are appended in chunks to a growing int32 buffer, half the size of the
+// edges buffer the runners take; finishGraphBuilder indexes them once into a loaded graph, as finishGraphLoader does.
+
+typedef struct {
+    int32_t *edges;
+    size_t size;
+    size_t capacity;
+} graph_builder_t;
+
+EMSCRIPTEN_KEEPALIVE
+graph_builder_t* createGraphBuilder() {
+    return calloc(1, sizeof(graph_builder_t));
+}
+
+// Makes room for `length` more endpoints and returns where JS writes them, zero when out of memory
+EMSCRIPTEN_KEEPALIVE
+int32_t* appendGraphBuilderEdges(graph_builder_t *builder, size_t length) {
+    int32_t *chunk;
+
+    if (builder->size + length > builder->capacity) {
+        size_t capacity = builder->capacity ? builder->capacity : 1024;
+        int32_t *edges;
+
+        while (capacity < builder->size + length) {
+            capacity *= 2;
+        }
+
+        edges = realloc(builder->edges, capacity * sizeof(int32_t));
+        if (!edges) {
+            return 0;
+        }
+
+        builder->edges = edges;
+        builder->capacity = capacity;
+    }
+
+    chunk = builder->edges + builder->size;
+    builder->size += length;
+
+    return chunk;
+}
+
+// Largest vertex id appended so far plus one, or -1 when an id is negative
+EMSCRIPTEN_KEEPALIVE
+igraph_integer_t getGraphBuilderVertexCount(graph_builder_t *builder) {
+    int32_t max_vertex = -1;
+    size_t i;
+
+    for (i = 0; i < builder->size; i++) {
+        if (builder->edges[i] < 0) {
+            return -1;
+        }
+        if (builder->edges[i] > max_vertex) {
+            max_vertex = builder->edges[i];
+        }
+    }
+
+    return max_vertex + 1;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getGraphBuilderSize(graph_builder_t *builder) {
+    return builder->size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void destroyGraphBuilder(graph_builder_t *builder) {
+    free(builder->edges);
+    free(builder);
+}
+
+// Returns the loaded graph of the appended edges, unweighted and in the order they were appended, or zero when a
+// vertex id is not in [0, n); destroys the builder in any case, before the graph is indexed
+EMSCRIPTEN_KEEPALIVE
+loaded_graph_t* finishGraphBuilder(graph_builder_t *builder, igraph_integer_t n) {
+    loaded_graph_t *graph = 0;
+    igraph_vector_t edges_v;
+    size_t i;
+    int valid = n >= 0;
+
+    for (i = 0; valid && i < builder->size; i++) {
+        valid = builder->edges[i] >= 0 && builder->edges[i] < n;
+    }
+
+    if (valid) {
+        graph = calloc(1, sizeof(loaded_graph_t));
+    }
+    if (graph == 0 || igraph_vector_init(&edges_v, builder->size) != 0) {
+        free(graph);
+        destroyGraphBuilder(builder);
+        return 0;
+    }
+    if (igraph_vector_init(&graph->weights, 0) != 0) {
+        igraph_vector_destroy(&edges_v);
+        free(graph);
+        destroyGraphBuilder(builder);
+        return 0;
+    }
+
+    for (i = 0; i < builder->size; i++) {
+        VECTOR(edges_v)[i] = builder->edges[i];
+    }
+    destroyGraphBuilder(builder);
+
+    igraph_create(&graph->graph, &edges_v, n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&edges_v);
+
+    return graph;
+}
+
+// Dynamic graph sessions. A session keeps a graph and its partition between runs. Inserted and deleted edges mark
+// their endpoints, and an update revisits only the marked vertices, then the neighbors of every vertex changing
+// community, starting from the previous partition. Community ids are reused as communities empty, at most one
+// per vertex; the membership result is reindexed.
+
+enum session_mode {
+    SESSION_MODULARITY,      // Louvain, then its local moving phase
+    SESSION_LABEL_PROPAGATION
+};
+
+typedef struct {
+    igraph_t graph;
+    enum session_mode mode;
+    int detected; // the membership is a partition found by the algorithm, singletons before
+
+    igraph_vector_t membership;
+    igraph_vector_t community_degree; // sum of the degrees of every community id
+    igraph_vector_t community_size;
+    igraph_vector_int_t free_ids;     // community ids without vertices
+
+    igraph_vector_bool_t marked;
+    igraph_dqueue_t queue;            // the marked vertices
+
+    igraph_real_t *result;            // modularity, vertices moved by the last detection, then the membership
+} session_t;
+
+static void markSessionVertex(session_t *session, long int v) {
+    if (!VECTOR(session->marked)[v]) {
+        VECTOR(session->marked)[v] = 1;
+        igraph_dqueue_push(&session->queue, v);
+    }
+}
+
+static long int newSessionCommunity(session_t *session) {
+    if (!igraph_vector_int_empty(&session->free_ids)) {
+        return igraph_vector_int_pop_back(&session->free_ids);
+    }
+    igraph_vector_push_back(&session->community_degree, 0);
+    igraph_vector_push_back(&session->community_size, 0);
+    return igraph_vector_size(&session->community_size) - 1;
+}
+
+static void moveSessionVertex(session_t *session, long int v, long int to, igraph_real_t degree) {
+    long int from = VECTOR(session->membership)[v];
+
+    VECTOR(session->community_degree)[from] -= degree;
+    VECTOR(session->community_size)[from] -= 1;
+    if (VECTOR(session->community_size)[from] == 0) {
+        igraph_vector_int_push_back(&session->free_ids, from);
+    }
+    VECTOR(session->community_degree)[to] += degree;
+    VECTOR(session->community_size)[to] += 1;
+    VECTOR(session->membership)[v] = to;
+}
+
+// Community statistics of the membership, reindexed so that no id is free
+static void resetSessionCommunities(session_t *session) {
+    igraph_integer_t n = igraph_vcount(&session->graph), nb_clusters = 0;
+    igraph_vector_t degree;
+    long int v;
+
+    if (n > 0) {
+        igraph_reindex_membership(&session->membership, 0, &nb_clusters);
+    }
+    igraph_vector_init(&degree, 0);
+    igraph_degree(&session->graph, &degree, igraph_vss_all(), IGRAPH_ALL, /*loops*/ 1);
+
+    igraph_vector_resize(&session->community_degree, nb_clusters);
+    igraph_vector_resize(&session->community_size, nb_clusters);
+    igraph_vector_null(&session->community_degree);
+    igraph_vector_null(&session->community_size);
+    igraph_vector_int_clear(&session->free_ids);
+    for (v = 0; v < n; v++) {
+        long int c = VECTOR(session->membership)[v];
+        VECTOR(session->community_degree)[c] += VECTOR(degree)[v];
+        VECTOR(session->community_size)[c] += 1;
+    }
+
+    igraph_vector_destroy(&degree);
+}
+
+// New vertices up to vertex id n - 1, each in a community of its own
+static void growSession(session_t *session, igraph_integer_t n) {
+    long int v, old_n = igraph_vcount(&session->graph);
+
+    if (n <= old_n) {
+        return;
+    }
+
+    igraph_add_vertices(&session->graph, n - old_n, 0);
+    igraph_vector_resize(&session->membership, n);
+    igraph_vector_bool_resize(&session->marked, n);
+    for (v = old_n; v < n; v++) {
+        long int c = newSessionCommunity(session);
+        VECTOR(session->membership)[v] = c;
+        VECTOR(session->community_size)[c] += 1;
+        VECTOR(session->marked)[v] = 0;
+        markSessionVertex(session, v);
+    }
+}
+
+// @mode: 0 modularity (Louvain), 1 label propagation. Returns 0 when the graph cannot be built, as for an odd edges
+// length or an endpoint out of [0, n).
+EMSCRIPTEN_KEEPALIVE
+session_t* createSession(igraph_integer_t n, const igraph_real_t *edges, size_t edges_len, int mode) {
+    session_t *session = calloc(1, sizeof(session_t));
+    const igraph_t *graph;
+
+    if (session == 0) {
+        return 0;
+    }
+
+    // The session changes its graph, a loaded graph is copied
+    if (openRunGraph(&session->graph, &graph, n, edges, edges_len) != 0) {
+        free(session);
+        return 0;
+    }
+    if (graph != &session->graph && igraph_copy(&session->graph, graph) != 0) {
+        free(session);
+        return 0;
+    }
+    n = igraph_vcount(&session->graph);
+    session->mode = mode == 1 ? SESSION_LABEL_PROPAGATION : SESSION_MODULARITY;
+
+    igraph_vector_init_seq(&session->membership, 0, n - 1);
+    igraph_vector_init(&session->community_degree, 0);
+    igraph_vector_init(&session->community_size, 0);
+    igraph_vector_int_init(&session->free_ids, 0);
+    igraph_vector_bool_init(&session->marked, n);
+    igraph_dqueue_init(&session->queue, n > 0 ? n : 1);
+    resetSessionCommunities(session);
+
+    return session;
+}
+
+// Returns 1 when a vertex id is negative or the length is odd, vertex ids from the vertex count on add vertices
+EMSCRIPTEN_KEEPALIVE
+int sessionAddEdges(session_t *session, const igraph_real_t *edges, size_t edges_len) {
+    igraph_vector_t edges_v;
+    igraph_real_t max_vertex = -1;
+    size_t i;
+
+    if (edges_len % 2 != 0) {
+        return 1;
+    }
+    for (i = 0; i < edges_len; i++) {
+        if (edges[i] < 0) {
+            return 1;
+        }
+        if (edges[i] > max_vertex) {
+            max_vertex = edges[i];
+        }
+    }
+    growSession(session, max_vertex + 1);
+
+    igraph_vector_view(&edges_v, edges, edges_len);
+    igraph_add_edges(&session->graph, &edges_v, 0);
+    for (i = 0; i < edges_len; i++) {
+        long int v = edges[i];
+        VECTOR(session->community_degree)[(long int) VECTOR(session->membership)[v]] += 1;
+        markSessionVertex(session, v);
+    }
+
+    return 0;
+}
+
+// Deletes one edge of every endpoint pair, returns the number of edges deleted; missing edges are skipped
+EMSCRIPTEN_KEEPALIVE
+int sessionDeleteEdges(session_t *session, const igraph_real_t *edges, size_t edges_len) {
+    igraph_integer_t n = igraph_vcount(&session->graph);
+    igraph_vector_t pairs, eids;
+    long int i, deleted = 0;
+
+    igraph_vector_init(&pairs, 0);
+    igraph_vector_reserve(&pairs, edges_len);
+    for (i = 0; i + 1 < (long int) edges_len; i += 2) {
+        if (edges[i] >= 0 && edges[i] < n && edges[i + 1] >= 0 && edges[i + 1] < n) {
+            igraph_vector_push_back(&pairs, edges[i]);
+            igraph_vector_push_back(&pairs, edges[i + 1]);
+        }
+    }
+
+    // Repeated pairs get distinct edges of a multi-edge
+    igraph_vector_init(&eids, 0);
+    igraph_get_eids_multi(&session->graph, &eids, &pairs, /*path*/ 0, IGRAPH_UNDIRECTED, /*error*/ 0);
+    for (i = 0; i < igraph_vector_size(&eids); i++) {
+        long int e = VECTOR(eids)[i], from, to;
+        if (e < 0) {
+            continue;
+        }
+
+        from = IGRAPH_FROM(&session->graph, e);
+        to = IGRAPH_TO(&session->graph, e);
+        VECTOR(session->community_degree)[(long int) VECTOR(session->membership)[from]] -= 1;
+        VECTOR(session->community_degree)[(long int) VECTOR(session->membership)[to]] -= 1;
+        markSessionVertex(session, from);
+        markSessionVertex(session, to);
+        VECTOR(eids)[deleted++] = e;
+    }
+    igraph_vector_resize(&eids, deleted);
+    igraph_delete_edges(&session->graph, igraph_ess_vector(&eids));
+
+    igraph_vector_destroy(&eids);
+    igraph_vector_destroy(&pairs);
+
+    return deleted;
+}
+
+// Runs the algorithm on the whole graph the first time or with @full, revisits the marked vertices otherwise
+EMSCRIPTEN_KEEPALIVE
+int sessionDetect(session_t *session, int full) {
+    igraph_t *g = &session->graph;
+    igraph_integer_t n = igraph_vcount(g);
+    igraph_real_t m2 = 2.0 * igraph_ecount(g), modularity;
+    igraph_vector_t neighbors, weight, membership;
+    igraph_vector_int_t touched;
+    long int moved = 0, i;
+    int result;
+
+    igraph_set_progress_handler(progress_handler);
+
+    // A failed run keeps the previous partition, the next call runs on the whole graph again
+    if (full || !session->detected) {
+        igraph_vector_init(&membership, 0);
+        if (session->mode == SESSION_LABEL_PROPAGATION) {
+            result = igraph_community_label_propagation(g, &membership, 0, /*initial*/ 0, /*fixed*/ 0, 0);
+        } else {
+            result = igraph_community_multilevel(g, 0, &membership, 0, 0);
+        }
+        if (result == 0) {
+            igraph_vector_update(&session->membership, &membership);
+        }
+        igraph_vector_destroy(&membership);
+        if (result != 0) {
+            session->detected = 0;
+            return result;
+        }
+
+        resetSessionCommunities(session);
+        igraph_dqueue_clear(&session->queue);
+        igraph_vector_bool_null(&session->marked);
+        session->detected = 1;
+        moved = n;
+    }
+
+    // Local moving: a marked vertex moves to the community of its neighbors of the largest modularity gain, or
+    // of the most of them with label propagation; the neighbors left in other communities are marked then
+    igraph_vector_init(&neighbors, 0);
+    igraph_vector_init(&weight, n);
+    igraph_vector_int_init(&touched, 0);
+    while (!igraph_dqueue_empty(&session->queue)) {
+        long int v = igraph_dqueue_pop(&session->queue);
+        long int from = VECTOR(session->membership)[v], best;
+        igraph_real_t degree, best_gain;
+
+        VECTOR(session->marked)[v] = 0;
+        igraph_neighbors(g, &neighbors, v, IGRAPH_ALL);
+        degree = igraph_vector_size(&neighbors);
+
+        for (i = 0; i < degree; i++) {
+            long int u = VECTOR(neighbors)[i], c = VECTOR(session->membership)[u];
+            if (u == v) {
+                continue;
+            }
+            if (VECTOR(weight)[c] == 0) {
+                igraph_vector_int_push_back(&touched, c);
+            }
+            VECTOR(weight)[c] += 1;
+        }
+
+        best = from;
+        if (session->mode == SESSION_LABEL_PROPAGATION) {
+            best_gain = VECTOR(weight)[from];
+            for (i = 0; i < igraph_vector_int_size(&touched); i++) {
+                long int c = VECTOR(touched)[i];
+                if (VECTOR(weight)[c] > best_gain) {
+                    best = c;
+                    best_gain = VECTOR(weight)[c];
+                }
+            }
+        } else if (m2 > 0) {
+            // Gains relative to v alone, v counts in its own community only by its edges
+            best_gain = VECTOR(weight)[from] - degree * (VECTOR(session->community_degree)[from] - degree) / m2;
+            for (i = 0; i < igraph_vector_int_size(&touched); i++) {
+                long int c = VECTOR(touched)[i];
+                igraph_real_t gain = VECTOR(weight)[c] - degree * VECTOR(session->community_degree)[c] / m2;
+                if (c != from && gain > best_gain) {
+                    best = c;
+                    best_gain = gain;
+                }
+            }
+            if (best_gain < 0 && VECTOR(session->community_size)[from] > 1) {
+                best = newSessionCommunity(session);
+            }
+        }
+
+        for (i = 0; i < igraph_vector_int_size(&touched); i++) {
+            VECTOR(weight)[(long int) VECTOR(touched)[i]] = 0;
+        }
+        igraph_vector_int_clear(&touched);
+
+        if (best != from) {
+            moveSessionVertex(session, v, best, degree);
+            moved++;
+            for (i = 0; i < degree; i++) {
+                long int u = VECTOR(neighbors)[i];
+                if (u != v && VECTOR(session->membership)[u] != best) {
+                    markSessionVertex(session, u);
+                }
+            }
+        }
+    }
+    igraph_vector_int_destroy(&touched);
+    igraph_vector_destroy(&weight);
+    igraph_vector_destroy(&neighbors);
+
+    igraph_vector_copy(&membership, &session->membership);
+    modularity = IGRAPH_NAN;
+    if (n > 0) {
+        igraph_reindex_membership(&membership, 0, 0);
+        result = igraph_modularity(g, &membership, &modularity, 0);
+        if (result != 0) {
+            igraph_vector_destroy(&membership);
+            return result;
+        }
+    }
+
+    destroyBuffer(session->result);
+    session->result = createBuffer(2 + n);
+    session->result[0] = modularity;
+    session->result[1] = moved;
+    igraph_vector_copy_to(&membership, session->result + 2);
+    igraph_vector_destroy(&membership);
+
+    return 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_integer_t getSessionVertexCount(session_t *session) {
+    return igraph_vcount(&session->graph);
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getSessionResultPointer(session_t *session) {
+    return session->result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void destroySession(session_t *session) {
+    destroyBuffer(session->result);
+    igraph_dqueue_destroy(&session->queue);
+    igraph_vector_bool_destroy(&session->marked);
+    igraph_vector_int_destroy(&session->free_ids);
+    igraph_vector_destroy(&session->community_size);
+    igraph_vector_destroy(&session->community_degree);
+    igraph_vector_destroy(&session->membership);
+    igraph_destroy(&session->graph);
+    free(session);
+}
+
+// Helpers
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getScorePointer() {
+    return score_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeScore() {
+    destroyBuffer(score_result);
+    score_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getOverlappingPointer() {
+    return overlapping_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getOverlappingSize() {
+    return overlapping_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeOverlapping() {
+    destroyBuffer(overlapping_result);
+    overlapping_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getSweepPointer() {
+    return sweep_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getSweepSize() {
+    return sweep_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeSweep() {
+    destroyBuffer(sweep_result);
+    sweep_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getConsensusPointer() {
+    return consensus_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeConsensus() {
+    destroyBuffer(consensus_result);
+    consensus_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getPageRankPointer() {
+    return pagerank_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getPageRankSize() {
+    return pagerank_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freePageRank() {
+    destroyBuffer(pagerank_result);
+    pagerank_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getTrianglePointer() {
+    return triangle_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeTriangles() {
+    destroyBuffer(triangle_result);
+    triangle_result = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getGeneratedEdgesPointer() {
+    return generated_edges_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getGeneratedEdgesSize() {
+    return generated_edges_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getPlantedMembershipPointer() {
+    return planted_membership_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void freeGeneratedGraph() {
+    destroyBuffer(generated_edges_result);
+    destroyBuffer(planted_membership_result);
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getMembershipPointer() {
+    return membership_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double* getModularitiesFoundPointer() {
+    return modularities_found_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getModularitiesFoundSize() {
+    return modularities_found_size;
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -376,8 +3200,72 @@ igraph_real_t getMembershipModularity() {
     return membership_modularity_result;
 }
 
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t* getDendrogramPointer() {
+    return dendrogram_result;
+}
+
+EMSCRIPTEN_KEEPALIVE
+size_t getDendrogramSize() {
+    return dendrogram_size;
+}
+
+EMSCRIPTEN_KEEPALIVE
+igraph_real_t getDendrogramLoglikelihood() {
+    return dendrogram_loglikelihood;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setArenaMode(int enabled) {
+    arena_mode = enabled;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setComponentMode(int enabled, int min_component_size) {
+    component_mode_min_size = enabled ? (min_component_size > 1 ? min_component_size : 1) : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setCorePruning(int k) {
+    core_pruning_k = k > 0 ? k : 0;
+}
+
+// Weights of the edges of the next runs, one per edge and positive; zero for unweighted runs. The buffer is not
+// copied, it has to outlive the runs.
+EMSCRIPTEN_KEEPALIVE
+void setEdgeWeights(const igraph_real_t *weights) {
+    edge_weights = weights;
+}
+
+// Loaded graph of the next runs, which ignore their edges buffer; zero to run on the edges buffer again
+EMSCRIPTEN_KEEPALIVE
+void setRunGraph(loaded_graph_t *graph) {
+    run_graph = graph;
+}
+
+// Largest arena usage of the last run in arena mode
+EMSCRIPTEN_KEEPALIVE
+size_t getArenaPeak() {
+    size_t peak;
+    igraph_memory_arena_stats(&peak, 0);
+    return peak;
+}
+
+// Arena memory kept for the next run
+EMSCRIPTEN_KEEPALIVE
+size_t getArenaReserved() {
+    size_t reserved;
+    igraph_memory_arena_stats(0, &reserved);
+    return reserved;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void freeResult() {
     destroyBuffer(membership_result);
     destroyBuffer(modularities_found_result);
+    membership_result = 0;
+    modularities_found_result = 0;
+    destroyBuffer(dendrogram_result);
+    dendrogram_result = 0;
+    dendrogram_size = 0;
 }
@@ -0,0 +1,85 @@
+/* -*- mode: C -*-  */
+/*
+   IGraph library.
+   Copyright (C) 2013  Gabor Csardi <csardi.gabor@gmail.com>
+   334 Harvard st, Cambridge MA, 02139 USA
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc.,  51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301 USA
+
+*/
+
+#include <igraph.h>
+
+#include "bench.h"
+
+#define N 100000
+#define M 1000000
+#define REPS 10
+
+/* Every call builds the oi/ii index of the whole edge list once */
+void create_graphs(const igraph_vector_t *edges, igraph_bool_t directed) {
+    igraph_t g;
+    int i;
+
+    for (i = 0; i < REPS; i++) {
+        igraph_create(&g, edges, N, directed);
+        igraph_destroy(&g);
+    }
+}
+
+void delete_and_add_edges(igraph_t *g, const igraph_vector_t *edges) {
+    igraph_vector_t removed;
+    int i;
+
+    igraph_vector_view(&removed, VECTOR(*edges), M / 5);
+    for (i = 0; i < REPS; i++) {
+        igraph_delete_edges(g, igraph_ess_seq(0, M / 10 - 1));
+        igraph_add_edges(g, &removed, 0);
+    }
+}
+
+int main() {
+
+    igraph_t g;
+    igraph_vector_t edges;
+    long int i;
+
+    igraph_rng_seed(igraph_rng_default(), 42);
+
+    igraph_vector_init(&edges, 2 * M);
+    for (i = 0; i < 2 * M; i++) {
+        VECTOR(edges)[i] = RNG_INTEGER(0, N - 1);
+    }
+
+    BENCH("1 Create undirected graph, 100,000 vertices, 1,000,000 edges, 10x",
+          create_graphs(&edges, IGRAPH_UNDIRECTED);
+         );
+
+    BENCH("2 Create directed graph,   100,000 vertices, 1,000,000 edges, 10x",
+          create_graphs(&edges, IGRAPH_DIRECTED);
+         );
+
+    igraph_create(&g, &edges, N, IGRAPH_UNDIRECTED);
+
+    BENCH("3 Delete and add back 100,000 edges,                         10x",
+          delete_and_add_edges(&g, &edges);
+         );
+
+    igraph_destroy(&g);
+    igraph_vector_destroy(&edges);
+
+    return 0;
+}
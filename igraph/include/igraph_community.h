@@ -52,6 +52,11 @@ DECLDIR int igraph_community_optimal_modularity(const igraph_t *graph,
         igraph_real_t *modularity,
         igraph_vector_t *membership,
         const igraph_vector_t *weights);
+DECLDIR int igraph_community_optimal_modularity_resolution(const igraph_t *graph,
+        igraph_real_t resolution,
+        igraph_real_t *modularity,
+        igraph_vector_t *membership,
+        const igraph_vector_t *weights);
 
 DECLDIR int igraph_community_spinglass(const igraph_t *graph,
                                        const igraph_vector_t *weights,
@@ -73,6 +78,22 @@ DECLDIR int igraph_community_spinglass(const igraph_t *graph,
                                        /*                    igraph_real_t *polarization, */
                                        igraph_real_t lambda);
 
+DECLDIR int igraph_community_spinglass_replicas(const igraph_t *graph,
+        const igraph_vector_t *weights,
+        igraph_real_t *modularity,
+        igraph_real_t *temperature,
+        igraph_vector_t *membership,
+        igraph_vector_t *csize,
+        igraph_integer_t spins,
+        igraph_bool_t parupdate,
+        igraph_real_t starttemp,
+        igraph_real_t stoptemp,
+        igraph_real_t coolfact,
+        igraph_spincomm_update_t update_rule,
+        igraph_real_t gamma,
+        igraph_integer_t replicas,
+        igraph_vector_t *replica_modularity);
+
 DECLDIR int igraph_community_spinglass_single(const igraph_t *graph,
         const igraph_vector_t *weights,
         igraph_integer_t vertex,
@@ -229,6 +250,11 @@ DECLDIR int igraph_community_fluid_communities(const igraph_t *graph,
         igraph_vector_t *membership,
         igraph_real_t *modularity);
 
+DECLDIR int igraph_community_fluid_communities_semisync(const igraph_t *graph,
+        igraph_integer_t no_of_communities,
+        igraph_vector_t *membership,
+        igraph_real_t *modularity);
+
 DECLDIR int igraph_community_label_propagation(const igraph_t *graph,
         igraph_vector_t *membership,
         const igraph_vector_t *weights,
@@ -236,11 +262,24 @@ DECLDIR int igraph_community_label_propagation(const igraph_t *graph,
         igraph_vector_bool_t *fixed,
         igraph_real_t *modularity);
 
+DECLDIR int igraph_community_label_propagation_semisync(const igraph_t *graph,
+        igraph_vector_t *membership,
+        const igraph_vector_t *weights,
+        const igraph_vector_t *initial,
+        igraph_vector_bool_t *fixed,
+        igraph_real_t *modularity);
+
 DECLDIR int igraph_community_multilevel(const igraph_t *graph,
                                         const igraph_vector_t *weights,
                                         igraph_vector_t *membership,
                                         igraph_matrix_t *memberships,
                                         igraph_vector_t *modularity);
+DECLDIR int igraph_community_multilevel_resolution(const igraph_t *graph,
+        const igraph_vector_t *weights,
+        igraph_real_t resolution,
+        igraph_vector_t *membership,
+        igraph_matrix_t *memberships,
+        igraph_vector_t *modularity);
 
 // Louvain_Seed
 DECLDIR int igraph_community_multilevel_seed(const igraph_t *graph,
@@ -97,6 +97,16 @@ DECLDIR int igraph_hrg_consensus(const igraph_t *graph,
                                  igraph_bool_t start,
                                  int num_samples);
 
+DECLDIR int igraph_hrg_fit_chains(const igraph_t *graph,
+                                  igraph_hrg_t *hrg,
+                                  igraph_vector_t *parents,
+                                  igraph_vector_t *weights,
+                                  int no_of_chains,
+                                  int steps,
+                                  int exchange_period,
+                                  int num_samples,
+                                  igraph_real_t *loglikelihood);
+
 DECLDIR int igraph_hrg_predict(const igraph_t *graph,
                                igraph_vector_t *edges,
                                igraph_vector_t *prob,
@@ -29,9 +29,11 @@
 
 __BEGIN_DECLS
 
-#define igraph_Calloc(n,t)    (t*) calloc( (size_t)(n), sizeof(t) )
-#define igraph_Realloc(p,n,t) (t*) realloc((void*)(p), (size_t)((n)*sizeof(t)))
-#define igraph_Free(p)        (free( (void *)(p) ), (p) = NULL)
+/* These go to calloc/realloc/free, or to the arena between
+   igraph_memory_arena_begin() and igraph_memory_arena_end() */
+#define igraph_Calloc(n,t)    (t*) igraph_i_calloc( (size_t)(n), sizeof(t) )
+#define igraph_Realloc(p,n,t) (t*) igraph_i_realloc((void*)(p), (size_t)((n)*sizeof(t)))
+#define igraph_Free(p)        (igraph_i_free( (void *)(p) ), (p) = NULL)
 
 /* #ifndef IGRAPH_NO_CALLOC */
 /* #  define Calloc igraph_Calloc */
@@ -42,6 +44,14 @@ __BEGIN_DECLS
 DECLDIR int igraph_free(void *p);
 DECLDIR void *igraph_malloc(size_t n);
 
+DECLDIR void igraph_memory_arena_begin(void);
+DECLDIR void igraph_memory_arena_end(void);
+DECLDIR void igraph_memory_arena_stats(size_t *peak, size_t *reserved);
+
+DECLDIR void *igraph_i_calloc(size_t n, size_t size);
+DECLDIR void *igraph_i_realloc(void *p, size_t size);
+DECLDIR void igraph_i_free(void *p);
+
 __END_DECLS
 
 #endif
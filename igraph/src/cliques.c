@@ -662,7 +662,7 @@ int igraph_i_maximal_independent_vertex_sets_backtrack(const igraph_t *graph,
                     IGRAPH_CHECK(igraph_vector_ptr_push_back(res, vec));
                 } else {
                     igraph_vector_destroy(vec);
-                    free(vec);
+                    igraph_Free(vec);
                 }
             }
             IGRAPH_FINALLY_CLEAN(1);
@@ -74,7 +74,9 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
                                       igraph_real_t stoptemp,
                                       igraph_real_t coolfact,
                                       igraph_spincomm_update_t update_rule,
-                                      igraph_real_t gamma);
+                                      igraph_real_t gamma,
+                                      igraph_integer_t replicas,
+                                      igraph_vector_t *replica_modularity);
 
 int igraph_i_community_spinglass_negative(const igraph_t *graph,
         const igraph_vector_t *weights,
@@ -211,7 +213,8 @@ int igraph_community_spinglass(const igraph_t *graph,
                 temperature, membership, csize,
                 spins, parupdate, starttemp,
                 stoptemp, coolfact, update_rule,
-                gamma);
+                gamma, /*replicas=*/ 1,
+                /*replica_modularity=*/ 0);
         break;
     case IGRAPH_SPINCOMM_IMP_NEG:
         return igraph_i_community_spinglass_negative(graph, weights, modularity,
@@ -231,6 +234,74 @@ int igraph_community_spinglass(const igraph_t *graph,
     return 0;
 }
 
+/**
+ * \function igraph_community_spinglass_replicas
+ * \brief Spinglass community detection with several annealing runs
+ *
+ * This function runs the simulated annealing of the original
+ * implementation of \ref igraph_community_spinglass() several times,
+ * each time from a different random spin configuration, and returns
+ * the result with the lowest energy. The network is converted and
+ * the starting temperature is searched for only once; these are
+ * shared by all runs. Negative weights are not supported.
+ *
+ * \param graph The input graph, it may be directed but the direction
+ *     of the edge is not used in the algorithm.
+ * \param weights The vector giving the edge weights, it may be \c NULL,
+ *     in which case all edges are weighted equally.
+ * \param modularity Pointer to a real number, if not \c NULL then the
+ *     modularity score of the best solution will be stored here.
+ * \param temperature Pointer to a real number, if not \c NULL then
+ *     the temperature at the end of the best run will be stored here.
+ * \param membership Pointer to an initialized vector or \c NULL. If
+ *     not \c NULL then the best clustering will be stored here.
+ * \param csize Pointer to an initialized vector or \c NULL. If not \c
+ *     NULL then the cluster sizes of the best clustering will be
+ *     stored here.
+ * \param spins Integer giving the number of spins, ie. the maximum
+ *     number of clusters.
+ * \param parupdate A logical constant, whether to update all spins in
+ *     parallel.
+ * \param starttemp Real number, the temperature at the start.
+ * \param stoptemp Real number, the algorithm stops at this
+ *     temperature.
+ * \param coolfact Real number, the cooling factor for the simulated
+ *     annealing.
+ * \param update_rule The null model, see \ref
+ *     igraph_community_spinglass().
+ * \param gamma Real number. The gamma parameter of the algorithm.
+ * \param replicas The number of annealing runs, at least one.
+ * \param replica_modularity Pointer to an initialized vector or \c
+ *     NULL. If not \c NULL then the modularity of the result of each
+ *     run is stored here, in the order of the runs.
+ * \return Error code.
+ *
+ * Time complexity: \p replicas times the time complexity of \ref
+ * igraph_community_spinglass().
+ */
+
+int igraph_community_spinglass_replicas(const igraph_t *graph,
+                                        const igraph_vector_t *weights,
+                                        igraph_real_t *modularity,
+                                        igraph_real_t *temperature,
+                                        igraph_vector_t *membership,
+                                        igraph_vector_t *csize,
+                                        igraph_integer_t spins,
+                                        igraph_bool_t parupdate,
+                                        igraph_real_t starttemp,
+                                        igraph_real_t stoptemp,
+                                        igraph_real_t coolfact,
+                                        igraph_spincomm_update_t update_rule,
+                                        igraph_real_t gamma,
+                                        igraph_integer_t replicas,
+                                        igraph_vector_t *replica_modularity) {
+    return igraph_i_community_spinglass_orig(graph, weights, modularity,
+            temperature, membership, csize,
+            spins, parupdate, starttemp,
+            stoptemp, coolfact, update_rule,
+            gamma, replicas, replica_modularity);
+}
+
 int igraph_i_community_spinglass_orig(const igraph_t *graph,
                                       const igraph_vector_t *weights,
                                       igraph_real_t *modularity,
@@ -243,12 +314,16 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
                                       igraph_real_t stoptemp,
                                       igraph_real_t coolfact,
                                       igraph_spincomm_update_t update_rule,
-                                      igraph_real_t gamma) {
+                                      igraph_real_t gamma,
+                                      igraph_integer_t replicas,
+                                      igraph_vector_t *replica_modularity) {
 
     unsigned long changes, runs;
     igraph_bool_t use_weights = 0;
     bool zeroT;
-    double kT, acc, prob;
+    double kT, kT_start, acc, prob;
+    double energy, best_energy = 0.0;
+    igraph_integer_t replica;
     ClusterList<NNode*> *cl_cur;
     network *net;
     PottsModel *pm;
@@ -278,6 +353,9 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
         IGRAPH_ERROR("starttemp should be larger in absolute value than stoptemp",
                      IGRAPH_EINVAL);
     }
+    if (replicas < 1) {
+        IGRAPH_ERROR("Invalid number of replicas", IGRAPH_EINVAL);
+    }
 
     /* Check whether we have a single component */
     igraph_bool_t conn;
@@ -286,6 +364,10 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
         IGRAPH_ERROR("Cannot work with unconnected graph", IGRAPH_EINVAL);
     }
 
+    if (replica_modularity) {
+        IGRAPH_CHECK(igraph_vector_resize(replica_modularity, replicas));
+    }
+
     net = new network;
     net->node_list   = new DL_Indexed_List<NNode*>();
     net->link_list   = new DL_Indexed_List<NLink*>();
@@ -300,6 +382,12 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
 
     pm = new PottsModel(net, (unsigned int)spins, update_rule);
 
+    /* the model keeps the network in its adjacency arrays, the links
+       and the neighbour lists of the nodes are not needed any more */
+    while (net->link_list->Size()) {
+        delete net->link_list->Pop();
+    }
+
     /* initialize the random number generator */
     RNG_BEGIN();
 
@@ -308,53 +396,66 @@ int igraph_i_community_spinglass_orig(const igraph_t *graph,
     } else {
         zeroT = false;
     }
+    /* the starting temperature is shared by all replicas */
     if (!zeroT) {
-        kT = pm->FindStartTemp(gamma, prob, starttemp);
+        kT_start = pm->FindStartTemp(gamma, prob, starttemp);
     } else {
-        kT = stoptemp;
+        kT_start = stoptemp;
     }
-    /* assign random initial configuration */
-    pm->assign_initial_conf(-1);
-    runs = 0;
-    changes = 1;
 
-    while (changes > 0 && (kT / stoptemp > 1.0 || (zeroT && runs < 150))) {
+    for (replica = 0; replica < replicas; replica++) {
+        kT = kT_start;
+        /* assign random initial configuration */
+        pm->assign_initial_conf(-1);
+        runs = 0;
+        changes = 1;
 
-        IGRAPH_ALLOW_INTERRUPTION(); /* This is not clean.... */
+        while (changes > 0 && (kT / stoptemp > 1.0 || (zeroT && runs < 150))) {
 
-        runs++;
-        if (!zeroT) {
-            kT *= coolfact;
-            if (parupdate) {
-                changes = pm->HeatBathParallelLookup(gamma, prob, kT, 50);
-            } else {
-                acc = pm->HeatBathLookup(gamma, prob, kT, 50);
-                if (acc < (1.0 - 1.0 / double(spins)) * 0.01) {
-                    changes = 0;
+            IGRAPH_ALLOW_INTERRUPTION(); /* This is not clean.... */
+
+            runs++;
+            if (!zeroT) {
+                kT *= coolfact;
+                if (parupdate) {
+                    changes = pm->HeatBathParallelLookup(gamma, prob, kT, 50);
                 } else {
-                    changes = 1;
+                    acc = pm->HeatBathLookup(gamma, prob, kT, 50);
+                    if (acc < (1.0 - 1.0 / double(spins)) * 0.01) {
+                        changes = 0;
+                    } else {
+                        changes = 1;
+                    }
                 }
-            }
-        } else {
-            if (parupdate) {
-                changes = pm->HeatBathParallelLookupZeroTemp(gamma, prob, 50);
             } else {
-                acc = pm->HeatBathLookupZeroTemp(gamma, prob, 50);
-                /* less than 1 percent acceptance ratio */
-                if (acc < (1.0 - 1.0 / double(spins)) * 0.01) {
-                    changes = 0;
+                if (parupdate) {
+                    changes = pm->HeatBathParallelLookupZeroTemp(gamma, prob, 50);
                 } else {
-                    changes = 1;
+                    acc = pm->HeatBathLookupZeroTemp(gamma, prob, 50);
+                    /* less than 1 percent acceptance ratio */
+                    if (acc < (1.0 - 1.0 / double(spins)) * 0.01) {
+                        changes = 0;
+                    } else {
+                        changes = 1;
+                    }
                 }
             }
-        }
-    } /* while loop */
+        } /* while loop */
 
-    pm->WriteClusters(modularity, temperature, csize, membership, kT, gamma);
+        if (replica_modularity) {
+            pm->WriteClusters(&VECTOR(*replica_modularity)[replica], 0, 0, 0,
+                              kT, gamma);
+        }
 
-    while (net->link_list->Size()) {
-        delete net->link_list->Pop();
+        /* keep the configuration with the lowest energy */
+        energy = pm->calculate_hamiltonian(gamma, prob);
+        if (replica == 0 || energy < best_energy) {
+            best_energy = energy;
+            pm->WriteClusters(modularity, temperature, csize, membership,
+                              kT, gamma);
+        }
     }
+
     while (net->node_list->Size()) {
         delete net->node_list->Pop();
     }
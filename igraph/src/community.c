@@ -31,6 +31,7 @@
 #include "igraph_adjlist.h"
 #include "igraph_interface.h"
 #include "igraph_interrupt_internal.h"
+#include "igraph_coloring.h"
 #include "igraph_components.h"
 #include "igraph_dqueue.h"
 #include "igraph_progress.h"
@@ -38,6 +39,7 @@
 #include "igraph_spmatrix.h"
 #include "igraph_statusbar.h"
 #include "igraph_types_internal.h"
+#include "igraph_simd_internal.h"
 #include "igraph_conversion.h"
 #include "igraph_centrality.h"
 #include "igraph_structural.h"
@@ -863,7 +865,7 @@ int igraph_community_edge_betweenness(const igraph_t *graph,
 
     if (result_owned) {
         igraph_vector_destroy(result);
-        free(result);
+        igraph_Free(result);
         IGRAPH_FINALLY_CLEAN(2);
     }
 
@@ -1279,7 +1281,7 @@ int igraph_community_edge_betweenness_seed(const igraph_t *graph,
 
     if (result_owned) {
         igraph_vector_destroy(result);
-        free(result);
+        igraph_Free(result);
         IGRAPH_FINALLY_CLEAN(2);
     }
 
@@ -1475,7 +1477,6 @@ int igraph_modularity(const igraph_t *graph,
     long int types = (long int) igraph_vector_max(membership) + 1;
     long int no_of_edges = igraph_ecount(graph);
     long int i;
-    igraph_integer_t from, to;
     igraph_real_t m;
     long int c1, c2;
 
@@ -1508,9 +1509,8 @@ int igraph_modularity(const igraph_t *graph,
             if (w < 0) {
                 IGRAPH_ERROR("negative weight in weight vector", IGRAPH_EINVAL);
             }
-            igraph_edge(graph, (igraph_integer_t) i, &from, &to);
-            c1 = (long int) VECTOR(*membership)[from];
-            c2 = (long int) VECTOR(*membership)[to];
+            c1 = (long int) VECTOR(*membership)[IGRAPH_FROM(graph, i)];
+            c2 = (long int) VECTOR(*membership)[IGRAPH_TO(graph, i)];
             if (c1 == c2) {
                 VECTOR(e)[c1] += 2 * w;
             }
@@ -1520,9 +1520,8 @@ int igraph_modularity(const igraph_t *graph,
     } else {
         m = no_of_edges;
         for (i = 0; i < no_of_edges; i++) {
-            igraph_edge(graph, (igraph_integer_t) i, &from, &to);
-            c1 = (long int) VECTOR(*membership)[from];
-            c2 = (long int) VECTOR(*membership)[to];
+            c1 = (long int) VECTOR(*membership)[IGRAPH_FROM(graph, i)];
+            c2 = (long int) VECTOR(*membership)[IGRAPH_TO(graph, i)];
             if (c1 == c2) {
                 VECTOR(e)[c1] += 2;
             }
@@ -1533,11 +1532,7 @@ int igraph_modularity(const igraph_t *graph,
 
     *modularity = 0.0;
     if (m > 0) {
-        for (i = 0; i < types; i++) {
-            igraph_real_t tmp = VECTOR(a)[i] / 2 / m;
-            *modularity += VECTOR(e)[i] / 2 / m;
-            *modularity -= tmp * tmp;
-        }
+        *modularity = igraph_i_modularity_sum(VECTOR(e), VECTOR(a), types, m);
     }
 
     igraph_vector_destroy(&e);
@@ -2000,6 +1995,48 @@ int igraph_i_community_leading_eigenvector2_weighted(igraph_real_t *to,
     return 0;
 }
 
+/* Sets the number of Lanczos vectors for a subproblem: the value
+   requested by the user, capped by the problem size, or 0 for
+   "automatic" */
+
+static void igraph_i_levc_set_ncv(igraph_arpack_options_t *options, int ncv) {
+    if (ncv > options->n) {
+        ncv = options->n;
+    }
+    if (ncv != 0 && ncv <= options->nev) {
+        ncv = options->nev + 1;
+    }
+    options->ncv = ncv;
+}
+
+/* Fills 'resid' with the leading eigenvector of the parent community
+   restricted to the first 'n' vertices of the current one. The
+   constant component is removed, as the all-ones vector is in the null
+   space of the generalized modularity matrix. Returns false if there
+   is no usable starting vector, e.g. for the initial communities. */
+
+static igraph_bool_t igraph_i_levc_warm_start(const igraph_vector_t *startvec,
+        const igraph_vector_t *idx,
+        long int n, igraph_real_t *resid) {
+    long int j;
+    igraph_real_t mean = 0.0, norm = 0.0;
+
+    for (j = 0; j < n; j++) {
+        resid[j] = VECTOR(*startvec)[ (long int) VECTOR(*idx)[j] ];
+        if (!IGRAPH_FINITE(resid[j])) {
+            return 0;
+        }
+        mean += resid[j];
+    }
+    mean /= n;
+    for (j = 0; j < n; j++) {
+        resid[j] -= mean;
+        norm += resid[j] * resid[j];
+    }
+
+    return norm > 1e-16;
+}
+
 void igraph_i_levc_free(igraph_vector_ptr_t *ptr) {
     long int i, n = igraph_vector_ptr_size(ptr);
     for (i = 0; i < n; i++) {
@@ -2060,8 +2097,12 @@ void igraph_i_error_handler_none(const char *reason, const char *file,
  *    underlying community structure and no further steps can be
  *    done. If you want as many steps as possible then supply the
  *    number of vertices in the network here.
- * \param options The options for ARPACK. \c n is always
- *    overwritten. \c ncv is set to at least 4.
+ * \param options The options for ARPACK. \c n and \c start are always
+ *    overwritten. \c tol is used as given, \c ncv is capped by the
+ *    size of the community being split, zero means automatic.
+ *    Each community is split starting from the leading eigenvector
+ *    of its parent community restricted to its vertices, the initial
+ *    communities start from a random vector.
  * \param modularity If not a null pointer, then it must be a pointer
  *    to a real number and the modularity score of the final division
  *    is stored here.
@@ -2156,6 +2197,8 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
         weights ? igraph_i_community_leading_eigenvector2_weighted :
         igraph_i_community_leading_eigenvector2;
     igraph_real_t sumweights = 0.0;
+    igraph_vector_t startvec;
+    int ncv = options->ncv;
 
     if (weights && no_of_edges != igraph_vector_size(weights)) {
         IGRAPH_ERROR("Invalid weight vector length", IGRAPH_EINVAL);
@@ -2277,16 +2320,21 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
         sumweights = igraph_vector_sum(weights);
     }
 
-    options->ncv = 0;   /* 0 means "automatic" in igraph_arpack_rssolve */
     options->start = 0;
     options->which[0] = 'L'; options->which[1] = 'A';
 
-    /* Memory for ARPACK */
-    /* We are allocating memory for 20 eigenvectors since options->ncv won't be
-     * larger than 20 when using automatic mode in igraph_arpack_rssolve */
-    IGRAPH_CHECK(igraph_arpack_storage_init(&storage, (int) no_of_nodes, 20,
+    /* Memory for ARPACK, shared by all splits */
+    /* We are allocating memory for at least 20 eigenvectors since options->ncv
+     * won't be larger than 20 when using automatic mode in igraph_arpack_rssolve */
+    IGRAPH_CHECK(igraph_arpack_storage_init(&storage, (int) no_of_nodes,
+                                            ncv > 20 ? ncv : 20,
                                             (int) no_of_nodes, 1));
     IGRAPH_FINALLY(igraph_arpack_storage_destroy, &storage);
+
+    /* The last leading eigenvector each vertex was part of, the starting
+       vector of the next split */
+    IGRAPH_VECTOR_INIT_FINALLY(&startvec, no_of_nodes);
+    igraph_vector_fill(&startvec, IGRAPH_NAN);
     extra.idx = &idx;
     extra.idx2 = &idx2;
     extra.tmp = &tmp;
@@ -2333,23 +2381,27 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
         options->info = 0;
         options->nev = 1;
         options->ldv = 0;
-        options->ncv = 0;   /* 0 means "automatic" in igraph_arpack_rssolve */
+        igraph_i_levc_set_ncv(options, ncv);
         options->nconv = 0;
         options->lworkl = 0;        /* we surely have enough space */
         extra.comm = comm;
 
-        /* We try calling the solver twice, once from a random starting
-           point, once from a fixed one. This is because for some hard
-           cases it tends to fail. We need to suppress error handling for
-           the first call. */
+        /* We try calling the solver twice, once from the parent's
+           eigenvector (or a random starting point if there is none),
+           once from a fixed one. This is because for some hard cases it
+           tends to fail. We need to suppress error handling for the
+           first call. */
         {
             int i;
             igraph_error_handler_t *errh =
                 igraph_set_error_handler(igraph_i_error_handler_none);
             igraph_warning_handler_t *warnh =
                 igraph_set_warning_handler(igraph_warning_handler_ignore);
+            options->start = igraph_i_levc_warm_start(&startvec, &idx, options->n,
+                             storage.resid);
             igraph_arpack_rssolve(arpcb2, &extra, options, &storage,
                                   /*values=*/ 0, /*vectors=*/ 0);
+            options->start = 0;
             igraph_set_error_handler(errh);
             igraph_set_warning_handler(warnh);
             if (options->nconv < 1) {
@@ -2362,7 +2414,7 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
                  * for its usage; it just happens to work. */
                 options->start = 1;
                 options->info = 0;
-                options->ncv = 0;
+                igraph_i_levc_set_ncv(options, ncv);
                 options->lworkl = 0;    /* we surely have enough space */
                 for (i = 0; i < options->n ; i++) {
                     storage.resid[i] = i % 2 ? 1 : -1;
@@ -2387,21 +2439,24 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
         options->ldv = 0;
         options->nconv = 0;
         options->lworkl = 0;    /* we surely have enough space */
-        options->ncv = 0;   /* 0 means "automatic" in igraph_arpack_rssolve */
+        igraph_i_levc_set_ncv(options, ncv);
 
         {
             int i;
             igraph_error_handler_t *errh =
                 igraph_set_error_handler(igraph_i_error_handler_none);
+            options->start = igraph_i_levc_warm_start(&startvec, &idx, options->n,
+                             storage.resid);
             igraph_arpack_rssolve(arpcb1, &extra, options, &storage,
                                   /*values=*/ 0, /*vectors=*/ 0);
+            options->start = 0;
             igraph_set_error_handler(errh);
             if (options->nconv < 1) {
                 /* Call again from a fixed starting point. See the comment a few lines
                  * above about the exact choice of this starting vector */
                 options->start = 1;
                 options->info = 0;
-                options->ncv = 0;
+                igraph_i_levc_set_ncv(options, ncv);
                 options->lworkl = 0;    /* we surely have enough space */
                 for (i = 0; i < options->n; i++) {
                     storage.resid[i] = i % 2 ? 1 : -1;
@@ -2499,6 +2554,11 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
             continue;
         }
 
+        /* Remember the eigenvector, the two halves start from it */
+        for (j = 0; j < size; j++) {
+            VECTOR(startvec)[ (long int) VECTOR(idx)[j] ] = storage.v[j];
+        }
+
         /* Count the number of vertices in each community after the split */
         l = 0;
         for (j = 0; j < size; j++) {
@@ -2564,8 +2624,9 @@ int igraph_community_leading_eigenvector(const igraph_t *graph,
 
     }
 
+    igraph_vector_destroy(&startvec);
     igraph_arpack_storage_destroy(&storage);
-    IGRAPH_FINALLY_CLEAN(1);
+    IGRAPH_FINALLY_CLEAN(2);
     if (!weights) {
         igraph_adjlist_destroy(&adjlist);
         IGRAPH_FINALLY_CLEAN(1);
@@ -2709,6 +2770,147 @@ int igraph_le_community_to_membership(const igraph_matrix_t *merges,
 
 /********************************************************************/
 
+static int igraph_i_fluid_communities_check(const igraph_t *graph,
+        igraph_integer_t no_of_communities) {
+    long int no_of_nodes = igraph_vcount(graph);
+    igraph_bool_t res;
+
+    if (no_of_nodes < 2) {
+        IGRAPH_ERROR("Empty and single vertex graphs are not supported.", IGRAPH_EINVAL);
+    }
+    if ((long int) no_of_communities < 1) {
+        IGRAPH_ERROR("'no_of_communities' must be greater than 0.", IGRAPH_EINVAL);
+    }
+    if ((long int) no_of_communities > no_of_nodes) {
+        IGRAPH_ERROR("'no_of_communities' can not be greater than number of nodes in "
+                     "the graph.", IGRAPH_EINVAL);
+    }
+    igraph_is_simple(graph, &res);
+    if (!res) {
+        IGRAPH_ERROR("Only simple graphs are supported.", IGRAPH_EINVAL);
+    }
+    igraph_is_connected(graph, &res, IGRAPH_WEAK);
+    if (!res) {
+        IGRAPH_ERROR("Disconnected graphs are not supported.", IGRAPH_EINVAL);
+    }
+    if (igraph_is_directed(graph)) {
+        IGRAPH_WARNING("Edge directions are ignored.");
+    }
+
+    return 0;
+}
+
+/* Chooses the new label of v1 from the densities of the labels of
+ * its closed neighborhood, 0 means no label. The current label is
+ * kept when it is among the dominant ones. label_counters must be
+ * zero on entry and is zero again on return. */
+static int igraph_i_fluid_communities_choose(const igraph_adjlist_t *al, long int v1,
+        const igraph_vector_t *membership,
+        const igraph_vector_t *density,
+        igraph_vector_t *label_counters,
+        igraph_vector_t *dominant_labels,
+        long int *new_label) {
+    long int j, k, kv1, size;
+    igraph_real_t max_count, label_counter_diff;
+    igraph_vector_int_t *neis;
+
+    igraph_vector_clear(dominant_labels);
+
+    /* Take into account same label in updating rule */
+    kv1 = (long int) VECTOR(*membership)[v1];
+    max_count = 0.0;
+    if (kv1 != 0) {
+        VECTOR(*label_counters)[kv1 - 1] += VECTOR(*density)[kv1 - 1];
+        /* Set up max_count */
+        max_count = VECTOR(*density)[kv1 - 1];
+        /* Initialize dominant_labels */
+        IGRAPH_CHECK(igraph_vector_resize(dominant_labels, 1));
+        VECTOR(*dominant_labels)[0] = kv1;
+    }
+
+    /* Count the weights corresponding to different labels */
+    neis = igraph_adjlist_get(al, v1);
+    size = igraph_vector_int_size(neis);
+    for (j = 0; j < size; j++) {
+        k = (long int) VECTOR(*membership)[(long)VECTOR(*neis)[j]];
+        /* skip if it has no label yet */
+        if (k == 0) {
+            continue;
+        }
+        /* Update label counter and evaluate diff against max_count*/
+        VECTOR(*label_counters)[k - 1] += VECTOR(*density)[k - 1];
+        label_counter_diff = VECTOR(*label_counters)[k - 1] - max_count;
+        /* Check if this label must be included in dominant_labels vector */
+        if (label_counter_diff > 0.0001) {
+            max_count = VECTOR(*label_counters)[k - 1];
+            IGRAPH_CHECK(igraph_vector_resize(dominant_labels, 1));
+            VECTOR(*dominant_labels)[0] = k;
+        } else if (-0.0001 < label_counter_diff && label_counter_diff < 0.0001) {
+            IGRAPH_CHECK(igraph_vector_push_back(dominant_labels, k));
+        }
+    }
+
+    /* Only the counters of the labels seen are cleared */
+    if (kv1 != 0) {
+        VECTOR(*label_counters)[kv1 - 1] = 0.0;
+    }
+    for (j = 0; j < size; j++) {
+        k = (long int) VECTOR(*membership)[(long)VECTOR(*neis)[j]];
+        if (k != 0) {
+            VECTOR(*label_counters)[k - 1] = 0.0;
+        }
+    }
+
+    *new_label = kv1;
+    /* Maintain same label if it exists in dominant_labels, otherwise
+     * select randomly from the dominant labels */
+    if (!igraph_vector_empty(dominant_labels) &&
+        !igraph_vector_contains(dominant_labels, kv1)) {
+        *new_label = (long int) VECTOR(*dominant_labels)[
+                         RNG_INTEGER(0, igraph_vector_size(dominant_labels) - 1)];
+    }
+
+    return 0;
+}
+
+/* Moves v1 from community kv1 to k and updates their densities */
+static void igraph_i_fluid_communities_move(long int v1, long int kv1, long int k,
+        igraph_vector_t *membership,
+        igraph_vector_t *density,
+        igraph_vector_int_t *com_to_numvertices) {
+    if (kv1 != 0) {
+        /* Subtract 1 vertex from corresponding community in com_to_numvertices */
+        VECTOR(*com_to_numvertices)[kv1 - 1] -= 1;
+        /* Re-calculate density for community kv1 */
+        VECTOR(*density)[kv1 - 1] = 1.0 / VECTOR(*com_to_numvertices)[kv1 - 1];
+    }
+
+    /* Update vertex new label */
+    VECTOR(*membership)[v1] = k;
+
+    /* Add 1 vertex to corresponding new community in com_to_numvertices */
+    VECTOR(*com_to_numvertices)[k - 1] += 1;
+    /* Re-calculate density for new community k */
+    VECTOR(*density)[k - 1] = 1.0 / VECTOR(*com_to_numvertices)[k - 1];
+}
+
+/* Shifts back the membership vector, there must be no 0 labels in it
+ * at convergence */
+static int igraph_i_fluid_communities_relabel(igraph_vector_t *membership) {
+    long int i, no_of_nodes = igraph_vector_size(membership);
+
+    for (i = 0; i < no_of_nodes; i++) {
+        VECTOR(*membership)[i] -= 1;
+        /* Something went wrong: At least one vertex has no community assigned */
+        if (VECTOR(*membership)[i] < 0) {
+            IGRAPH_ERROR("Something went wrong during execution. One or more vertices got "
+                         "no community assigned at algorithm convergence.", IGRAPH_EINTERNAL);
+        }
+    }
+
+    return 0;
+}
+
 /**
  * \ingroup communities
  * \function igraph_community_fluid_communities
@@ -2745,38 +2947,18 @@ int igraph_community_fluid_communities(const igraph_t *graph,
                                        igraph_vector_t *membership,
                                        igraph_real_t *modularity) {
     /* Declaration of variables */
-    long int no_of_nodes, i, j, k, kv1;
+    long int no_of_nodes, i, k, kv1;
     igraph_adjlist_t al;
     double max_density;
-    igraph_bool_t res, running;
-    igraph_vector_t node_order, density, label_counters, dominant_labels, nonzero_labels;
+    igraph_bool_t running;
+    igraph_vector_t node_order, density, label_counters, dominant_labels;
     igraph_vector_int_t com_to_numvertices;
 
     /* Initialization of variables needed for initial checking */
     no_of_nodes = igraph_vcount(graph);
 
     /* Checking input values */
-    if (no_of_nodes < 2) {
-        IGRAPH_ERROR("Empty and single vertex graphs are not supported.", IGRAPH_EINVAL);
-    }
-    if ((long int) no_of_communities < 1) {
-        IGRAPH_ERROR("'no_of_communities' must be greater than 0.", IGRAPH_EINVAL);
-    }
-    if ((long int) no_of_communities > no_of_nodes) {
-        IGRAPH_ERROR("'no_of_communities' can not be greater than number of nodes in "
-                     "the graph.", IGRAPH_EINVAL);
-    }
-    igraph_is_simple(graph, &res);
-    if (!res) {
-        IGRAPH_ERROR("Only simple graphs are supported.", IGRAPH_EINVAL);
-    }
-    igraph_is_connected(graph, &res, IGRAPH_WEAK);
-    if (!res) {
-        IGRAPH_ERROR("Disconnected graphs are not supported.", IGRAPH_EINVAL);
-    }
-    if (igraph_is_directed(graph)) {
-        IGRAPH_WARNING("Edge directions are ignored.");
-    }
+    IGRAPH_CHECK(igraph_i_fluid_communities_check(graph, no_of_communities));
 
     /* Internal variables initialization */
     max_density = 1.0;
@@ -2818,7 +3000,6 @@ int igraph_community_fluid_communities(const igraph_t *graph,
 
     /* Create storage space for counting distinct labels and dominant ones */
     IGRAPH_VECTOR_INIT_FINALLY(&dominant_labels, (long int) no_of_communities);
-    IGRAPH_VECTOR_INIT_FINALLY(&nonzero_labels, (long int) no_of_communities);
 
     IGRAPH_CHECK(igraph_vector_init(&label_counters, (long int) no_of_communities));
     IGRAPH_FINALLY(igraph_vector_destroy, &label_counters);
@@ -2826,11 +3007,7 @@ int igraph_community_fluid_communities(const igraph_t *graph,
     /* running is the convergence boolean variable */
     running = 1;
     while (running) {
-        /* Declarations of varibales used inside main loop */
-        long int v1, size, rand_idx;
-        igraph_real_t max_count, label_counter_diff;
-        igraph_vector_int_t *neis;
-        igraph_bool_t same_label_in_dominant;
+        long int v1;
 
         running = 0;
 
@@ -2838,90 +3015,25 @@ int igraph_community_fluid_communities(const igraph_t *graph,
         IGRAPH_CHECK(igraph_vector_shuffle(&node_order));
         /* In the prescribed order, loop over the vertices and reassign labels */
         for (i = 0; i < no_of_nodes; i++) {
-            /* Clear dominant_labels and nonzero_labels vectors */
-            igraph_vector_clear(&dominant_labels);
-            igraph_vector_null(&label_counters);
-
             /* Obtain actual node index */
             v1 = (long int) VECTOR(node_order)[i];
-            /* Take into account same label in updating rule */
             kv1 = (long int) VECTOR(*membership)[v1];
-            max_count = 0.0;
-            if (kv1 != 0) {
-                VECTOR(label_counters)[kv1 - 1] += VECTOR(density)[kv1 - 1];
-                /* Set up max_count */
-                max_count = VECTOR(density)[kv1 - 1];
-                /* Initialize dominant_labels */
-                IGRAPH_CHECK(igraph_vector_resize(&dominant_labels, 1));
-                VECTOR(dominant_labels)[0] = kv1;
-            }
-
-            /* Count the weights corresponding to different labels */
-            neis = igraph_adjlist_get(&al, v1);
-            size = igraph_vector_int_size(neis);
-            for (j = 0; j < size; j++) {
-                k = (long int) VECTOR(*membership)[(long)VECTOR(*neis)[j]];
-                /* skip if it has no label yet */
-                if (k == 0) {
-                    continue;
-                }
-                /* Update label counter and evaluate diff against max_count*/
-                VECTOR(label_counters)[k - 1] += VECTOR(density)[k - 1];
-                label_counter_diff = VECTOR(label_counters)[k - 1] - max_count;
-                /* Check if this label must be included in dominant_labels vector */
-                if (label_counter_diff > 0.0001) {
-                    max_count = VECTOR(label_counters)[k - 1];
-                    IGRAPH_CHECK(igraph_vector_resize(&dominant_labels, 1));
-                    VECTOR(dominant_labels)[0] = k;
-                } else if (-0.0001 < label_counter_diff && label_counter_diff < 0.0001) {
-                    IGRAPH_CHECK(igraph_vector_push_back(&dominant_labels, k));
-                }
-            }
-
-            if (!igraph_vector_empty(&dominant_labels)) {
-                /* Maintain same label if it exists in dominant_labels */
-                same_label_in_dominant = igraph_vector_contains(&dominant_labels, kv1);
-
-                if (!same_label_in_dominant) {
-                    /* We need at least one more iteration */
-                    running = 1;
 
-                    /* Select randomly from the dominant labels */
-                    rand_idx = RNG_INTEGER(0, igraph_vector_size(&dominant_labels) - 1);
-                    k = (long int) VECTOR(dominant_labels)[rand_idx];
+            IGRAPH_CHECK(igraph_i_fluid_communities_choose(&al, v1, membership, &density,
+                         &label_counters, &dominant_labels, &k));
 
-                    if (kv1 != 0) {
-                        /* Subtract 1 vertex from corresponding community in com_to_numvertices */
-                        VECTOR(com_to_numvertices)[kv1 - 1] -= 1;
-                        /* Re-calculate density for community kv1 */
-                        VECTOR(density)[kv1 - 1] = max_density / VECTOR(com_to_numvertices)[kv1 - 1];
-                    }
-
-                    /* Update vertex new label */
-                    VECTOR(*membership)[v1] = k;
-
-                    /* Add 1 vertex to corresponding new community in com_to_numvertices */
-                    VECTOR(com_to_numvertices)[k - 1] += 1;
-                    /* Re-calculate density for new community k */
-                    VECTOR(density)[k - 1] = max_density / VECTOR(com_to_numvertices)[k - 1];
-                }
+            if (k != kv1) {
+                /* We need at least one more iteration */
+                running = 1;
+                igraph_i_fluid_communities_move(v1, kv1, k, membership, &density,
+                                                &com_to_numvertices);
             }
         }
     }
 
     RNG_END();
 
-
-    /* Shift back the membership vector */
-    /* There must be no 0 labels in membership vector at this point */
-    for (i = 0; i < no_of_nodes; i++) {
-        VECTOR(*membership)[i] -= 1;
-        /* Something went wrong: At least one vertex has no community assigned */
-        if (VECTOR(*membership)[i] < 0) {
-            IGRAPH_ERROR("Something went wrong during execution. One or more vertices got "
-                         "no community assigned at algorithm convergence.", IGRAPH_EINTERNAL);
-        }
-    }
+    IGRAPH_CHECK(igraph_i_fluid_communities_relabel(membership));
 
     igraph_adjlist_destroy(&al);
     IGRAPH_FINALLY_CLEAN(1);
@@ -2936,77 +3048,236 @@ int igraph_community_fluid_communities(const igraph_t *graph,
     igraph_vector_int_destroy(&com_to_numvertices);
     igraph_vector_destroy(&label_counters);
     igraph_vector_destroy(&dominant_labels);
-    igraph_vector_destroy(&nonzero_labels);
-    IGRAPH_FINALLY_CLEAN(6);
+    IGRAPH_FINALLY_CLEAN(5);
 
     return 0;
 }
 
-/********************************************************************/
+/* Rounds of semi-synchronous updates before igraph_community_fluid_communities_semisync()
+ * falls back to sequential ones */
+#define IGRAPH_I_FLUID_SEMISYNC_ROUNDS 100
 
 /**
  * \ingroup communities
- * \function igraph_community_label_propagation
- * \brief Community detection based on label propagation
+ * \function igraph_community_fluid_communities_semisync
+ * \brief Semi-synchronous fluid communities
  *
- * This function implements the community detection method described in:
- * Raghavan, U.N. and Albert, R. and Kumara, S.: Near linear time algorithm
- * to detect community structures in large-scale networks. Phys Rev E
- * 76, 036106. (2007). This version extends the original method by
- * the ability to take edge weights into consideration and also
- * by allowing some labels to be fixed.
+ * This function is a variant of \ref igraph_community_fluid_communities()
+ * that updates the vertices by color classes, like
+ * \ref igraph_community_label_propagation_semisync() does.
  *
  * </para><para>
- * Weights are taken into account as follows: when the new label of node
- * i is determined, the algorithm iterates over all edges incident on
- * node i and calculate the total weight of edges leading to other
- * nodes with label 0, 1, 2, ..., k-1 (where k is the number of possible
- * labels). The new label of node i will then be the label whose edges
- * (among the ones incident on node i) have the highest total weight.
+ * The vertices are partitioned into independent sets with a greedy
+ * vertex coloring, see \ref igraph_vertex_coloring_greedy(). The new
+ * labels of a class are chosen with the community densities at the
+ * start of the class and are applied together, then the densities are
+ * updated. No two vertices of a class are adjacent, so the choice of
+ * the new labels may run in parallel, and it does not depend on the
+ * order of the vertices within the class. The algorithm stops when no
+ * vertex changes its label during a round over all the classes.
  *
- * \param graph The input graph, should be undirected to make sense.
- * \param membership The membership vector, the result is returned here.
- *    For each vertex it gives the ID of its community (label).
- * \param weights The weight vector, it should contain a positive
- *    weight for all the edges.
- * \param initial The initial state. If NULL, every vertex will have
- *   a different label at the beginning. Otherwise it must be a vector
- *   with an entry for each vertex. Non-negative values denote different
- *   labels, negative entries denote vertices without labels.
- * \param fixed Boolean vector denoting which labels are fixed. Of course
- *   this makes sense only if you provided an initial state, otherwise
- *   this element will be ignored. Also note that vertices without labels
- *   cannot be fixed.
+ * </para><para>
+ * A community is never emptied: when all its vertices would leave it
+ * in the same class, none of them moves. The stale densities within a
+ * class may make the labels oscillate, so after
+ * \c IGRAPH_I_FLUID_SEMISYNC_ROUNDS rounds the vertices of every class
+ * are updated one after the other, as the original algorithm does,
+ * until convergence.
+ *
+ * \param graph The input graph, see \ref igraph_community_fluid_communities()
+ *   for the requirements.
+ * \param no_of_communities The number of communities to be found. Must be
+ *   greater than 0 and fewer than number of vertices in the graph.
+ * \param membership The result vector mapping vertices to the communities
+ * they are assigned to.
  * \param modularity If not a null pointer, then it must be a pointer
  *   to a real number. The modularity score of the detected community
  *   structure is stored here.
  * \return Error code.
  *
- * Time complexity: O(m+n)
- *
- * \example examples/simple/igraph_community_label_propagation.c
+ * Time complexity: O((n+m) log n) for the coloring, plus O(m) for
+ * every round of updates.
  */
-int igraph_community_label_propagation(const igraph_t *graph,
-                                       igraph_vector_t *membership,
-                                       const igraph_vector_t *weights,
-                                       const igraph_vector_t *initial,
-                                       igraph_vector_bool_t *fixed,
-                                       igraph_real_t *modularity) {
+int igraph_community_fluid_communities_semisync(const igraph_t *graph,
+        igraph_integer_t no_of_communities,
+        igraph_vector_t *membership,
+        igraph_real_t *modularity) {
     long int no_of_nodes = igraph_vcount(graph);
-    long int no_of_edges = igraph_ecount(graph);
-    long int no_of_not_fixed_nodes = no_of_nodes;
-    long int i, j, k;
+    long int no_of_colors, i, c, k, kv1, v1, rounds = 0;
     igraph_adjlist_t al;
-    igraph_inclist_t il;
-    igraph_bool_t running = 1;
+    igraph_bool_t running, sequential = 0;
+    igraph_vector_int_t colors, com_to_numvertices, leavers;
+    igraph_vector_long_t class_start, node_order;
+    igraph_vector_t density, label_counters, dominant_labels, new_labels, initial_order;
 
-    igraph_vector_t label_counters, dominant_labels, nonzero_labels, node_order;
+    IGRAPH_CHECK(igraph_i_fluid_communities_check(graph, no_of_communities));
 
-    /* The implementation uses a trick to avoid negative array indexing:
-     * elements of the membership vector are increased by 1 at the start
-     * of the algorithm; this to allow us to denote unlabeled vertices
-     * (if any) by zeroes. The membership vector is shifted back in the end
-     */
+    IGRAPH_CHECK(igraph_vector_resize(membership, no_of_nodes));
+    igraph_vector_null(membership);
+
+    IGRAPH_VECTOR_INIT_FINALLY(&density, (long int) no_of_communities);
+    igraph_vector_fill(&density, 1.0);
+    IGRAPH_CHECK(igraph_vector_int_init(&com_to_numvertices, (long int) no_of_communities));
+    IGRAPH_FINALLY(igraph_vector_int_destroy, &com_to_numvertices);
+
+    IGRAPH_CHECK(igraph_adjlist_init(graph, &al, IGRAPH_ALL));
+    IGRAPH_FINALLY(igraph_adjlist_destroy, &al);
+
+    IGRAPH_VECTOR_INIT_FINALLY(&label_counters, (long int) no_of_communities);
+    IGRAPH_VECTOR_INIT_FINALLY(&dominant_labels, 0);
+    IGRAPH_CHECK(igraph_vector_reserve(&dominant_labels, 2));
+    IGRAPH_VECTOR_INIT_FINALLY(&new_labels, no_of_nodes);
+    IGRAPH_CHECK(igraph_vector_int_init(&leavers, (long int) no_of_communities));
+    IGRAPH_FINALLY(igraph_vector_int_destroy, &leavers);
+
+    /* Order the vertices by color class */
+    IGRAPH_CHECK(igraph_vector_int_init(&colors, 0));
+    IGRAPH_FINALLY(igraph_vector_int_destroy, &colors);
+    IGRAPH_CHECK(igraph_vertex_coloring_greedy(graph, &colors,
+                 IGRAPH_COLORING_GREEDY_COLORED_NEIGHBORS));
+    no_of_colors = igraph_vector_int_max(&colors) + 1;
+
+    IGRAPH_CHECK(igraph_vector_long_init(&class_start, no_of_colors + 1));
+    IGRAPH_FINALLY(igraph_vector_long_destroy, &class_start);
+    IGRAPH_CHECK(igraph_vector_long_init(&node_order, no_of_nodes));
+    IGRAPH_FINALLY(igraph_vector_long_destroy, &node_order);
+
+    for (i = 0; i < no_of_nodes; i++) {
+        VECTOR(class_start)[VECTOR(colors)[i] + 1] += 1;
+    }
+    for (c = 0; c < no_of_colors; c++) {
+        VECTOR(class_start)[c + 1] += VECTOR(class_start)[c];
+    }
+    for (i = 0; i < no_of_nodes; i++) {
+        VECTOR(node_order)[ VECTOR(class_start)[VECTOR(colors)[i]]++ ] = i;
+    }
+    for (c = no_of_colors; c > 0; c--) {
+        VECTOR(class_start)[c] = VECTOR(class_start)[c - 1];
+    }
+    VECTOR(class_start)[0] = 0;
+
+    RNG_BEGIN();
+
+    /* Every fluid starts at a different random vertex */
+    IGRAPH_CHECK(igraph_vector_init_seq(&initial_order, 0, no_of_nodes - 1));
+    IGRAPH_FINALLY(igraph_vector_destroy, &initial_order);
+    IGRAPH_CHECK(igraph_vector_shuffle(&initial_order));
+    for (i = 0; i < no_of_communities; i++) {
+        VECTOR(*membership)[(long int) VECTOR(initial_order)[i]] = i + 1.0;
+        VECTOR(com_to_numvertices)[i] = 1;
+    }
+    igraph_vector_destroy(&initial_order);
+    IGRAPH_FINALLY_CLEAN(1);
+
+    running = 1;
+    while (running) {
+        running = 0;
+
+        for (c = 0; c < no_of_colors; c++) {
+            if (sequential) {
+                /* Every vertex sees the moves before it */
+                for (i = VECTOR(class_start)[c]; i < VECTOR(class_start)[c + 1]; i++) {
+                    v1 = VECTOR(node_order)[i];
+                    kv1 = (long int) VECTOR(*membership)[v1];
+                    IGRAPH_CHECK(igraph_i_fluid_communities_choose(&al, v1, membership, &density,
+                                 &label_counters, &dominant_labels, &k));
+                    if (k != kv1) {
+                        running = 1;
+                        igraph_i_fluid_communities_move(v1, kv1, k, membership, &density,
+                                                        &com_to_numvertices);
+                    }
+                }
+                continue;
+            }
+
+            /* New labels of the class from the densities at its start,
+             * and the number of vertices leaving every community */
+            for (i = VECTOR(class_start)[c]; i < VECTOR(class_start)[c + 1]; i++) {
+                v1 = VECTOR(node_order)[i];
+                kv1 = (long int) VECTOR(*membership)[v1];
+                IGRAPH_CHECK(igraph_i_fluid_communities_choose(&al, v1, membership, &density,
+                             &label_counters, &dominant_labels, &k));
+                VECTOR(new_labels)[v1] = k;
+                if (k != kv1 && kv1 != 0) {
+                    VECTOR(leavers)[kv1 - 1] += 1;
+                }
+            }
+
+            /* No vertex leaves a community all of whose vertices would */
+            for (i = VECTOR(class_start)[c]; i < VECTOR(class_start)[c + 1]; i++) {
+                v1 = VECTOR(node_order)[i];
+                kv1 = (long int) VECTOR(*membership)[v1];
+                if (kv1 != 0 && VECTOR(leavers)[kv1 - 1] == VECTOR(com_to_numvertices)[kv1 - 1]) {
+                    VECTOR(new_labels)[v1] = kv1;
+                }
+            }
+
+            /* Apply them and update the densities */
+            for (i = VECTOR(class_start)[c]; i < VECTOR(class_start)[c + 1]; i++) {
+                v1 = VECTOR(node_order)[i];
+                kv1 = (long int) VECTOR(*membership)[v1];
+                k = (long int) VECTOR(new_labels)[v1];
+                if (kv1 != 0) {
+                    VECTOR(leavers)[kv1 - 1] = 0;
+                }
+                if (k != kv1) {
+                    running = 1;
+                    igraph_i_fluid_communities_move(v1, kv1, k, membership, &density,
+                                                    &com_to_numvertices);
+                }
+            }
+        }
+
+        if (++rounds == IGRAPH_I_FLUID_SEMISYNC_ROUNDS) {
+            sequential = 1;
+        }
+
+        IGRAPH_ALLOW_INTERRUPTION();
+    }
+
+    RNG_END();
+
+    IGRAPH_CHECK(igraph_i_fluid_communities_relabel(membership));
+
+    igraph_vector_long_destroy(&node_order);
+    igraph_vector_long_destroy(&class_start);
+    igraph_vector_int_destroy(&colors);
+    igraph_vector_int_destroy(&leavers);
+    igraph_vector_destroy(&new_labels);
+    igraph_vector_destroy(&dominant_labels);
+    igraph_vector_destroy(&label_counters);
+    igraph_adjlist_destroy(&al);
+    igraph_vector_int_destroy(&com_to_numvertices);
+    igraph_vector_destroy(&density);
+    IGRAPH_FINALLY_CLEAN(10);
+
+    if (modularity) {
+        IGRAPH_CHECK(igraph_modularity(graph, membership, modularity,
+                                       NULL));
+    }
+
+    return 0;
+}
+
+/********************************************************************/
+
+/* Checks the arguments of label propagation and sets up the initial
+ * membership vector. The implementation uses a trick to avoid negative
+ * array indexing: elements of the membership vector are increased by 1
+ * at the start of the algorithm; this to allow us to denote unlabeled
+ * vertices (if any) by zeroes. The membership vector is shifted back in
+ * the end by igraph_i_label_propagation_relabel() */
+static int igraph_i_label_propagation_init(const igraph_t *graph,
+        igraph_vector_t *membership,
+        const igraph_vector_t *weights,
+        const igraph_vector_t *initial,
+        igraph_vector_bool_t *fixed,
+        long int *no_of_not_fixed_nodes) {
+    long int no_of_nodes = igraph_vcount(graph);
+    long int no_of_edges = igraph_ecount(graph);
+    long int i;
+
+    *no_of_not_fixed_nodes = no_of_nodes;
 
     /* Do some initial checks */
     if (fixed && igraph_vector_bool_size(fixed) != no_of_nodes) {
@@ -3044,7 +3315,7 @@ int igraph_community_label_propagation(const igraph_t *graph,
                         IGRAPH_WARNING("Fixed nodes cannot be unlabeled, ignoring them");
                         VECTOR(*fixed)[i] = 0;
                     } else {
-                        no_of_not_fixed_nodes--;
+                        (*no_of_not_fixed_nodes)--;
                     }
                 }
             }
@@ -3063,6 +3334,179 @@ int igraph_community_label_propagation(const igraph_t *graph,
         }
     }
 
+    return 0;
+}
+
+/* Counts the weights corresponding to the labels of the neighbors of
+ * v1 in label_counters and collects the labels with the highest count
+ * (max_count) in dominant_labels. Labels whose counter became nonzero
+ * are listed in nonzero_labels, so that igraph_i_label_propagation_clear()
+ * can reset them. al is used in the unweighted, il in the weighted case. */
+static int igraph_i_label_propagation_count(const igraph_t *graph,
+        long int v1,
+        const igraph_vector_t *membership,
+        const igraph_vector_t *weights,
+        igraph_adjlist_t *al,
+        igraph_inclist_t *il,
+        igraph_vector_t *label_counters,
+        igraph_vector_t *dominant_labels,
+        igraph_vector_t *nonzero_labels,
+        igraph_real_t *max_count) {
+    long int j, k, num_neis;
+    igraph_vector_int_t *neis;
+    igraph_vector_int_t *ineis;
+    igraph_bool_t was_zero;
+
+    igraph_vector_clear(dominant_labels);
+    igraph_vector_clear(nonzero_labels);
+    *max_count = 0.0;
+    if (weights) {
+        ineis = igraph_inclist_get(il, v1);
+        num_neis = igraph_vector_int_size(ineis);
+        for (j = 0; j < num_neis; j++) {
+            k = (long int) VECTOR(*membership)[
+                (long)IGRAPH_OTHER(graph, VECTOR(*ineis)[j], v1) ];
+            if (k == 0) {
+                continue;    /* skip if it has no label yet */
+            }
+            was_zero = (VECTOR(*label_counters)[k] == 0);
+            VECTOR(*label_counters)[k] += VECTOR(*weights)[(long)VECTOR(*ineis)[j]];
+            if (was_zero && VECTOR(*label_counters)[k] != 0) {
+                /* counter just became nonzero */
+                IGRAPH_CHECK(igraph_vector_push_back(nonzero_labels, k));
+            }
+            if (*max_count < VECTOR(*label_counters)[k]) {
+                *max_count = VECTOR(*label_counters)[k];
+                IGRAPH_CHECK(igraph_vector_resize(dominant_labels, 1));
+                VECTOR(*dominant_labels)[0] = k;
+            } else if (*max_count == VECTOR(*label_counters)[k]) {
+                IGRAPH_CHECK(igraph_vector_push_back(dominant_labels, k));
+            }
+        }
+    } else {
+        neis = igraph_adjlist_get(al, v1);
+        num_neis = igraph_vector_int_size(neis);
+        for (j = 0; j < num_neis; j++) {
+            k = (long int) VECTOR(*membership)[(long)VECTOR(*neis)[j]];
+            if (k == 0) {
+                continue;    /* skip if it has no label yet */
+            }
+            VECTOR(*label_counters)[k]++;
+            if (VECTOR(*label_counters)[k] == 1) {
+                /* counter just became nonzero */
+                IGRAPH_CHECK(igraph_vector_push_back(nonzero_labels, k));
+            }
+            if (*max_count < VECTOR(*label_counters)[k]) {
+                *max_count = VECTOR(*label_counters)[k];
+                IGRAPH_CHECK(igraph_vector_resize(dominant_labels, 1));
+                VECTOR(*dominant_labels)[0] = k;
+            } else if (*max_count == VECTOR(*label_counters)[k]) {
+                IGRAPH_CHECK(igraph_vector_push_back(dominant_labels, k));
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Clears the nonzero elements in label_counters */
+static void igraph_i_label_propagation_clear(igraph_vector_t *label_counters,
+        const igraph_vector_t *nonzero_labels) {
+    long int j, num_labels = igraph_vector_size(nonzero_labels);
+    for (j = 0; j < num_labels; j++) {
+        VECTOR(*label_counters)[(long int)VECTOR(*nonzero_labels)[j]] = 0;
+    }
+}
+
+/* Shifts back the membership vector, permutes labels in increasing
+ * order. label_counters is recycled here, it must have at least
+ * no_of_nodes elements. */
+static void igraph_i_label_propagation_relabel(igraph_vector_t *membership,
+        igraph_vector_t *label_counters) {
+    long int no_of_nodes = igraph_vector_size(membership);
+    long int i, j, k;
+
+    igraph_vector_fill(label_counters, -1);
+    j = 0;
+    for (i = 0; i < no_of_nodes; i++) {
+        k = (long)VECTOR(*membership)[i] - 1;
+        if (k >= 0) {
+            if (VECTOR(*label_counters)[k] == -1) {
+                /* We have seen this label for the first time */
+                VECTOR(*label_counters)[k] = j;
+                k = j;
+                j++;
+            } else {
+                k = (long int) VECTOR(*label_counters)[k];
+            }
+        } else {
+            /* This is an unlabeled vertex */
+        }
+        VECTOR(*membership)[i] = k;
+    }
+}
+
+/**
+ * \ingroup communities
+ * \function igraph_community_label_propagation
+ * \brief Community detection based on label propagation
+ *
+ * This function implements the community detection method described in:
+ * Raghavan, U.N. and Albert, R. and Kumara, S.: Near linear time algorithm
+ * to detect community structures in large-scale networks. Phys Rev E
+ * 76, 036106. (2007). This version extends the original method by
+ * the ability to take edge weights into consideration and also
+ * by allowing some labels to be fixed.
+ *
+ * </para><para>
+ * Weights are taken into account as follows: when the new label of node
+ * i is determined, the algorithm iterates over all edges incident on
+ * node i and calculate the total weight of edges leading to other
+ * nodes with label 0, 1, 2, ..., k-1 (where k is the number of possible
+ * labels). The new label of node i will then be the label whose edges
+ * (among the ones incident on node i) have the highest total weight.
+ *
+ * \param graph The input graph, should be undirected to make sense.
+ * \param membership The membership vector, the result is returned here.
+ *    For each vertex it gives the ID of its community (label).
+ * \param weights The weight vector, it should contain a positive
+ *    weight for all the edges.
+ * \param initial The initial state. If NULL, every vertex will have
+ *   a different label at the beginning. Otherwise it must be a vector
+ *   with an entry for each vertex. Non-negative values denote different
+ *   labels, negative entries denote vertices without labels.
+ * \param fixed Boolean vector denoting which labels are fixed. Of course
+ *   this makes sense only if you provided an initial state, otherwise
+ *   this element will be ignored. Also note that vertices without labels
+ *   cannot be fixed.
+ * \param modularity If not a null pointer, then it must be a pointer
+ *   to a real number. The modularity score of the detected community
+ *   structure is stored here.
+ * \return Error code.
+ *
+ * Time complexity: O(m+n)
+ *
+ * \example examples/simple/igraph_community_label_propagation.c
+ */
+int igraph_community_label_propagation(const igraph_t *graph,
+                                       igraph_vector_t *membership,
+                                       const igraph_vector_t *weights,
+                                       const igraph_vector_t *initial,
+                                       igraph_vector_bool_t *fixed,
+                                       igraph_real_t *modularity) {
+    long int no_of_nodes = igraph_vcount(graph);
+    long int no_of_not_fixed_nodes;
+    long int i, j, k;
+    igraph_adjlist_t al;
+    igraph_inclist_t il;
+    igraph_bool_t running = 1;
+
+    igraph_vector_t label_counters, dominant_labels, nonzero_labels, node_order;
+
+    IGRAPH_CHECK(igraph_i_label_propagation_init(graph, membership, weights,
+                 initial, fixed,
+                 &no_of_not_fixed_nodes));
+
     /* Create an adjacency/incidence list representation for efficiency.
      * For the unweighted case, the adjacency list is enough. For the
      * weighted case, we need the incidence list */
@@ -3098,11 +3542,8 @@ int igraph_community_label_propagation(const igraph_t *graph,
 
     running = 1;
     while (running) {
-        long int v1, num_neis;
+        long int v1;
         igraph_real_t max_count;
-        igraph_vector_int_t *neis;
-        igraph_vector_int_t *ineis;
-        igraph_bool_t was_zero;
 
         running = 0;
 
@@ -3112,55 +3553,12 @@ int igraph_community_label_propagation(const igraph_t *graph,
         for (i = 0; i < no_of_not_fixed_nodes; i++) {
             v1 = (long int) VECTOR(node_order)[i];
 
-            /* Count the weights corresponding to different labels */
-            igraph_vector_clear(&dominant_labels);
-            igraph_vector_clear(&nonzero_labels);
-            max_count = 0.0;
-            if (weights) {
-                ineis = igraph_inclist_get(&il, v1);
-                num_neis = igraph_vector_int_size(ineis);
-                for (j = 0; j < num_neis; j++) {
-                    k = (long int) VECTOR(*membership)[
-                    (long)IGRAPH_OTHER(graph, VECTOR(*ineis)[j], v1) ];
-                    if (k == 0) {
-                        continue;    /* skip if it has no label yet */
-                    }
-                    was_zero = (VECTOR(label_counters)[k] == 0);
-                    VECTOR(label_counters)[k] += VECTOR(*weights)[(long)VECTOR(*ineis)[j]];
-                    if (was_zero && VECTOR(label_counters)[k] != 0) {
-                        /* counter just became nonzero */
-                        IGRAPH_CHECK(igraph_vector_push_back(&nonzero_labels, k));
-                    }
-                    if (max_count < VECTOR(label_counters)[k]) {
-                        max_count = VECTOR(label_counters)[k];
-                        IGRAPH_CHECK(igraph_vector_resize(&dominant_labels, 1));
-                        VECTOR(dominant_labels)[0] = k;
-                    } else if (max_count == VECTOR(label_counters)[k]) {
-                        IGRAPH_CHECK(igraph_vector_push_back(&dominant_labels, k));
-                    }
-                }
-            } else {
-                neis = igraph_adjlist_get(&al, v1);
-                num_neis = igraph_vector_int_size(neis);
-                for (j = 0; j < num_neis; j++) {
-                    k = (long int) VECTOR(*membership)[(long)VECTOR(*neis)[j]];
-                    if (k == 0) {
-                        continue;    /* skip if it has no label yet */
-                    }
-                    VECTOR(label_counters)[k]++;
-                    if (VECTOR(label_counters)[k] == 1) {
-                        /* counter just became nonzero */
-                        IGRAPH_CHECK(igraph_vector_push_back(&nonzero_labels, k));
-                    }
-                    if (max_count < VECTOR(label_counters)[k]) {
-                        max_count = VECTOR(label_counters)[k];
-                        IGRAPH_CHECK(igraph_vector_resize(&dominant_labels, 1));
-                        VECTOR(dominant_labels)[0] = k;
-                    } else if (max_count == VECTOR(label_counters)[k]) {
-                        IGRAPH_CHECK(igraph_vector_push_back(&dominant_labels, k));
-                    }
-                }
-            }
+            IGRAPH_CHECK(igraph_i_label_propagation_count(graph, v1, membership,
+                         weights, &al, &il,
+                         &label_counters,
+                         &dominant_labels,
+                         &nonzero_labels,
+                         &max_count));
 
             if (igraph_vector_size(&dominant_labels) > 0) {
                 /* Select randomly from the dominant labels */
@@ -3174,36 +3572,13 @@ int igraph_community_label_propagation(const igraph_t *graph,
                 VECTOR(*membership)[v1] = k;
             }
 
-            /* Clear the nonzero elements in label_counters */
-            num_neis = igraph_vector_size(&nonzero_labels);
-            for (j = 0; j < num_neis; j++) {
-                VECTOR(label_counters)[(long int)VECTOR(nonzero_labels)[j]] = 0;
-            }
+            igraph_i_label_propagation_clear(&label_counters, &nonzero_labels);
         }
     }
 
     RNG_END();
 
-    /* Shift back the membership vector, permute labels in increasing order */
-    /* We recycle label_counters here :) */
-    igraph_vector_fill(&label_counters, -1);
-    j = 0;
-    for (i = 0; i < no_of_nodes; i++) {
-        k = (long)VECTOR(*membership)[i] - 1;
-        if (k >= 0) {
-            if (VECTOR(label_counters)[k] == -1) {
-                /* We have seen this label for the first time */
-                VECTOR(label_counters)[k] = j;
-                k = j;
-                j++;
-            } else {
-                k = (long int) VECTOR(label_counters)[k];
-            }
-        } else {
-            /* This is an unlabeled vertex */
-        }
-        VECTOR(*membership)[i] = k;
-    }
+    igraph_i_label_propagation_relabel(membership, &label_counters);
 
     if (weights) {
         igraph_inclist_destroy(&il);
@@ -3226,6 +3601,199 @@ int igraph_community_label_propagation(const igraph_t *graph,
     return 0;
 }
 
+/**
+ * \ingroup communities
+ * \function igraph_community_label_propagation_semisync
+ * \brief Semi-synchronous label propagation
+ *
+ * This function is a variant of \ref igraph_community_label_propagation()
+ * that updates the labels semi-synchronously, as described in:
+ * G. Cordasco and L. Gargano: Community detection via semi-synchronous
+ * label propagation algorithms. IEEE BASNA (2010).
+ *
+ * </para><para>
+ * The vertices are partitioned into independent sets with a greedy
+ * vertex coloring, see \ref igraph_vertex_coloring_greedy(). The color
+ * classes are updated one after the other. No two vertices of a class
+ * are adjacent, so their new labels do not depend on each other and a
+ * class may be updated in parallel. A vertex keeps its current label
+ * whenever it is among the dominant ones, otherwise it takes one of the
+ * dominant labels at random. With this rule the process is guaranteed
+ * to converge on undirected graphs, unlike the synchronous update which
+ * may oscillate. Directed graphs are not supported, as labels may keep
+ * circulating along directed cycles.
+ *
+ * </para><para>
+ * Only vertices with a neighbor whose label changed since their last
+ * update are visited again, so converged regions of the graph are not
+ * rescanned. The algorithm stops when no such vertices remain.
+ *
+ * \param graph The input graph, it must be undirected.
+ * \param membership The membership vector, the result is returned here.
+ *    For each vertex it gives the ID of its community (label).
+ * \param weights The weight vector, it should contain a positive
+ *    weight for all the edges.
+ * \param initial The initial state. If NULL, every vertex will have
+ *   a different label at the beginning. Otherwise it must be a vector
+ *   with an entry for each vertex. Non-negative values denote different
+ *   labels, negative entries denote vertices without labels.
+ * \param fixed Boolean vector denoting which labels are fixed, see
+ *   \ref igraph_community_label_propagation().
+ * \param modularity If not a null pointer, then it must be a pointer
+ *   to a real number. The modularity score of the detected community
+ *   structure is stored here.
+ * \return Error code.
+ *
+ * Time complexity: O((n+m) log n) for the coloring, plus O(m) for
+ * every round of updates.
+ */
+int igraph_community_label_propagation_semisync(const igraph_t *graph,
+        igraph_vector_t *membership,
+        const igraph_vector_t *weights,
+        const igraph_vector_t *initial,
+        igraph_vector_bool_t *fixed,
+        igraph_real_t *modularity) {
+    long int no_of_nodes = igraph_vcount(graph);
+    long int no_of_not_fixed_nodes, no_of_colors, no_of_active;
+    long int i, j, k, c, v1, num_neis;
+    igraph_adjlist_t al;
+    igraph_inclist_t il;
+    igraph_vector_int_t colors, *neis;
+    igraph_vector_long_t class_start;
+    igraph_vector_bool_t active;
+    igraph_vector_t label_counters, dominant_labels, nonzero_labels, node_order;
+    igraph_real_t max_count;
+
+    if (igraph_is_directed(graph)) {
+        IGRAPH_ERROR("Semi-synchronous label propagation works on undirected graphs",
+                     IGRAPH_EINVAL);
+    }
+
+    IGRAPH_CHECK(igraph_i_label_propagation_init(graph, membership, weights,
+                 initial, fixed,
+                 &no_of_not_fixed_nodes));
+
+    if (weights) {
+        IGRAPH_CHECK(igraph_inclist_init(graph, &il, IGRAPH_ALL));
+        IGRAPH_FINALLY(igraph_inclist_destroy, &il);
+    } else {
+        IGRAPH_CHECK(igraph_adjlist_init(graph, &al, IGRAPH_ALL));
+        IGRAPH_FINALLY(igraph_adjlist_destroy, &al);
+    }
+
+    IGRAPH_VECTOR_INIT_FINALLY(&label_counters, no_of_nodes + 1);
+    IGRAPH_VECTOR_INIT_FINALLY(&dominant_labels, 0);
+    IGRAPH_VECTOR_INIT_FINALLY(&nonzero_labels, 0);
+    IGRAPH_CHECK(igraph_vector_reserve(&dominant_labels, 2));
+
+    /* Order the not fixed vertices by color class */
+    IGRAPH_CHECK(igraph_vector_int_init(&colors, 0));
+    IGRAPH_FINALLY(igraph_vector_int_destroy, &colors);
+    IGRAPH_CHECK(igraph_vertex_coloring_greedy(graph, &colors,
+                 IGRAPH_COLORING_GREEDY_COLORED_NEIGHBORS));
+    no_of_colors = no_of_nodes > 0 ? igraph_vector_int_max(&colors) + 1 : 0;
+
+    IGRAPH_CHECK(igraph_vector_long_init(&class_start, no_of_colors + 1));
+    IGRAPH_FINALLY(igraph_vector_long_destroy, &class_start);
+    IGRAPH_VECTOR_INIT_FINALLY(&node_order, no_of_not_fixed_nodes);
+    IGRAPH_CHECK(igraph_vector_bool_init(&active, no_of_nodes));
+    IGRAPH_FINALLY(igraph_vector_bool_destroy, &active);
+
+    for (i = 0; i < no_of_nodes; i++) {
+        if (!fixed || !VECTOR(*fixed)[i]) {
+            VECTOR(class_start)[VECTOR(colors)[i] + 1] += 1;
+            VECTOR(active)[i] = 1;
+        }
+    }
+    for (c = 0; c < no_of_colors; c++) {
+        VECTOR(class_start)[c + 1] += VECTOR(class_start)[c];
+    }
+    for (i = 0; i < no_of_nodes; i++) {
+        if (VECTOR(active)[i]) {
+            VECTOR(node_order)[ VECTOR(class_start)[VECTOR(colors)[i]]++ ] = i;
+        }
+    }
+    for (c = no_of_colors; c > 0; c--) {
+        VECTOR(class_start)[c] = VECTOR(class_start)[c - 1];
+    }
+    VECTOR(class_start)[0] = 0;
+    no_of_active = no_of_not_fixed_nodes;
+
+    RNG_BEGIN();
+
+    while (no_of_active > 0) {
+        for (c = 0; c < no_of_colors; c++) {
+            for (i = VECTOR(class_start)[c]; i < VECTOR(class_start)[c + 1]; i++) {
+                v1 = (long int) VECTOR(node_order)[i];
+                if (!VECTOR(active)[v1]) {
+                    continue;
+                }
+                VECTOR(active)[v1] = 0;
+                no_of_active--;
+
+                IGRAPH_CHECK(igraph_i_label_propagation_count(graph, v1, membership,
+                             weights, &al, &il,
+                             &label_counters,
+                             &dominant_labels,
+                             &nonzero_labels,
+                             &max_count));
+
+                /* Keep the current label if it is dominant */
+                if (igraph_vector_size(&dominant_labels) > 0 &&
+                    VECTOR(label_counters)[(long)VECTOR(*membership)[v1]] != max_count) {
+                    k = RNG_INTEGER(0, igraph_vector_size(&dominant_labels) - 1);
+                    VECTOR(*membership)[v1] = VECTOR(dominant_labels)[k];
+
+                    /* The neighbors have to be updated again */
+                    neis = weights ? igraph_inclist_get(&il, v1) : igraph_adjlist_get(&al, v1);
+                    num_neis = igraph_vector_int_size(neis);
+                    for (j = 0; j < num_neis; j++) {
+                        k = (long int) VECTOR(*neis)[j];
+                        if (weights) {
+                            k = IGRAPH_OTHER(graph, k, v1);
+                        }
+                        if (!VECTOR(active)[k] && (!fixed || !VECTOR(*fixed)[k])) {
+                            VECTOR(active)[k] = 1;
+                            no_of_active++;
+                        }
+                    }
+                }
+
+                igraph_i_label_propagation_clear(&label_counters, &nonzero_labels);
+            }
+        }
+
+        IGRAPH_ALLOW_INTERRUPTION();
+    }
+
+    RNG_END();
+
+    igraph_i_label_propagation_relabel(membership, &label_counters);
+
+    igraph_vector_bool_destroy(&active);
+    igraph_vector_destroy(&node_order);
+    igraph_vector_long_destroy(&class_start);
+    igraph_vector_int_destroy(&colors);
+    igraph_vector_destroy(&label_counters);
+    igraph_vector_destroy(&dominant_labels);
+    igraph_vector_destroy(&nonzero_labels);
+    IGRAPH_FINALLY_CLEAN(7);
+
+    if (weights) {
+        igraph_inclist_destroy(&il);
+    } else {
+        igraph_adjlist_destroy(&al);
+    }
+    IGRAPH_FINALLY_CLEAN(1);
+
+    if (modularity) {
+        IGRAPH_CHECK(igraph_modularity(graph, membership, modularity,
+                                       weights));
+    }
+
+    return 0;
+}
+
 /********************************************************************/
 
 /* Structure storing a community */
@@ -3240,6 +3808,7 @@ typedef struct {
 typedef struct {
     long int communities_no, vertices_no;  /* Number of communities, number of vertices */
     igraph_real_t weight_sum;              /* Sum of edges weight in the whole graph */
+    igraph_real_t resolution;              /* Weight of the null model term */
     igraph_i_multilevel_community *item;   /* List of communities */
     igraph_vector_t *membership;           /* Community IDs */
     igraph_vector_t *weights;        /* Graph edge weights */
@@ -3254,7 +3823,7 @@ igraph_real_t igraph_i_multilevel_community_modularity(
 
     for (i = 0; i < communities->vertices_no; i++) {
         if (communities->item[i].size > 0) {
-            result += (communities->item[i].weight_inside - communities->item[i].weight_all * communities->item[i].weight_all / m) / m;
+            result += (communities->item[i].weight_inside - communities->resolution * communities->item[i].weight_all * communities->item[i].weight_all / m) / m;
         }
     }
 
@@ -3294,7 +3863,7 @@ int igraph_i_multilevel_simplify_multiple(igraph_t *graph, igraph_vector_t *eids
     if (links == 0) {
         IGRAPH_ERROR("multi-level community structure detection failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, links);
+    IGRAPH_FINALLY(igraph_free, links);
 
     for (i = 0; i < ecount; i++) {
         igraph_edge(graph, (igraph_integer_t) i, &from, &to);
@@ -3324,7 +3893,7 @@ int igraph_i_multilevel_simplify_multiple(igraph_t *graph, igraph_vector_t *eids
         VECTOR(*eids)[links[i].id] = l;
     }
 
-    free(links);
+    igraph_Free(links);
     IGRAPH_FINALLY_CLEAN(1);
 
     igraph_destroy(graph);
@@ -3438,7 +4007,7 @@ igraph_real_t igraph_i_multilevel_community_modularity_gain(
     igraph_integer_t community, igraph_integer_t vertex,
     igraph_real_t weight_all, igraph_real_t weight_inside) {
     IGRAPH_UNUSED(vertex);
-    return weight_inside -
+    return weight_inside - communities->resolution *
            communities->item[(long int)community].weight_all * weight_all / communities->weight_sum;
 }
 
@@ -3511,6 +4080,8 @@ int igraph_i_multilevel_shrink(igraph_t *graph, igraph_vector_t *membership) {
  * \param graph   The input graph. It must be an undirected graph.
  * \param weights Numeric vector containing edge weights. If \c NULL, every edge
  *     has equal weight. The weights are expected to be non-negative.
+ * \param resolution The weight of the null model term of the modularity,
+ *     see \ref igraph_community_multilevel_resolution().
  * \param membership The membership vector, the result is returned here.
  *     For each vertex it gives the ID of its community.
  * \param modularity The modularity of the partition is returned here.
@@ -3520,7 +4091,8 @@ int igraph_i_multilevel_shrink(igraph_t *graph, igraph_vector_t *membership) {
  * Time complexity: in average near linear on sparse graphs.
  */
 int igraph_i_community_multilevel_step(igraph_t *graph,
-                                       igraph_vector_t *weights, igraph_vector_t *membership,
+                                       igraph_vector_t *weights, igraph_real_t resolution,
+                                       igraph_vector_t *membership,
                                        igraph_real_t *modularity) {
 
     long int i, j;
@@ -3560,6 +4132,7 @@ int igraph_i_community_multilevel_step(igraph_t *graph,
     communities.communities_no = vcount;
     communities.weights = weights;
     communities.weight_sum = 2 * igraph_vector_sum(weights);
+    communities.resolution = resolution;
     communities.membership = membership;
     communities.item = igraph_Calloc(vcount, igraph_i_multilevel_community);
     if (communities.item == 0) {
@@ -3767,6 +4340,42 @@ int igraph_i_community_multilevel_step(igraph_t *graph,
 int igraph_community_multilevel(const igraph_t *graph,
                                 const igraph_vector_t *weights, igraph_vector_t *membership,
                                 igraph_matrix_t *memberships, igraph_vector_t *modularity) {
+    return igraph_community_multilevel_resolution(graph, weights, 1, membership,
+            memberships, modularity);
+}
+
+/**
+ * \ingroup communities
+ * \function igraph_community_multilevel_resolution
+ * \brief Multi-level optimization of modularity with a resolution parameter
+ *
+ * This function is \ref igraph_community_multilevel() optimizing the
+ * generalized modularity
+ * Q = 1/(2m) sum_ij (A_ij - gamma k_i k_j / (2m)) delta(c_i, c_j),
+ * where gamma is the resolution. The modularity of one component of a
+ * graph with resolution m_c/m, where m_c is the weight of the edges of
+ * the component, is its contribution to the modularity of the whole
+ * graph, scaled by m/m_c.
+ *
+ * \param graph The input graph. It must be an undirected graph.
+ * \param weights Numeric vector containing edge weights. If \c NULL, every edge
+ *    has equal weight. The weights are expected to be non-negative.
+ * \param resolution The resolution gamma, non-negative; 1 gives the
+ *    modularity.
+ * \param membership The membership vector, see \ref igraph_community_multilevel().
+ * \param memberships The membership vectors of the levels, see
+ *    \ref igraph_community_multilevel().
+ * \param modularity Numeric vector that will contain the generalized
+ *    modularity after each level, if not \c NULL.
+ * \return Error code.
+ *
+ * Time complexity: in average near linear on sparse graphs.
+ */
+
+int igraph_community_multilevel_resolution(const igraph_t *graph,
+        const igraph_vector_t *weights, igraph_real_t resolution,
+        igraph_vector_t *membership, igraph_matrix_t *memberships,
+        igraph_vector_t *modularity) {
 
     igraph_t g;
     igraph_vector_t w, m, level_membership;
@@ -3774,6 +4383,10 @@ int igraph_community_multilevel(const igraph_t *graph,
     int i, level = 1;
     long int vcount = igraph_vcount(graph);
 
+    if (resolution < 0) {
+        IGRAPH_ERROR("The resolution must be non-negative", IGRAPH_EINVAL);
+    }
+
     /* Make a copy of the original graph, we will do the merges on the copy */
     IGRAPH_CHECK(igraph_copy(&g, graph));
     IGRAPH_FINALLY(igraph_destroy, &g);
@@ -3809,7 +4422,7 @@ int igraph_community_multilevel(const igraph_t *graph,
         igraph_integer_t step_vcount = igraph_vcount(&g);
 
         prev_q = q;
-        IGRAPH_CHECK(igraph_i_community_multilevel_step(&g, &w, &m, &q));
+        IGRAPH_CHECK(igraph_i_community_multilevel_step(&g, &w, resolution, &m, &q));
 
         /* Were there any merges? If not, we have to stop the process */
         if (igraph_vcount(&g) == step_vcount || q < prev_q) {
@@ -3849,10 +4462,30 @@ int igraph_community_multilevel(const igraph_t *graph,
         igraph_real_t mod;
         int i;
         IGRAPH_VECTOR_INIT_FINALLY(&tmp, vcount);
-        for (i = 0; i < vcount; i++) {
-            VECTOR(tmp)[i] = i;
+        if (resolution == 1) {
+            for (i = 0; i < vcount; i++) {
+                VECTOR(tmp)[i] = i;
+            }
+            IGRAPH_CHECK(igraph_modularity(graph, &tmp, &mod, weights));
+        } else {
+            /* Every vertex alone: its loops against its null model term */
+            igraph_real_t m2 = 0, loops = 0, squares = 0;
+            long int e, ecount = igraph_ecount(graph);
+
+            IGRAPH_CHECK(igraph_strength(graph, &tmp, igraph_vss_all(), IGRAPH_ALL,
+                                         IGRAPH_LOOPS, weights));
+            for (e = 0; e < ecount; e++) {
+                igraph_real_t weight = weights ? VECTOR(*weights)[e] : 1;
+                m2 += 2 * weight;
+                if (IGRAPH_FROM(graph, e) == IGRAPH_TO(graph, e)) {
+                    loops += 2 * weight;
+                }
+            }
+            for (i = 0; i < vcount; i++) {
+                squares += VECTOR(tmp)[i] * VECTOR(tmp)[i];
+            }
+            mod = m2 > 0 ? (loops - resolution * squares / m2) / m2 : IGRAPH_NAN;
         }
-        IGRAPH_CHECK(igraph_modularity(graph, &tmp, &mod, weights));
         igraph_vector_destroy(&tmp);
         IGRAPH_FINALLY_CLEAN(1);
         IGRAPH_CHECK(igraph_vector_resize(modularity, 1));
@@ -3934,6 +4567,7 @@ int igraph_i_community_multilevel_step_seed(igraph_t *graph,
     communities.communities_no = vcount;
     communities.weights = weights;
     communities.weight_sum = 2 * igraph_vector_sum(weights);
+    communities.resolution = 1;
     communities.membership = membership;
     communities.item = igraph_Calloc(vcount, igraph_i_multilevel_community);
     if (communities.item == 0) {
@@ -4522,12 +5156,12 @@ int igraph_i_entropy_and_mutual_information(const igraph_vector_t* v1,
     if (p1 == 0) {
         IGRAPH_ERROR("igraph_i_entropy_and_mutual_information failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, p1);
+    IGRAPH_FINALLY(igraph_free, p1);
     p2 = igraph_Calloc(k2, double);
     if (p2 == 0) {
         IGRAPH_ERROR("igraph_i_entropy_and_mutual_information failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, p2);
+    IGRAPH_FINALLY(igraph_free, p2);
 
     /* Calculate the entropy of v1 */
     *h1 = 0.0;
@@ -4575,7 +5209,7 @@ int igraph_i_entropy_and_mutual_information(const igraph_vector_t* v1,
 
     igraph_spmatrix_iter_destroy(&mit);
     igraph_spmatrix_destroy(&m);
-    free(p1); free(p2);
+    igraph_Free(p1); igraph_Free(p2);
 
     IGRAPH_FINALLY_CLEAN(4);
 
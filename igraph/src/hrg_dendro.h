@@ -307,6 +307,8 @@ public:
     void resetDendrograph();
     // sample dendrogram's splits and update the split histogram
     bool sampleSplitLikelihoods(int&);
+    // same, updating the split histogram of another dendrogram of the graph
+    bool sampleSplitLikelihoods(dendro *hist);
     // reset splits histogram
     void resetAllSplits();
 };
@@ -121,7 +121,7 @@ int markovChainMonteCarlo(dendro *d, unsigned int period,
     return 0;
 }
 
-int markovChainMonteCarlo2(dendro *d, int num_samples) {
+int markovChainMonteCarlo2(dendro *d, int num_samples, dendro *hist) {
     bool flag_taken;
     double dL, ptest = 1.0 / (50.0 * (double)(d->g->numNodes()));
     int sample_num = 0, t = 1, thresh = 200 * d->g->numNodes();
@@ -138,13 +138,16 @@ int markovChainMonteCarlo2(dendro *d, int num_samples) {
         // different aspects of the dendrograph structure.
         if (t > thresh && RNG_UNIF01() < ptest) {
             sample_num++;
-            d->sampleSplitLikelihoods(sample_num);
+            d->sampleSplitLikelihoods(hist);
         }
 
         t++;
 
-        // correct floating-point errors O(n)
-        d->refreshLikelihood(); // TODO: less frequently
+        // correct floating-point errors O(n); the moves do not depend on
+        // the likelihood, so once every n moves keeps it O(1) per move
+        if (t % d->g->numNodes() == 0) {
+            d->refreshLikelihood();
+        }
     }
 
     return 0;
@@ -682,7 +685,7 @@ int igraph_hrg_consensus(const igraph_t *graph,
         IGRAPH_CHECK(MCMCEquilibrium_Find(d, hrg));
     }
 
-    IGRAPH_CHECK(markovChainMonteCarlo2(d, num_samples));
+    IGRAPH_CHECK(markovChainMonteCarlo2(d, num_samples, d));
 
     d->recordConsensusTree(parents, weights);
 
@@ -693,6 +696,170 @@ int igraph_hrg_consensus(const igraph_t *graph,
     return 0;
 }
 
+static void igraph_i_hrg_delete_chains(dendro *chains) {
+    delete [] chains;
+}
+
+/**
+ * \function igraph_hrg_fit_chains
+ * Fit a HRG with several Markov chains and calculate their consensus tree
+ *
+ * Runs \c no_of_chains Markov chains, each from its own random
+ * dendrogram. The chains take turns of \c exchange_period MCMC moves;
+ * after every turn the chain with the lowest likelihood continues from
+ * the current dendrogram of the chain with the highest one. Then every
+ * chain samples its part of the dendrograms at equilibrium into a
+ * common split histogram, which gives the consensus tree, as in \ref
+ * igraph_hrg_consensus.
+ *
+ * \param graph The input graph, it must have at least three
+ *   vertices. Edge directions are ignored.
+ * \param hrg Pointer to an initialized HRG, the dendrogram of the
+ *   highest likelihood found by any of the chains is stored here.
+ * \param parents An initialized vector or a null pointer. The
+ *   consensus tree is stored here, in the same format as in \ref
+ *   igraph_hrg_consensus. If a null pointer, no dendrograms are
+ *   sampled.
+ * \param weights Numeric vector or a null pointer, the weights of the
+ *   internal vertices of the consensus tree.
+ * \param no_of_chains The number of Markov chains, at least one.
+ * \param steps The number of MCMC moves of every chain in the
+ *   fitting. If this is zero, the chains move until the best
+ *   log-likelihood found by any of them improves by less than one
+ *   over 65536 moves of every chain.
+ * \param exchange_period The number of MCMC moves of a chain in one
+ *   turn.
+ * \param num_samples The number of dendrograms sampled for the
+ *   consensus tree, shared among the chains.
+ * \param loglikelihood Pointer to a real or a null pointer, the
+ *   log-likelihood of \c hrg is stored here.
+ * \return Error code.
+ *
+ * Time complexity: TODO.
+ */
+
+int igraph_hrg_fit_chains(const igraph_t *graph,
+                          igraph_hrg_t *hrg,
+                          igraph_vector_t *parents,
+                          igraph_vector_t *weights,
+                          int no_of_chains,
+                          int steps,
+                          int exchange_period,
+                          int num_samples,
+                          igraph_real_t *loglikelihood) {
+
+    int no_of_nodes = igraph_vcount(graph);
+    dendro *chains;
+    igraph_hrg_t best;
+    igraph_real_t bestL, dL, cl;
+    igraph_real_t windowL;
+    bool flag_taken;
+    int c, i, window = 0, done = 0;
+
+    if (no_of_nodes < 3) {
+        IGRAPH_ERROR("HRG needs at least three vertices", IGRAPH_EINVAL);
+    }
+    if (no_of_chains < 1) {
+        IGRAPH_ERROR("Number of chains must be positive", IGRAPH_EINVAL);
+    }
+    if (steps < 0 || exchange_period < 1) {
+        IGRAPH_ERROR("Number of steps must be non-negative and the exchange "
+                     "period positive", IGRAPH_EINVAL);
+    }
+    if (parents && num_samples < 1) {
+        IGRAPH_ERROR("Number of samples must be positive", IGRAPH_EINVAL);
+    }
+
+    IGRAPH_CHECK(igraph_hrg_resize(hrg, no_of_nodes));
+    IGRAPH_CHECK(igraph_hrg_init(&best, no_of_nodes));
+    IGRAPH_FINALLY(igraph_hrg_destroy, &best);
+
+    RNG_BEGIN();
+
+    chains = new dendro[no_of_chains];
+    IGRAPH_FINALLY(igraph_i_hrg_delete_chains, chains);
+
+    for (c = 0; c < no_of_chains; c++) {
+        IGRAPH_CHECK(igraph_i_hrg_getgraph(graph, &chains[c]));
+        if (c == 0 || chains[c].getLikelihood() > bestL) {
+            bestL = chains[c].getLikelihood();
+            chains[c].recordDendrogramStructure(hrg);
+        }
+    }
+
+    windowL = bestL;
+
+    // Fitting: turns of the chains, the worst one continues from the best one
+    while (!done) {
+        int bestc = 0, worstc = 0;
+
+        for (c = 0; c < no_of_chains; c++) {
+            for (i = 0; i < exchange_period; i++) {
+                IGRAPH_CHECK(! chains[c].monteCarloMove(dL, flag_taken, 1.0));
+                cl = chains[c].getLikelihood();
+                if (cl > bestL) {
+                    bestL = cl;
+                    chains[c].recordDendrogramStructure(hrg);
+                }
+            }
+            // corrects floating-point errors O(n)
+            chains[c].refreshLikelihood();
+
+            if (chains[c].getLikelihood() > chains[bestc].getLikelihood()) {
+                bestc = c;
+            }
+            if (chains[c].getLikelihood() < chains[worstc].getLikelihood()) {
+                worstc = c;
+            }
+        }
+        window += exchange_period;
+
+        if (steps > 0) {
+            steps -= exchange_period;
+            done = steps <= 0;
+        } else if (window >= 65536) {
+            // Converged when the best log-likelihood of the chains
+            // improves by less than one in 65536 moves of every chain,
+            // however many turns they take
+            done = bestL - windowL < 1.0;
+            windowL = bestL;
+            window = 0;
+        }
+
+        if (!done && bestc != worstc) {
+            chains[bestc].recordDendrogramStructure(&best);
+            chains[worstc].resetDendrograph();
+            chains[worstc].importDendrogramStructure(&best);
+        }
+    }
+
+    // Consensus: every chain samples into the split histogram of the first one
+    if (parents) {
+        for (c = 0; c < no_of_chains; c++) {
+            int chain_samples = num_samples / no_of_chains +
+                                (c < num_samples % no_of_chains ? 1 : 0);
+            if (chain_samples > 0) {
+                IGRAPH_CHECK(markovChainMonteCarlo2(&chains[c], chain_samples, &chains[0]));
+            }
+        }
+        chains[0].recordConsensusTree(parents, weights);
+    }
+
+    delete [] chains;
+    IGRAPH_FINALLY_CLEAN(1);
+
+    RNG_END();
+
+    if (loglikelihood) {
+        *loglikelihood = bestL;
+    }
+
+    igraph_hrg_destroy(&best);
+    IGRAPH_FINALLY_CLEAN(1);
+
+    return 0;
+}
+
 int MCMCEquilibrium_Sample(dendro *d, int num_samples) {
 
     // Because moves in the dendrogram space are chosen (Monte
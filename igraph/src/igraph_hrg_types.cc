@@ -2173,15 +2173,19 @@ list* dendro::reversePathToRoot(const int leafIndex) {
 // ***********************************************************************
 
 bool dendro::sampleSplitLikelihoods(int &sample_num) {
+    IGRAPH_UNUSED(sample_num);
+    return sampleSplitLikelihoods(this);
+}
+
+bool dendro::sampleSplitLikelihoods(dendro *hist) {
     // In order to compute the majority agreement dendrogram at
     // equilibrium, we need to calculate the leaf partition defined by
     // each split (internal edge) of the tree. Because splits are only
     // defined on a Cayley tree, the buildSplit() function returns the
     // default "--...--"  string for the root and the root's left
     // child. When tabulating the frequency of splits, one of these
-    // needs to be excluded.
-
-    IGRAPH_UNUSED(sample_num);
+    // needs to be excluded. The splits are added to the histogram of
+    // hist, which may be another dendrogram of the same graph.
 
     string* array;
     int     k;
@@ -2195,19 +2199,19 @@ bool dendro::sampleSplitLikelihoods(int &sample_num) {
     // is had, we insert them into the split histogram, which tracks the
     // cumulative weight for each respective split observed.
 
-    if (splithist == NULL) {
-        splithist = new splittree;
+    if (hist->splithist == NULL) {
+        hist->splithist = new splittree;
     }
     for (int i = 0; i < (n - 1); i++) {
         new_split = buildSplit(&internal[i]);
         d->replaceSplit(i, new_split);
         if (!new_split.empty() && new_split[1] != '-') {
-            if (!splithist->insertItem(new_split, 1.0)) {
+            if (!hist->splithist->insertItem(new_split, 1.0)) {
                 return false;
             }
         }
     }
-    splithist->finishedThisRound();
+    hist->splithist->finishedThisRound();
 
     // For large graphs, the split histogram can get extremely large, so
     // we need to employ some measures to prevent it from swamping the
@@ -2220,15 +2224,15 @@ bool dendro::sampleSplitLikelihoods(int &sample_num) {
 
     int split_max = n * 500;
     int leng;
-    if (splithist->returnNodecount() > split_max) {
+    if (hist->splithist->returnNodecount() > split_max) {
         k = 1;
-        while (splithist->returnNodecount() > split_max) {
-            array = splithist->returnArrayOfKeys();
-            tot   = splithist->returnTotal();
-            leng  = splithist->returnNodecount();
+        while (hist->splithist->returnNodecount() > split_max) {
+            array = hist->splithist->returnArrayOfKeys();
+            tot   = hist->splithist->returnTotal();
+            leng  = hist->splithist->returnNodecount();
             for (int i = 0; i < leng; i++) {
-                if ((splithist->returnValue(array[i]) / tot) < k * 0.001) {
-                    splithist->deleteItem(array[i]);
+                if ((hist->splithist->returnValue(array[i]) / tot) < k * 0.001) {
+                    hist->splithist->deleteItem(array[i]);
                 }
             }
             delete [] array; array = NULL;
@@ -0,0 +1,155 @@
+/* -*- mode: C -*-  */
+/*
+   IGraph library.
+   Copyright (C) 2020  The igraph development team
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc.,  51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301 USA
+
+*/
+
+#ifndef IGRAPH_SIMD_INTERNAL_H
+#define IGRAPH_SIMD_INTERNAL_H
+
+#include <string.h>
+
+/*
+ * Numeric kernels of the hot loops of modularity, Walktrap and Infomap.
+ *
+ * When IGRAPH_SIMD is defined they are written with 128-bit GCC/Clang
+ * vector types, which emcc compiles to WebAssembly SIMD instructions
+ * with -msimd128 and other compilers to SSE/NEON. Otherwise they are
+ * the plain loops the callers used before. The vector reductions add
+ * the terms in a different order, so their result may differ from the
+ * scalar one in the last bits.
+ */
+
+#ifdef IGRAPH_SIMD
+typedef double igraph_i_f64x2 __attribute__((vector_size(16)));
+typedef float igraph_i_f32x4 __attribute__((vector_size(16)));
+
+/* Unaligned loads and stores, memcpy compiles to a single instruction */
+static inline igraph_i_f64x2 igraph_i_load_f64x2(const double *p) {
+    igraph_i_f64x2 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void igraph_i_store_f64x2(double *p, igraph_i_f64x2 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline igraph_i_f32x4 igraph_i_load_f32x4(const float *p) {
+    igraph_i_f32x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Adds the four float lanes to two double accumulators */
+static inline void igraph_i_add_f32x4(igraph_i_f64x2 *acc, igraph_i_f32x4 v) {
+    acc[0] += (igraph_i_f64x2) { v[0], v[1] };
+    acc[1] += (igraph_i_f64x2) { v[2], v[3] };
+}
+#endif
+
+/*
+ * Sum of e[i] / 2 / m - (a[i] / 2 / m)^2 over the communities, the last
+ * step of igraph_modularity().
+ */
+static inline double igraph_i_modularity_sum(const double *e, const double *a,
+                                             long int n, double m) {
+    double result = 0.0;
+    long int i = 0;
+
+#ifdef IGRAPH_SIMD
+    igraph_i_f64x2 acc = { 0.0, 0.0 };
+    for (; i + 2 <= n; i += 2) {
+        igraph_i_f64x2 tmp = igraph_i_load_f64x2(a + i) / 2 / m;
+        acc += igraph_i_load_f64x2(e + i) / 2 / m;
+        acc -= tmp * tmp;
+    }
+    result = acc[0] + acc[1];
+#endif
+
+    for (; i < n; i++) {
+        double tmp = a[i] / 2 / m;
+        result += e[i] / 2 / m;
+        result -= tmp * tmp;
+    }
+
+    return result;
+}
+
+/*
+ * Adds the squared Euclidean distance of two float vectors of length n,
+ * or the squared norm of x when y is null, to r; used by Walktrap's
+ * distances. The scalar variant adds the terms to r one by one.
+ */
+static inline double igraph_i_add_squared_distance_float(double r, const float *x,
+                                                         const float *y, long int n) {
+    long int i = 0;
+
+#ifdef IGRAPH_SIMD
+    igraph_i_f64x2 acc[2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+    for (; i + 4 <= n; i += 4) {
+        igraph_i_f32x4 d = igraph_i_load_f32x4(x + i);
+        if (y) {
+            d -= igraph_i_load_f32x4(y + i);
+        }
+        igraph_i_add_f32x4(acc, d * d);
+    }
+    acc[0] += acc[1];
+    r += acc[0][0] + acc[0][1];
+#endif
+
+    if (y) {
+        for (; i < n; i++) {
+            r += (x[i] - y[i]) * (x[i] - y[i]);
+        }
+    } else {
+        for (; i < n; i++) {
+            r += x[i] * x[i];
+        }
+    }
+
+    return r;
+}
+
+/*
+ * mod_exit[i] += (alpha * size[i] + beta * dangling[i]) * (1 - teleport[i]),
+ * the teleportation part of Infomap's module exit flows. This is
+ * element-wise, so both variants give identical results.
+ */
+static inline void igraph_i_add_teleport_flow(double *mod_exit, const double *size,
+                                              const double *dangling,
+                                              const double *teleport,
+                                              long int n, double alpha, double beta) {
+    long int i = 0;
+
+#ifdef IGRAPH_SIMD
+    for (; i + 2 <= n; i += 2) {
+        igraph_i_f64x2 flow = (alpha * igraph_i_load_f64x2(size + i) +
+                               beta * igraph_i_load_f64x2(dangling + i)) *
+                              (1.0 - igraph_i_load_f64x2(teleport + i));
+        igraph_i_store_f64x2(mod_exit + i, igraph_i_load_f64x2(mod_exit + i) + flow);
+    }
+#endif
+
+    for (; i < n; i++) {
+        mod_exit[i] += (alpha * size[i] + beta * dangling[i]) * (1.0 - teleport[i]);
+    }
+}
+
+#endif
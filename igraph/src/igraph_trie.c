@@ -210,7 +210,7 @@ int igraph_trie_get_node(igraph_trie_node_t *t, const char *key,
                 IGRAPH_ERROR("cannot add to trie", IGRAPH_ENOMEM);
             }
             str2[diff] = '\0';
-            IGRAPH_FINALLY(free, str2);
+            IGRAPH_FINALLY(igraph_free, str2);
             IGRAPH_CHECK(igraph_strvector_set(&t->strs, i, str2));
             free(str2);
             IGRAPH_FINALLY_CLEAN(4);
@@ -246,7 +246,7 @@ int igraph_trie_get_node(igraph_trie_node_t *t, const char *key,
                 IGRAPH_ERROR("cannot add to trie", IGRAPH_ENOMEM);
             }
             str2[diff] = '\0';
-            IGRAPH_FINALLY(free, str2);
+            IGRAPH_FINALLY(igraph_free, str2);
             IGRAPH_CHECK(igraph_strvector_set(&t->strs, i, str2));
             free(str2);
             IGRAPH_FINALLY_CLEAN(4);
@@ -345,7 +345,7 @@ int igraph_trie_get2(igraph_trie_t *t, const char *key, long int length,
 
     strncpy(tmp, key, length);
     tmp[length] = '\0';
-    IGRAPH_FINALLY(free, tmp);
+    IGRAPH_FINALLY(igraph_free, tmp);
     IGRAPH_CHECK(igraph_trie_get(t, tmp, id));
     igraph_Free(tmp);
     IGRAPH_FINALLY_CLEAN(1);
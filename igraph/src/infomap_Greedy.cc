@@ -23,6 +23,7 @@
 */
 
 #include "infomap_Greedy.h"
+#include "igraph_simd_internal.h"
 #include <iterator>
 #define plogp( x ) ( (x) > 0.0 ? (x)*log(x) : 0.0 )
 
@@ -497,10 +498,8 @@ void Greedy::tune(void) {
     }
 
     // Update contribution from teleportation
-    for (int i = 0; i < Nnode; i++) {
-        mod_exit[i] += (alpha * mod_size[i] + beta * mod_danglingSize[i]) *
-                       (1.0 - mod_teleportWeight[i]);
-    }
+    igraph_i_add_teleport_flow(mod_exit.data(), mod_size.data(), mod_danglingSize.data(),
+                               mod_teleportWeight.data(), Nnode, alpha, beta);
 
     for (int i = 0; i < Nnode; i++) {
         exit_log_exit += plogp(mod_exit[i]);
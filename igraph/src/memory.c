@@ -24,6 +24,8 @@
 #include "igraph_memory.h"
 #include "config.h"
 
+#include <string.h>
+
 /**
  * \function igraph_free
  * Deallocate memory that was allocated by igraph functions
@@ -97,3 +99,245 @@ int igraph_free(void *p) {
 void *igraph_malloc(size_t n) {
     return malloc(n);
 }
+
+/*
+ * Arena mode. Between igraph_memory_arena_begin() and
+ * igraph_memory_arena_end() the igraph_Calloc, igraph_Realloc and
+ * igraph_Free macros allocate from a list of large blocks. Allocation
+ * bumps a pointer and freeing is a no-op, except for the most recent
+ * allocation, which is given back. All of it is released in one step
+ * by igraph_memory_arena_end(), which keeps the largest block for the
+ * next run. This avoids the fragmentation of many small short-lived
+ * vectors in allocators that never return memory, like emmalloc.
+ *
+ * Pointers not owned by the arena are passed to realloc() and free(),
+ * so memory allocated before igraph_memory_arena_begin() may be
+ * released inside it. Memory from the arena must not outlive
+ * igraph_memory_arena_end().
+ */
+
+#define IGRAPH_I_ARENA_ALIGN 16
+#define IGRAPH_I_ARENA_MIN_BLOCK (1 << 20)
+
+/* Every allocation is preceded by its size, padded to keep alignment */
+#define IGRAPH_I_ARENA_HEADER IGRAPH_I_ARENA_ALIGN
+
+typedef struct igraph_i_arena_block_t {
+    struct igraph_i_arena_block_t *next;
+    size_t size, used;
+    size_t last;     /* offset of the most recent allocation */
+    char *data;
+} igraph_i_arena_block_t;
+
+static IGRAPH_THREAD_LOCAL struct {
+    int active;
+    igraph_i_arena_block_t *blocks;   /* current block first */
+    size_t used, peak;
+} igraph_i_arena = { 0, NULL, 0, 0 };
+
+static size_t igraph_i_arena_round(size_t size) {
+    return (size + IGRAPH_I_ARENA_ALIGN - 1) / IGRAPH_I_ARENA_ALIGN * IGRAPH_I_ARENA_ALIGN;
+}
+
+static igraph_i_arena_block_t *igraph_i_arena_owner(const void *p) {
+    igraph_i_arena_block_t *block;
+    for (block = igraph_i_arena.blocks; block; block = block->next) {
+        if ((const char *) p > block->data && (const char *) p < block->data + block->size) {
+            return block;
+        }
+    }
+    return NULL;
+}
+
+static size_t igraph_i_arena_size_of(const void *p) {
+    return *(const size_t *) ((const char *) p - IGRAPH_I_ARENA_HEADER);
+}
+
+static void *igraph_i_arena_alloc(size_t size) {
+    igraph_i_arena_block_t *block = igraph_i_arena.blocks;
+    size_t needed = IGRAPH_I_ARENA_HEADER + igraph_i_arena_round(size);
+    char *p;
+
+    if (!block || block->size - block->used < needed) {
+        /* Blocks double in size, so there are only a few of them */
+        size_t block_size = block ? 2 * block->size : IGRAPH_I_ARENA_MIN_BLOCK;
+        if (block_size < needed) {
+            block_size = needed;
+        }
+        block = malloc(sizeof(igraph_i_arena_block_t) + block_size + IGRAPH_I_ARENA_ALIGN);
+        if (!block) {
+            return NULL;
+        }
+        block->data = (char *) block + igraph_i_arena_round(sizeof(igraph_i_arena_block_t));
+        block->size = block_size;
+        block->used = 0;
+        block->last = 0;
+        block->next = igraph_i_arena.blocks;
+        igraph_i_arena.blocks = block;
+    }
+
+    p = block->data + block->used;
+    *(size_t *) p = size;
+    block->last = block->used;
+    block->used += needed;
+
+    igraph_i_arena.used += needed;
+    if (igraph_i_arena.used > igraph_i_arena.peak) {
+        igraph_i_arena.peak = igraph_i_arena.used;
+    }
+
+    return p + IGRAPH_I_ARENA_HEADER;
+}
+
+/* Whether p is the most recent allocation of the current block */
+static int igraph_i_arena_is_last(const void *p) {
+    igraph_i_arena_block_t *block = igraph_i_arena.blocks;
+    return block && block->used > 0 &&
+           (const char *) p == block->data + block->last + IGRAPH_I_ARENA_HEADER;
+}
+
+void *igraph_i_calloc(size_t n, size_t size) {
+    void *p;
+
+    if (!igraph_i_arena.active) {
+        return calloc(n, size);
+    }
+    if (size != 0 && n > (size_t) -1 / size) {
+        return NULL;
+    }
+
+    p = igraph_i_arena_alloc(n * size);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void *igraph_i_realloc(void *p, size_t size) {
+    igraph_i_arena_block_t *block;
+    size_t old_size;
+    void *result;
+
+    if (!igraph_i_arena.active || (p && !igraph_i_arena_owner(p))) {
+        return realloc(p, size);
+    }
+    if (!p) {
+        return igraph_i_arena_alloc(size);
+    }
+
+    old_size = igraph_i_arena_size_of(p);
+
+    /* The most recent allocation grows or shrinks in place if it fits */
+    block = igraph_i_arena.blocks;
+    if (igraph_i_arena_is_last(p) &&
+        block->last + IGRAPH_I_ARENA_HEADER + igraph_i_arena_round(size) <= block->size) {
+        size_t old_end = block->used;
+        block->used = block->last + IGRAPH_I_ARENA_HEADER + igraph_i_arena_round(size);
+        igraph_i_arena.used = igraph_i_arena.used - old_end + block->used;
+        if (igraph_i_arena.used > igraph_i_arena.peak) {
+            igraph_i_arena.peak = igraph_i_arena.used;
+        }
+        *(size_t *) ((char *) p - IGRAPH_I_ARENA_HEADER) = size;
+        return p;
+    }
+
+    result = igraph_i_arena_alloc(size);
+    if (result) {
+        memcpy(result, p, old_size < size ? old_size : size);
+    }
+    return result;
+}
+
+void igraph_i_free(void *p) {
+    igraph_i_arena_block_t *block;
+
+    if (!p) {
+        return;
+    }
+    if (!igraph_i_arena.active || !igraph_i_arena_owner(p)) {
+        free(p);
+        return;
+    }
+
+    /* Only the most recent allocation is given back, the rest waits for the reset */
+    if (igraph_i_arena_is_last(p)) {
+        block = igraph_i_arena.blocks;
+        igraph_i_arena.used -= block->used - block->last;
+        block->used = block->last;
+    }
+}
+
+/**
+ * \function igraph_memory_arena_begin
+ * Route igraph's internal allocations to a per-run arena
+ *
+ * Until \ref igraph_memory_arena_end() is called, memory allocated by
+ * igraph is taken from large blocks and is not returned individually.
+ * All igraph objects created after this call must be destroyed before
+ * \ref igraph_memory_arena_end(). Resets the peak statistics.
+ *
+ * \sa \ref igraph_memory_arena_end(), \ref igraph_memory_arena_stats()
+ */
+
+void igraph_memory_arena_begin(void) {
+    igraph_i_arena.active = 1;
+    igraph_i_arena.used = 0;
+    igraph_i_arena.peak = 0;
+}
+
+/**
+ * \function igraph_memory_arena_end
+ * Release all memory of the arena
+ *
+ * Switches back to calloc/realloc/free. The largest block is kept for
+ * the next \ref igraph_memory_arena_begin(), the others are freed.
+ */
+
+void igraph_memory_arena_end(void) {
+    igraph_i_arena_block_t *block = igraph_i_arena.blocks, *largest = block, *next;
+
+    for (; block; block = block->next) {
+        if (block->size > largest->size) {
+            largest = block;
+        }
+    }
+    for (block = igraph_i_arena.blocks; block; block = next) {
+        next = block->next;
+        if (block != largest) {
+            free(block);
+        }
+    }
+    if (largest) {
+        largest->next = NULL;
+        largest->used = 0;
+        largest->last = 0;
+    }
+
+    igraph_i_arena.blocks = largest;
+    igraph_i_arena.used = 0;
+    igraph_i_arena.active = 0;
+}
+
+/**
+ * \function igraph_memory_arena_stats
+ * Memory statistics of the arena
+ *
+ * \param peak If not null, the largest number of bytes used at once since
+ *        the last \ref igraph_memory_arena_begin().
+ * \param reserved If not null, the number of bytes in the arena blocks,
+ *        kept even after \ref igraph_memory_arena_end().
+ */
+
+void igraph_memory_arena_stats(size_t *peak, size_t *reserved) {
+    igraph_i_arena_block_t *block;
+
+    if (peak) {
+        *peak = igraph_i_arena.peak;
+    }
+    if (reserved) {
+        *reserved = 0;
+        for (block = igraph_i_arena.blocks; block; block = block->next) {
+            *reserved += block->size;
+        }
+    }
+}
@@ -29,12 +29,231 @@
 #include "igraph_glpk_support.h"
 #include "igraph_interrupt_internal.h"
 #include "igraph_centrality.h"
+#include "igraph_components.h"
+#include "igraph_memory.h"
 #include "config.h"
 
 #ifdef HAVE_GLPK
     #include <glpk.h>
 #endif
 
+#ifdef HAVE_GLPK
+
+#define IDX(a,b) ((b)*((b)+1)/2+(a))
+#define PAIR(a,b) ((a) < (b) ? IDX(a,b) : IDX(b,a))
+
+typedef struct {
+    const igraph_real_t *incumbent;
+    igraph_bool_t submitted;
+} igraph_i_optimal_modularity_hook_data_t;
+
+/* Offers the incumbent partition (if any) to GLPK at the first
+   heuristic callback, so that branch-and-bound starts with a good
+   lower bound, and handles interruption like the default hook. */
+
+static void igraph_i_optimal_modularity_hook(glp_tree *tree, void *info) {
+    igraph_i_optimal_modularity_hook_data_t *data =
+        (igraph_i_optimal_modularity_hook_data_t *) info;
+
+    if (data->incumbent && !data->submitted &&
+        glp_ios_reason(tree) == GLP_IHEUR) {
+        glp_ios_heur_sol(tree, data->incumbent);
+        data->submitted = 1;
+    }
+
+    igraph_i_glpk_interruption_hook(tree, 0);
+}
+
+/* Adds the transitivity constraint x_ab + x_ac - x_bc <= 1 with apex 'a'. */
+
+static void igraph_i_optimal_modularity_add_row(glp_prob *ip, int st,
+        int a, int b, int c) {
+    int idx[] = { 0, 0, 0, 0 };
+    double coef[] = { 0.0, 1.0, 1.0, -1.0 };
+    int row = glp_add_rows(ip, 1);
+
+    idx[1] = st + PAIR(a, b); idx[2] = st + PAIR(a, c); idx[3] = st + PAIR(b, c);
+    glp_set_row_bnds(ip, row, GLP_UP, 0.0, 1.0);
+    glp_set_mat_row(ip, row, 3, idx, coef);
+}
+
+/* The transitivity constraint with apex 'a' is only needed when at
+   least one of the two pairs containing 'a' has a non-negative
+   objective coefficient. Otherwise it can be dropped without changing
+   the optimum, see Dinh and Thai: Toward optimal community detection:
+   from trees to general weighted networks, Internet Mathematics 11(3),
+   2015, and Miyauchi and Sukegawa: Redundant constraints in the
+   standard formulation for the clique partitioning problem,
+   Optimization Letters 9(1), 2015. For modularity this keeps only the
+   O(nm) constraints that involve an edge. */
+
+static igraph_bool_t igraph_i_optimal_modularity_needs_row(
+        const igraph_real_t *c, int a, int b, int cc) {
+    return c[PAIR(a, b)] >= 0 || c[PAIR(a, cc)] >= 0;
+}
+
+/* Solves the integer program for a single (weakly) connected
+   component with 'nc' vertices. 'coef' holds the objective
+   coefficients of the pair variables in IDX() order, 'incumbent' is an
+   optional starting partition given as local community ids. The local
+   community ids of the optimum are stored in 'comm' and its objective
+   value in 'value'. */
+
+static int igraph_i_optimal_modularity_component(int nc,
+        const igraph_vector_t *coef,
+        const igraph_vector_int_t *incumbent,
+        igraph_real_t *value,
+        igraph_vector_int_t *comm) {
+
+    int no_of_variables = nc * (nc + 1) / 2;
+    int i, j, k, st, added;
+    const igraph_real_t *c = VECTOR(*coef);
+    igraph_vector_t x, start;
+    igraph_i_optimal_modularity_hook_data_t hook_data = { 0, 0 };
+
+    glp_prob *ip;
+    glp_smcp sparm;
+    glp_iocp parm;
+
+    IGRAPH_CHECK(igraph_vector_int_resize(comm, nc));
+
+    if (nc == 1) {
+        *value = c[IDX(0, 0)];
+        VECTOR(*comm)[0] = 0;
+        return 0;
+    }
+
+    IGRAPH_VECTOR_INIT_FINALLY(&x, no_of_variables);
+    IGRAPH_VECTOR_INIT_FINALLY(&start, 0);
+
+    glp_term_out(GLP_OFF);
+    ip = glp_create_prob();
+    IGRAPH_FINALLY(glp_delete_prob, ip);
+
+    glp_set_obj_dir(ip, GLP_MAX);
+    st = glp_add_cols(ip, no_of_variables);
+
+    /* variables are binary */
+    for (i = 0; i < no_of_variables; i++) {
+        glp_set_col_kind(ip, (st + i), GLP_BV);
+        glp_set_obj_coef(ip, (st + i), c[i]);
+    }
+
+    /* reflexivity */
+    for (i = 0; i < nc; i++) {
+        glp_set_col_bnds(ip, (st + IDX(i, i)), GLP_FX, 1.0, 1.0);
+    }
+
+    /* transitivity, only the constraints that are not redundant */
+    for (i = 0; i < nc; i++) {
+        for (j = i + 1; j < nc; j++) {
+
+            IGRAPH_ALLOW_INTERRUPTION();
+
+            for (k = j + 1; k < nc; k++) {
+                if (igraph_i_optimal_modularity_needs_row(c, j, i, k)) {
+                    igraph_i_optimal_modularity_add_row(ip, st, j, i, k);
+                }
+                if (igraph_i_optimal_modularity_needs_row(c, i, j, k)) {
+                    igraph_i_optimal_modularity_add_row(ip, st, i, j, k);
+                }
+                if (igraph_i_optimal_modularity_needs_row(c, k, i, j)) {
+                    igraph_i_optimal_modularity_add_row(ip, st, k, i, j);
+                }
+            }
+        }
+    }
+
+    /* the incumbent, GLPK indexes columns from one */
+    if (incumbent) {
+        IGRAPH_CHECK(igraph_vector_resize(&start, no_of_variables + 1));
+        VECTOR(start)[0] = 0;
+        for (j = 0; j < nc; j++) {
+            for (i = 0; i <= j; i++) {
+                VECTOR(start)[st + IDX(i, j)] =
+                    VECTOR(*incumbent)[i] == VECTOR(*incumbent)[j] ? 1.0 : 0.0;
+            }
+        }
+        hook_data.incumbent = VECTOR(start);
+    }
+
+    /* The MIP presolver is off, as heuristic solutions must be given
+       in terms of the original columns. glp_intopt() then needs an
+       optimal basis of the LP relaxation, hence glp_simplex() first. */
+    glp_init_smcp(&sparm);
+    sparm.msg_lev = GLP_MSG_OFF;
+    sparm.presolve = GLP_OFF;
+
+    glp_init_iocp(&parm);
+    parm.msg_lev = GLP_MSG_OFF;
+    parm.br_tech = GLP_BR_DTH;
+    parm.bt_tech = GLP_BT_BLB;
+    parm.presolve = GLP_OFF;
+    parm.cb_func = igraph_i_optimal_modularity_hook;
+    parm.cb_info = &hook_data;
+
+    do {
+        IGRAPH_GLPK_CHECK(glp_simplex(ip, &sparm), "Modularity optimization failed");
+        hook_data.submitted = 0;
+        IGRAPH_GLPK_CHECK(glp_intopt(ip, &parm), "Modularity optimization failed");
+
+        for (i = 0; i < no_of_variables; i++) {
+            VECTOR(x)[i] = glp_mip_col_val(ip, st + i);
+        }
+
+        /* Safety net for the dropped constraints: add any of them that
+           the solution violates and solve again. */
+        added = 0;
+        for (i = 0; i < nc; i++) {
+            for (j = i + 1; j < nc; j++) {
+                for (k = j + 1; k < nc; k++) {
+                    igraph_real_t xij = VECTOR(x)[IDX(i, j)];
+                    igraph_real_t xik = VECTOR(x)[IDX(i, k)];
+                    igraph_real_t xjk = VECTOR(x)[IDX(j, k)];
+                    if (xij + xjk - xik > 1.5) {
+                        igraph_i_optimal_modularity_add_row(ip, st, j, i, k);
+                        added++;
+                    }
+                    if (xij + xik - xjk > 1.5) {
+                        igraph_i_optimal_modularity_add_row(ip, st, i, j, k);
+                        added++;
+                    }
+                    if (xik + xjk - xij > 1.5) {
+                        igraph_i_optimal_modularity_add_row(ip, st, k, i, j);
+                        added++;
+                    }
+                }
+            }
+        }
+    } while (added > 0);
+
+    *value = glp_mip_obj_val(ip);
+
+    {
+        int next = 0;   /* id of the next new community */
+        for (i = 0; i < nc; i++) {
+            for (j = 0; j < i; j++) {
+                if (VECTOR(x)[IDX(j, i)] > 0.5) {
+                    VECTOR(*comm)[i] = VECTOR(*comm)[j];
+                    break;
+                }
+            }
+            if (j == i) {     /* new community */
+                VECTOR(*comm)[i] = next++;
+            }
+        }
+    }
+
+    igraph_vector_destroy(&start);
+    igraph_vector_destroy(&x);
+    glp_delete_prob(ip);
+    IGRAPH_FINALLY_CLEAN(3);
+
+    return 0;
+}
+
+#endif
+
 /**
  * \function igraph_community_optimal_modularity
  * Calculate the community structure with the highest modularity value
@@ -50,6 +269,16 @@
  * Engineering 20(2):172-188, 2008.
  *
  * </para><para>
+ * No community of an optimal partition spans more than one (weakly)
+ * connected component, so every component is solved as a separate,
+ * smaller integer program. Transitivity constraints that are
+ * redundant for modularity (those not involving a pair with a
+ * non-negative objective coefficient, e.g. an edge) are left out, and
+ * for undirected graphs the Louvain partition (see \ref
+ * igraph_community_multilevel()) is given to GLPK as the initial
+ * incumbent solution.
+ *
+ * </para><para>
  * Note that modularity optimization is an NP-complete problem, and
  * all known algorithms for it have exponential time complexity. This
  * means that you probably don't want to run this function on larger
@@ -70,7 +299,8 @@
  * \sa \ref igraph_modularity(), \ref igraph_community_fastgreedy()
  * for an algorithm that finds a local optimum in a greedy way.
  *
- * Time complexity: exponential in the number of vertices.
+ * Time complexity: exponential in the number of vertices of the
+ * largest component.
  *
  * \example examples/simple/igraph_community_optimal_modularity.c
  */
@@ -79,6 +309,38 @@ int igraph_community_optimal_modularity(const igraph_t *graph,
                                         igraph_real_t *modularity,
                                         igraph_vector_t *membership,
                                         const igraph_vector_t *weights) {
+    return igraph_community_optimal_modularity_resolution(graph, 1, modularity,
+            membership, weights);
+}
+
+/**
+ * \function igraph_community_optimal_modularity_resolution
+ * Optimal community structure for the generalized modularity
+ *
+ * This function is \ref igraph_community_optimal_modularity() with the
+ * null model term of the modularity weighed by the resolution, as in
+ * \ref igraph_community_multilevel_resolution().
+ *
+ * \param graph The input graph. It is always treated as undirected.
+ * \param resolution The resolution, non-negative; 1 gives the
+ *        modularity.
+ * \param modularity Pointer to a real number, or a null pointer, the
+ *        optimal generalized modularity is returned here.
+ * \param membership Pointer to a vector, or a null pointer, see \ref
+ *        igraph_community_optimal_modularity().
+ * \param weights Vector giving the weights of the edges. If it is
+ *        \c NULL then each edge is supposed to have the same weight.
+ * \return Error code.
+ *
+ * Time complexity: exponential in the number of vertices of the
+ * largest component.
+ */
+
+int igraph_community_optimal_modularity_resolution(const igraph_t *graph,
+        igraph_real_t resolution,
+        igraph_real_t *modularity,
+        igraph_vector_t *membership,
+        const igraph_vector_t *weights) {
 
 #ifndef HAVE_GLPK
     IGRAPH_ERROR("GLPK is not available",
@@ -88,17 +350,18 @@ int igraph_community_optimal_modularity(const igraph_t *graph,
     igraph_integer_t no_of_nodes = (igraph_integer_t) igraph_vcount(graph);
     igraph_integer_t no_of_edges = (igraph_integer_t) igraph_ecount(graph);
     igraph_bool_t directed = igraph_is_directed(graph);
-    int no_of_variables = no_of_nodes * (no_of_nodes + 1) / 2;
-    int i, j, k, l, st;
-    int idx[] = { 0, 0, 0, 0 };
-    double coef[] = { 0.0, 1.0, 1.0, -2.0 };
-    igraph_real_t total_weight;
+    igraph_integer_t no_of_comps;
+    long int i, j, k, l, c;
+    igraph_real_t total_weight, value, sum = 0.0;
     igraph_vector_t indegree;
     igraph_vector_t outdegree;
+    igraph_vector_t comp_membership, csize, louvain, coef;
+    igraph_vector_int_t vertex_order, vertex_start, edge_order, edge_start;
+    igraph_vector_int_t local_idx, incumbent, comm, result;
 
-    glp_prob *ip;
-    glp_iocp parm;
-
+    if (resolution < 0) {
+        IGRAPH_ERROR("The resolution must be non-negative", IGRAPH_EINVAL);
+    }
     if (weights != 0) {
         if (igraph_vector_size(weights) != no_of_edges) {
             IGRAPH_ERROR("Invalid length of weight vector", IGRAPH_EINVAL);
@@ -126,6 +389,7 @@ int igraph_community_optimal_modularity(const igraph_t *graph,
             IGRAPH_CHECK(igraph_vector_resize(membership, no_of_nodes));
             igraph_vector_null(membership);
         }
+        return 0;
     }
 
     IGRAPH_VECTOR_INIT_FINALLY(&indegree, no_of_nodes);
@@ -135,122 +399,142 @@ int igraph_community_optimal_modularity(const igraph_t *graph,
     IGRAPH_CHECK(igraph_strength(graph, &outdegree, igraph_vss_all(),
                                  IGRAPH_OUT, IGRAPH_LOOPS, weights));
 
-    glp_term_out(GLP_OFF);
-    ip = glp_create_prob();
-    IGRAPH_FINALLY(glp_delete_prob, ip);
-
-    glp_set_obj_dir(ip, GLP_MAX);
-    st = glp_add_cols(ip, no_of_variables);
+    IGRAPH_VECTOR_INIT_FINALLY(&comp_membership, no_of_nodes);
+    IGRAPH_VECTOR_INIT_FINALLY(&csize, 0);
+    IGRAPH_CHECK(igraph_clusters(graph, &comp_membership, &csize,
+                                 &no_of_comps, IGRAPH_WEAK));
 
-    /* variables are binary */
-    for (i = 0; i < no_of_variables; i++) {
-        glp_set_col_kind(ip, (st + i), GLP_BV);
+    /* Louvain never joins different components, and its partition is a
+       feasible solution, so it is a good incumbent for every component. */
+    IGRAPH_VECTOR_INIT_FINALLY(&louvain, 0);
+    if (!directed) {
+        IGRAPH_CHECK(igraph_community_multilevel_resolution(graph, weights, resolution,
+                     &louvain, 0, 0));
     }
 
-#define IDX(a,b) ((b)*((b)+1)/2+(a))
+    /* vertices and edges bucketed by component */
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&vertex_order, no_of_nodes);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&vertex_start, no_of_comps + 1);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&edge_order, no_of_edges);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&edge_start, no_of_comps + 1);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&local_idx, no_of_nodes);
 
-    /* reflexivity */
     for (i = 0; i < no_of_nodes; i++) {
-        glp_set_col_bnds(ip, (st + IDX(i, i)), GLP_FX, 1.0, 1.0);
+        c = (long int) VECTOR(comp_membership)[i];
+        VECTOR(local_idx)[i] = VECTOR(vertex_start)[c + 1]++;
+    }
+    for (i = 0; i < no_of_edges; i++) {
+        c = (long int) VECTOR(comp_membership)[IGRAPH_FROM(graph, i)];
+        VECTOR(edge_start)[c + 1]++;
+    }
+    for (c = 0; c < no_of_comps; c++) {
+        VECTOR(vertex_start)[c + 1] += VECTOR(vertex_start)[c];
+        VECTOR(edge_start)[c + 1] += VECTOR(edge_start)[c];
     }
-
-    /* transitivity */
     for (i = 0; i < no_of_nodes; i++) {
-        for (j = i + 1; j < no_of_nodes; j++) {
-
-            IGRAPH_ALLOW_INTERRUPTION();
-
-            for (k = j + 1; k < no_of_nodes; k++) {
-                int newrow = glp_add_rows(ip, 3);
-
-                glp_set_row_bnds(ip, newrow, GLP_UP, 0.0, 1.0);
-                idx[1] = (st + IDX(i, j)); idx[2] = (st + IDX(j, k));
-                idx[3] = (st + IDX(i, k));
-                glp_set_mat_row(ip, newrow, 3, idx, coef);
+        c = (long int) VECTOR(comp_membership)[i];
+        VECTOR(vertex_order)[VECTOR(vertex_start)[c] + VECTOR(local_idx)[i]] = i;
+    }
+    for (i = 0; i < no_of_edges; i++) {
+        c = (long int) VECTOR(comp_membership)[IGRAPH_FROM(graph, i)];
+        VECTOR(edge_order)[VECTOR(edge_start)[c]++] = i;
+    }
+    for (c = no_of_comps; c > 0; c--) {
+        VECTOR(edge_start)[c] = VECTOR(edge_start)[c - 1];
+    }
+    VECTOR(edge_start)[0] = 0;
 
-                glp_set_row_bnds(ip, newrow + 1, GLP_UP, 0.0, 1.0);
-                idx[1] = st + IDX(i, j); idx[2] = st + IDX(i, k); idx[3] = st + IDX(j, k);
-                glp_set_mat_row(ip, newrow + 1, 3, idx, coef);
+    IGRAPH_VECTOR_INIT_FINALLY(&coef, 0);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&incumbent, 0);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&comm, 0);
+    IGRAPH_VECTOR_INT_INIT_FINALLY(&result, no_of_nodes);
 
-                glp_set_row_bnds(ip, newrow + 2, GLP_UP, 0.0, 1.0);
-                idx[1] = st + IDX(i, k); idx[2] = st + IDX(j, k); idx[3] = st + IDX(i, j);
-                glp_set_mat_row(ip, newrow + 2, 3, idx, coef);
+    for (c = 0; c < no_of_comps; c++) {
+        long int first = VECTOR(vertex_start)[c];
+        long int nc = VECTOR(vertex_start)[c + 1] - first;
+        const int *vids = VECTOR(vertex_order) + first;
 
-            }
-        }
-    }
+        IGRAPH_ALLOW_INTERRUPTION();
 
-    /* objective function */
-    {
-        igraph_real_t c;
+        /* objective function */
+        IGRAPH_CHECK(igraph_vector_resize(&coef, nc * (nc + 1) / 2));
 
-        /* first part: -strength(i)*strength(j)/total_weight for every node pair */
-        for (i = 0; i < no_of_nodes; i++) {
-            for (j = i + 1; j < no_of_nodes; j++) {
-                c = -VECTOR(indegree)[i] * VECTOR(outdegree)[j] / total_weight \
-                    -VECTOR(outdegree)[i] * VECTOR(indegree)[j] / total_weight;
-                glp_set_obj_coef(ip, st + IDX(i, j), c);
+        /* first part: -resolution*strength(i)*strength(j)/total_weight for every node pair */
+        for (i = 0; i < nc; i++) {
+            for (j = i + 1; j < nc; j++) {
+                VECTOR(coef)[IDX(i, j)] = -resolution * (
+                    VECTOR(indegree)[vids[i]] * VECTOR(outdegree)[vids[j]] / total_weight +
+                    VECTOR(outdegree)[vids[i]] * VECTOR(indegree)[vids[j]] / total_weight);
             }
             /* special case for (i,i) */
-            c = -VECTOR(indegree)[i] * VECTOR(outdegree)[i] / total_weight;
-            glp_set_obj_coef(ip, st + IDX(i, i), c);
+            VECTOR(coef)[IDX(i, i)] =
+                -resolution * VECTOR(indegree)[vids[i]] * VECTOR(outdegree)[vids[i]] / total_weight;
         }
 
         /* second part: add the weighted adjacency matrix to the coefficient matrix */
-        for (k = 0; k < no_of_edges; k++) {
-            i = IGRAPH_FROM(graph, k);
-            j = IGRAPH_TO(graph, k);
+        for (k = VECTOR(edge_start)[c]; k < VECTOR(edge_start)[c + 1]; k++) {
+            long int e = VECTOR(edge_order)[k];
+            igraph_real_t w = weights ? VECTOR(*weights)[e] : 1.0;
+            i = VECTOR(local_idx)[IGRAPH_FROM(graph, e)];
+            j = VECTOR(local_idx)[IGRAPH_TO(graph, e)];
             if (i > j) {
                 l = i; i = j; j = l;
             }
-            c = weights ? VECTOR(*weights)[k] : 1.0;
             if (!directed || i == j) {
-                c *= 2.0;
+                w *= 2.0;
             }
-            glp_set_obj_coef(ip, st + IDX(i, j), c + glp_get_obj_coef(ip, st + IDX(i, j)));
+            VECTOR(coef)[IDX(i, j)] += w;
         }
-    }
 
-    /* solve it */
-    glp_init_iocp(&parm);
-    parm.br_tech = GLP_BR_DTH;
-    parm.bt_tech = GLP_BT_BLB;
-    parm.presolve = GLP_ON;
-    parm.binarize = GLP_ON;
-    parm.cb_func = igraph_i_glpk_interruption_hook;
-    IGRAPH_GLPK_CHECK(glp_intopt(ip, &parm), "Modularity optimization failed");
+        if (!directed) {
+            IGRAPH_CHECK(igraph_vector_int_resize(&incumbent, nc));
+            for (i = 0; i < nc; i++) {
+                VECTOR(incumbent)[i] = (int) VECTOR(louvain)[vids[i]];
+            }
+        }
+
+        IGRAPH_CHECK(igraph_i_optimal_modularity_component(
+                         (int) nc, &coef, directed ? 0 : &incumbent, &value, &comm));
+        sum += value;
+
+        for (i = 0; i < nc; i++) {
+            VECTOR(result)[vids[i]] = first + VECTOR(comm)[i];
+        }
+    }
 
     /* store the results */
     if (modularity) {
-        *modularity = glp_mip_obj_val(ip) / total_weight;
+        *modularity = sum / total_weight;
     }
 
     if (membership) {
-        long int comm = 0;   /* id of the last community that was found */
+        long int next = 0;   /* id of the next new community */
         IGRAPH_CHECK(igraph_vector_resize(membership, no_of_nodes));
+        igraph_vector_int_fill(&local_idx, -1);
         for (i = 0; i < no_of_nodes; i++) {
-
-            IGRAPH_ALLOW_INTERRUPTION();
-
-            for (j = 0; j < i; j++) {
-                int val = (int) glp_mip_col_val(ip, st + IDX(j, i));
-                if (val == 1) {
-                    VECTOR(*membership)[i] = VECTOR(*membership)[j];
-                    break;
-                }
-            }
-            if (j == i) {     /* new community */
-                VECTOR(*membership)[i] = comm++;
+            k = VECTOR(result)[i];
+            if (VECTOR(local_idx)[k] < 0) {
+                VECTOR(local_idx)[k] = next++;
             }
+            VECTOR(*membership)[i] = VECTOR(local_idx)[k];
         }
     }
 
-#undef IDX
-
+    igraph_vector_int_destroy(&result);
+    igraph_vector_int_destroy(&comm);
+    igraph_vector_int_destroy(&incumbent);
+    igraph_vector_destroy(&coef);
+    igraph_vector_int_destroy(&local_idx);
+    igraph_vector_int_destroy(&edge_start);
+    igraph_vector_int_destroy(&edge_order);
+    igraph_vector_int_destroy(&vertex_start);
+    igraph_vector_int_destroy(&vertex_order);
+    igraph_vector_destroy(&louvain);
+    igraph_vector_destroy(&csize);
+    igraph_vector_destroy(&comp_membership);
     igraph_vector_destroy(&indegree);
     igraph_vector_destroy(&outdegree);
-    glp_delete_prob(ip);
-    IGRAPH_FINALLY_CLEAN(3);
+    IGRAPH_FINALLY_CLEAN(14);
 
     return 0;
 
@@ -258,3 +542,7 @@ int igraph_community_optimal_modularity(const igraph_t *graph,
 
 }
 
+#ifdef HAVE_GLPK
+#undef PAIR
+#undef IDX
+#endif
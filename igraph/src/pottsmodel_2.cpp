@@ -58,8 +58,10 @@ using namespace std;
 //#################################################################################################
 PottsModel::PottsModel(network *n, unsigned int qvalue, int m) : acceptance(0) {
     DLList_Iter<NNode*> iter;
+    DLList_Iter<NLink*> l_iter;
     NNode *n_cur;
-    unsigned int *i_ptr;
+    NLink *l_cur;
+    unsigned long i, k;
     net = n;
     q = qvalue;
     operation_mode = m;
@@ -75,35 +77,63 @@ PottsModel::PottsModel(network *n, unsigned int qvalue, int m) : acceptance(0) {
     num_of_nodes = net->node_list->Size();
     num_of_links = net->link_list->Size();
 
+    //these arrays are needed to keep track of spin states for parallel update mode
+    new_spins = new unsigned int[num_of_nodes];
+    previous_spins = new unsigned int[num_of_nodes];
+    spins = new unsigned int[num_of_nodes];
+    node_ptr = new NNode*[num_of_nodes];
+    node_weight = new double[num_of_nodes];
+    adj_start = new unsigned long[num_of_nodes + 1];
+
+    //the heat bath updates read the network from contiguous arrays,
+    //the neighbours of node i are in adj_node[adj_start[i]..adj_start[i+1]-1]
+    adj_start[0] = 0;
+    i = 0;
     n_cur = iter.First(net->node_list);
-    //these lists are needed to keep track of spin states for parallel update mode
-    new_spins = new DL_Indexed_List<unsigned int*>();
-    previous_spins = new DL_Indexed_List<unsigned int*>();
     while (!iter.End()) {
         if (k_max < n_cur->Get_Degree()) {
             k_max = n_cur->Get_Degree();
         }
-        i_ptr = new unsigned int;
-        *i_ptr = 0;
-        new_spins->Push(i_ptr);
-        i_ptr = new unsigned int;
-        *i_ptr = 0;
-        previous_spins->Push(i_ptr);
+        new_spins[i] = 0;
+        previous_spins[i] = 0;
+        node_ptr[i] = n_cur;
+        adj_start[i + 1] = adj_start[i] + n_cur->Get_Links()->Size();
+        i++;
         n_cur = iter.Next();
     }
+    adj_node = new unsigned int[adj_start[num_of_nodes]];
+    adj_weight = new double[adj_start[num_of_nodes]];
+    for (i = 0; i < num_of_nodes; i++) {
+        n_cur = node_ptr[i];
+        k = adj_start[i];
+        node_weight[i] = 0.0;
+        l_cur = l_iter.First(n_cur->Get_Links());
+        while (!l_iter.End()) {
+            if (n_cur == l_cur->Get_Start()) {
+                adj_node[k] = l_cur->Get_End()->Get_Index();
+            } else {
+                adj_node[k] = l_cur->Get_Start()->Get_Index();
+            }
+            adj_weight[k] = l_cur->Get_Weight();
+            node_weight[i] += adj_weight[k];
+            k++;
+            l_cur = l_iter.Next();
+        }
+    }
     return;
 }
 //#######################################################
 //Destructor of PottsModel
 //########################################################
 PottsModel::~PottsModel() {
-    /* The DLItem destructor does not delete its item currently,
-       because of some bad design. As a workaround, we delete them here
-       by hand */
-    new_spins->delete_items();
-    previous_spins->delete_items();
-    delete new_spins;
-    delete previous_spins;
+    delete [] new_spins;
+    delete [] previous_spins;
+    delete [] spins;
+    delete [] node_ptr;
+    delete [] node_weight;
+    delete [] adj_start;
+    delete [] adj_node;
+    delete [] adj_weight;
     delete [] Qa;
     delete [] weights;
     delete [] color_field;
@@ -111,6 +141,15 @@ PottsModel::~PottsModel() {
     return;
 }
 //#####################################################
+//The heat bath updates keep the spins in an array, copy them
+//from the nodes, as other functions set them there
+//#####################################################
+void PottsModel::load_spins(void) {
+    for (unsigned long i = 0; i < num_of_nodes; i++) {
+        spins[i] = (unsigned int) node_ptr[i]->Get_ClusterIndex();
+    }
+}
+//#####################################################
 //Assing an initial random configuration of spins to nodes
 //if called with negative argument or the spin used as argument
 //when called with positve one.
@@ -118,10 +157,7 @@ PottsModel::~PottsModel() {
 //####################################################
 unsigned long PottsModel::assign_initial_conf(int spin) {
     int s;
-    DLList_Iter<NNode*> iter;
-    DLList_Iter<NLink*> l_iter;
     NNode *n_cur;
-    NLink *l_cur;
     double sum_weight;
     double av_k_squared = 0.0;
     double av_k = 0.0;
@@ -132,20 +168,16 @@ unsigned long PottsModel::assign_initial_conf(int spin) {
     }
     //
     total_degree_sum = 0.0;
-    n_cur = iter.First(net->node_list);
-    while (!iter.End()) {
+    for (unsigned long i = 0; i < num_of_nodes; i++) {
+        n_cur = node_ptr[i];
         if (spin < 0) {
             s = RNG_INTEGER(1, q);
         } else {
             s = spin;
         }
         n_cur->Set_ClusterIndex(s);
-        l_cur = l_iter.First(n_cur->Get_Links());
-        sum_weight = 0;
-        while (!l_iter.End()) {
-            sum_weight += l_cur->Get_Weight(); //weight should be one, in case we are not using it.
-            l_cur = l_iter.Next();
-        }
+        //the weights of the links were summed up when building the adjacency arrays
+        sum_weight = node_weight[i];
         // we set the sum of the weights or the degree as the weight of the node, this way
         // we do not have to calculate it again.
         n_cur->Set_Weight(sum_weight);
@@ -160,13 +192,12 @@ unsigned long PottsModel::assign_initial_conf(int spin) {
         }
         // or in case we want to use a weight of each link that is proportional to k_i\times k_j
         total_degree_sum += sum_weight;
-        n_cur = iter.Next();
     }
-    av_k_squared /= double(net->node_list->Size());
-    av_k /= double(net->node_list->Size());
+    av_k_squared /= double(num_of_nodes);
+    av_k /= double(num_of_nodes);
     // total_degree_sum-=av_k_squared/av_k;
 //   printf("Total Degree Sum=2M=%f\n",total_degree_sum);
-    return net->node_list->Size();
+    return num_of_nodes;
 }
 //#####################################################################
 //If I ever manage to write a decent LookUp function, it will be here
@@ -206,11 +237,8 @@ unsigned long PottsModel::initialize_lookup(double kT, double gamma) {
 // by num_of_links is done later
 //####################################################################
 double PottsModel::initialize_Qmatrix(void) {
-    DLList_Iter<NLink*> l_iter;
-    NLink *l_cur;
     unsigned int i, j;
     //initialize with zeros
-    num_of_links = net->link_list->Size();
     for (i = 0; i <= q; i++) {
         Qa[i] = 0.0;
         for (j = i; j <= q; j++) {
@@ -219,16 +247,14 @@ double PottsModel::initialize_Qmatrix(void) {
         }
     }
     //go over all links and make corresponding entries in Q matrix
-    //An edge connecting state i wiht state j will get an entry in Qij and Qji
-    l_cur = l_iter.First(net->link_list);
-    while (!l_iter.End()) {
-        i = l_cur->Get_Start()->Get_ClusterIndex();
-        j = l_cur->Get_End()->Get_ClusterIndex();
-        //printf("%d %d\n",i,j);
-        Qmatrix[i][j] += l_cur->Get_Weight();
-        Qmatrix[j][i] += l_cur->Get_Weight();
-
-        l_cur = l_iter.Next();
+    //An edge connecting state i wiht state j will get an entry in Qij and Qji,
+    //one from each of its ends in the adjacency arrays
+    for (unsigned long v = 0; v < num_of_nodes; v++) {
+        i = node_ptr[v]->Get_ClusterIndex();
+        for (unsigned long k = adj_start[v]; k < adj_start[v + 1]; k++) {
+            j = node_ptr[adj_node[k]]->Get_ClusterIndex();
+            Qmatrix[i][j] += adj_weight[k];
+        }
     }
     //Finally, calculate sum over rows and keep in Qa
     for (i = 0; i <= q; i++) {
@@ -274,15 +300,15 @@ double PottsModel::calculate_genQ(double gamma) {
 // #####################################################################
 double PottsModel::calculate_energy(double gamma) {
     double e = 0.0;
-    DLList_Iter<NLink*> l_iter;
-    NLink *l_cur;
-    l_cur = l_iter.First(net->link_list);
-    //every in-cluster edge contributes -1
-    while (!l_iter.End()) {
-        if (l_cur->Get_Start()->Get_ClusterIndex() == l_cur->Get_End()->Get_ClusterIndex()) {
-            e--;
-        };
-        l_cur = l_iter.Next();
+    unsigned int s;
+    //every in-cluster edge contributes -1, it is seen from both of its ends
+    for (unsigned long v = 0; v < num_of_nodes; v++) {
+        s = node_ptr[v]->Get_ClusterIndex();
+        for (unsigned long k = adj_start[v]; k < adj_start[v + 1]; k++) {
+            if (node_ptr[adj_node[k]]->Get_ClusterIndex() == s) {
+                e -= 0.5;
+            }
+        }
     }
     //and the penalty term contributes according to cluster sizes
     for (unsigned int i = 1; i <= q; i++) {
@@ -291,6 +317,34 @@ double PottsModel::calculate_energy(double gamma) {
     energy = e;
     return e;
 }
+//#######################################################################
+// This function calculates the Hamiltonian minimized by the heat bath
+// updates, up to a constant that does not depend on the spins. It is
+// used to compare the results of independent annealing runs.
+// #####################################################################
+double PottsModel::calculate_hamiltonian(double gamma, double prob) {
+    double e = 0.0, penalty = 0.0;
+    unsigned int s;
+    //links inside the clusters lower the energy, they are seen from both of their ends
+    for (unsigned long v = 0; v < num_of_nodes; v++) {
+        s = node_ptr[v]->Get_ClusterIndex();
+        for (unsigned long k = adj_start[v]; k < adj_start[v + 1]; k++) {
+            if (node_ptr[adj_node[k]]->Get_ClusterIndex() == s) {
+                e -= 0.5 * adj_weight[k];
+            }
+        }
+    }
+    //color_field holds cluster sizes or degree sums, depending on the null model
+    for (unsigned int i = 1; i <= q; i++) {
+        penalty += color_field[i] * color_field[i];
+    }
+    if (operation_mode == 0) {
+        e += gamma * prob * 0.5 * penalty;
+    } else {
+        e += gamma * 0.5 * penalty / total_degree_sum;
+    }
+    return e;
+}
 //##########################################################################
 // We would like to start from a temperature with at least 95 of all proposed
 // spin changes accepted in 50 sweeps over the network
@@ -325,18 +379,15 @@ double PottsModel::FindStartTemp(double gamma, double prob, double ts) {
 //if it does not converge earlier
 //##############################################################
 long PottsModel::HeatBathParallelLookupZeroTemp(double gamma, double prob, unsigned int max_sweeps) {
-    DLList_Iter<NNode*> iter, net_iter;
-    DLList_Iter<NLink*> l_iter;
-    DLList_Iter<unsigned int*> i_iter, i_iter2;
-    NNode *node, *n_cur;
-    NLink *l_cur;
-    unsigned int *SPIN, *P_SPIN, new_spin, spin_opt, old_spin, spin, sweep;
+    unsigned int new_spin, spin_opt, old_spin, spin, sweep, s;
+    unsigned long v, k;
     // long h; // degree;
     unsigned long changes;
     double h, delta = 0, deltaE, deltaEmin, w, degree;
     //HugeArray<double> neighbours;
     bool cyclic = 0;
 
+    load_spins();
     sweep = 0;
     changes = 1;
     while (sweep < max_sweeps && changes) {
@@ -344,30 +395,19 @@ long PottsModel::HeatBathParallelLookupZeroTemp(double gamma, double prob, unsig
         sweep++;
         changes = 0;
         //Loop over all nodes
-        node = net_iter.First(net->node_list);
-        SPIN = i_iter.First(new_spins);
-        while (!net_iter.End()) {
+        for (v = 0; v < num_of_nodes; v++) {
             // How many neigbors of each type?
             // set them all zero
             for (unsigned int i = 0; i <= q; i++) {
                 neighbours[i] = 0;
             }
-            degree = node->Get_Weight();
-            //Loop over all links (=neighbours)
-            l_cur = l_iter.First(node->Get_Links());
-            while (!l_iter.End()) {
-                //printf("%s %s\n",node->Get_Name(),n_cur->Get_Name());
-                w = l_cur->Get_Weight();
-                if (node == l_cur->Get_Start()) {
-                    n_cur = l_cur->Get_End();
-                } else {
-                    n_cur = l_cur->Get_Start();
-                }
-                neighbours[n_cur->Get_ClusterIndex()] += w;
-                l_cur = l_iter.Next();
+            degree = node_weight[v];
+            //Loop over all neighbours
+            for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                neighbours[spins[adj_node[k]]] += adj_weight[k];
             }
             //Search optimal Spin
-            old_spin = node->Get_ClusterIndex();
+            old_spin = spins[v];
             //degree=node->Get_Degree();
             switch (operation_mode) {
             case 0: {
@@ -396,55 +436,41 @@ long PottsModel::HeatBathParallelLookupZeroTemp(double gamma, double prob, unsig
             } // for spin
 
             //Put optimal spin on list for later update
-            *SPIN = spin_opt;
-            node = net_iter.Next();
-            SPIN = i_iter.Next();
-        } // while !net_iter.End()
+            new_spins[v] = spin_opt;
+        } // for v
 
         //-------------------------------
         //Now set all spins to new values
-        node = net_iter.First(net->node_list);
-        SPIN = i_iter.First(new_spins);
-        P_SPIN = i_iter2.First(previous_spins);
-        while (!net_iter.End()) {
-            old_spin = node->Get_ClusterIndex();
-            new_spin = *SPIN;
+        for (v = 0; v < num_of_nodes; v++) {
+            old_spin = spins[v];
+            new_spin = new_spins[v];
             if (new_spin != old_spin) { // Do we really have a change??
                 changes++;
-                node->Set_ClusterIndex(new_spin);
+                set_spin(v, new_spin);
                 //this is important!!
                 //In Parallel update, there occur cyclic attractors of size two
                 //which then make the program run for ever
-                if (new_spin != *P_SPIN) {
+                if (new_spin != previous_spins[v]) {
                     cyclic = false;
                 }
-                *P_SPIN = old_spin;
+                previous_spins[v] = old_spin;
                 color_field[old_spin]--;
                 color_field[new_spin]++;
 
                 //Qmatrix update
                 //iteration over all neighbours
-                l_cur = l_iter.First(node->Get_Links());
-                while (!l_iter.End()) {
-                    w = l_cur->Get_Weight();
-                    if (node == l_cur->Get_Start()) {
-                        n_cur = l_cur->Get_End();
-                    } else {
-                        n_cur = l_cur->Get_Start();
-                    }
-                    Qmatrix[old_spin][n_cur->Get_ClusterIndex()] -= w;
-                    Qmatrix[new_spin][n_cur->Get_ClusterIndex()] += w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][old_spin] -= w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][new_spin] += w;
+                for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                    w = adj_weight[k];
+                    s = spins[adj_node[k]];
+                    Qmatrix[old_spin][s] -= w;
+                    Qmatrix[new_spin][s] += w;
+                    Qmatrix[s][old_spin] -= w;
+                    Qmatrix[s][new_spin] += w;
                     Qa[old_spin] -= w;
                     Qa[new_spin] += w;
-                    l_cur = l_iter.Next();
-                }  // while l_iter
+                }  // for k
             }
-            node = net_iter.Next();
-            SPIN = i_iter.Next();
-            P_SPIN = i_iter2.Next();
-        } // while (!net_iter.End())
+        } // for v
     }  // while markov
 
     // In case of a cyclic attractor, we want to interrupt
@@ -462,17 +488,14 @@ long PottsModel::HeatBathParallelLookupZeroTemp(double gamma, double prob, unsig
 //randomly
 //###################################################################################
 double PottsModel::HeatBathLookupZeroTemp(double gamma, double prob, unsigned int max_sweeps) {
-    DLList_Iter<NNode*> iter;
-    DLList_Iter<NLink*> l_iter;
-    DLList_Iter<unsigned int*> i_iter, i_iter2;
-    NNode *node, *n_cur;
-    NLink *l_cur;
-    unsigned int new_spin, spin_opt, old_spin, spin, sweep;
+    unsigned int new_spin, spin_opt, old_spin, spin, sweep, s;
+    unsigned long v, k;
     long r;// degree;
     unsigned long changes;
     double delta = 0, h, deltaE, deltaEmin, w, degree;
     //HugeArray<int> neighbours;
 
+    load_spins();
     sweep = 0;
     changes = 0;
     while (sweep < max_sweeps) {
@@ -484,28 +507,19 @@ double PottsModel::HeatBathLookupZeroTemp(double gamma, double prob, unsigned in
                 r = RNG_INTEGER(0, num_of_nodes - 1);
             }
             /* r=long(double(num_of_nodes*double(rand())/double(RAND_MAX+1.0)));*/
-            node = net->node_list->Get(r);
+            v = r;
             // Wir zaehlen, wieviele Nachbarn von jedem spin vorhanden sind
             // erst mal alles Null setzen
             for (unsigned int i = 0; i <= q; i++) {
                 neighbours[i] = 0;
             }
-            degree = node->Get_Weight();
-            //Loop over all links (=neighbours)
-            l_cur = l_iter.First(node->Get_Links());
-            while (!l_iter.End()) {
-                //printf("%s %s\n",node->Get_Name(),n_cur->Get_Name());
-                w = l_cur->Get_Weight();
-                if (node == l_cur->Get_Start()) {
-                    n_cur = l_cur->Get_End();
-                } else {
-                    n_cur = l_cur->Get_Start();
-                }
-                neighbours[n_cur->Get_ClusterIndex()] += w;
-                l_cur = l_iter.Next();
+            degree = node_weight[v];
+            //Loop over all neighbours
+            for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                neighbours[spins[adj_node[k]]] += adj_weight[k];
             }
             //Search optimal Spin
-            old_spin = node->Get_ClusterIndex();
+            old_spin = spins[v];
             //degree=node->Get_Degree();
             switch (operation_mode) {
             case 0: {
@@ -538,28 +552,22 @@ double PottsModel::HeatBathLookupZeroTemp(double gamma, double prob, unsigned in
             new_spin = spin_opt;
             if (new_spin != old_spin) { // Did we really change something??
                 changes++;
-                node->Set_ClusterIndex(new_spin);
+                set_spin(v, new_spin);
                 color_field[old_spin] -= delta;
                 color_field[new_spin] += delta;
 
                 //Qmatrix update
                 //iteration over all neighbours
-                l_cur = l_iter.First(node->Get_Links());
-                while (!l_iter.End()) {
-                    w = l_cur->Get_Weight();
-                    if (node == l_cur->Get_Start()) {
-                        n_cur = l_cur->Get_End();
-                    } else {
-                        n_cur = l_cur->Get_Start();
-                    }
-                    Qmatrix[old_spin][n_cur->Get_ClusterIndex()] -= w;
-                    Qmatrix[new_spin][n_cur->Get_ClusterIndex()] += w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][old_spin] -= w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][new_spin] += w;
+                for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                    w = adj_weight[k];
+                    s = spins[adj_node[k]];
+                    Qmatrix[old_spin][s] -= w;
+                    Qmatrix[new_spin][s] += w;
+                    Qmatrix[s][old_spin] -= w;
+                    Qmatrix[s][new_spin] += w;
                     Qa[old_spin] -= w;
                     Qa[new_spin] += w;
-                    l_cur = l_iter.Next();
-                }  // while l_iter
+                }  // for k
             }
         } // for n
     }  // while markov
@@ -571,13 +579,8 @@ double PottsModel::HeatBathLookupZeroTemp(double gamma, double prob, unsigned in
 //This function performs a parallel update at Terperature T
 //#####################################################################################
 long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, unsigned int max_sweeps) {
-    DLList_Iter<NNode*> iter, net_iter;
-    DLList_Iter<NLink*> l_iter;
-    DLList_Iter<unsigned int*> i_iter, i_iter2;
-    NNode *node, *n_cur;
-    NLink *l_cur;
-    unsigned int new_spin, spin_opt, old_spin;
-    unsigned int *SPIN, *P_SPIN;
+    unsigned int new_spin, spin_opt, old_spin, s;
+    unsigned long v, k;
     unsigned int sweep;
     long max_q;
     unsigned long changes, /*degree,*/ problemcount;
@@ -586,6 +589,7 @@ long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, un
     bool cyclic = 0, found;
     unsigned long num_of_nodes;
 
+    load_spins();
     sweep = 0;
     changes = 1;
     num_of_nodes = net->node_list->Size();
@@ -594,9 +598,7 @@ long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, un
         sweep++;
         changes = 0;
         //Loop over all nodes
-        node = net_iter.First(net->node_list);
-        SPIN = i_iter.First(new_spins);
-        while (!net_iter.End()) {
+        for (v = 0; v < num_of_nodes; v++) {
             // Initialize neighbours and weights
             problemcount = 0;
             for (unsigned int i = 0; i <= q; i++) {
@@ -604,22 +606,13 @@ long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, un
                 weights[i] = 0;
             }
             norm = 0.0;
-            degree = node->Get_Weight();
-            //Loop over all links (=neighbours)
-            l_cur = l_iter.First(node->Get_Links());
-            while (!l_iter.End()) {
-                //printf("%s %s\n",node->Get_Name(),n_cur->Get_Name());
-                w = l_cur->Get_Weight();
-                if (node == l_cur->Get_Start()) {
-                    n_cur = l_cur->Get_End();
-                } else {
-                    n_cur = l_cur->Get_Start();
-                }
-                neighbours[n_cur->Get_ClusterIndex()] += w;
-                l_cur = l_iter.Next();
+            degree = node_weight[v];
+            //Loop over all neighbours
+            for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                neighbours[spins[adj_node[k]]] += adj_weight[k];
             }
             //Search optimal Spin
-            old_spin = node->Get_ClusterIndex();
+            old_spin = spins[v];
             //degree=node->Get_Degree();
             switch (operation_mode) {
             case 0: {
@@ -674,53 +667,39 @@ long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, un
                 problemcount++;
             }
             //Put new spin on list
-            *SPIN = spin_opt;
+            new_spins[v] = spin_opt;
 
-            node = net_iter.Next();
-            SPIN = i_iter.Next();
-        } // while !net_iter.End()
+        } // for v
 
         //-------------------------------
         //now update all spins
-        node = net_iter.First(net->node_list);
-        SPIN = i_iter.First(new_spins);
-        P_SPIN = i_iter2.First(previous_spins);
-        while (!net_iter.End()) {
-            old_spin = node->Get_ClusterIndex();
-            new_spin = *SPIN;
+        for (v = 0; v < num_of_nodes; v++) {
+            old_spin = spins[v];
+            new_spin = new_spins[v];
             if (new_spin != old_spin) { // Did we really change something??
                 changes++;
-                node->Set_ClusterIndex(new_spin);
-                if (new_spin != *P_SPIN) {
+                set_spin(v, new_spin);
+                if (new_spin != previous_spins[v]) {
                     cyclic = false;
                 }
-                *P_SPIN = old_spin;
+                previous_spins[v] = old_spin;
                 color_field[old_spin] -= delta;
                 color_field[new_spin] += delta;
 
                 //Qmatrix update
                 //iteration over all neighbours
-                l_cur = l_iter.First(node->Get_Links());
-                while (!l_iter.End()) {
-                    w = l_cur->Get_Weight();
-                    if (node == l_cur->Get_Start()) {
-                        n_cur = l_cur->Get_End();
-                    } else {
-                        n_cur = l_cur->Get_Start();
-                    }
-                    Qmatrix[old_spin][n_cur->Get_ClusterIndex()] -= w;
-                    Qmatrix[new_spin][n_cur->Get_ClusterIndex()] += w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][old_spin] -= w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][new_spin] += w;
+                for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                    w = adj_weight[k];
+                    s = spins[adj_node[k]];
+                    Qmatrix[old_spin][s] -= w;
+                    Qmatrix[new_spin][s] += w;
+                    Qmatrix[s][old_spin] -= w;
+                    Qmatrix[s][new_spin] += w;
                     Qa[old_spin] -= w;
                     Qa[new_spin] += w;
-                    l_cur = l_iter.Next();
-                }  // while l_iter
+                }  // for k
             }
-            node = net_iter.Next();
-            SPIN = i_iter.Next();
-            P_SPIN = i_iter2.Next();
-        } // while (!net_iter.End())
+        } // for v
 
     }  // while markov
     max_q = 0;
@@ -743,12 +722,8 @@ long PottsModel::HeatBathParallelLookup(double gamma, double prob, double kT, un
 // as the parallel update has its flaws, due to the cyclic attractors
 //##############################################################
 double PottsModel::HeatBathLookup(double gamma, double prob, double kT, unsigned int max_sweeps) {
-    DLList_Iter<NNode*> iter;
-    DLList_Iter<NLink*> l_iter;
-    DLList_Iter<unsigned int*> i_iter, i_iter2;
-    NNode *node, *n_cur;
-    NLink *l_cur;
-    unsigned int new_spin, spin_opt, old_spin;
+    unsigned int new_spin, spin_opt, old_spin, s;
+    unsigned long v, k;
     unsigned int sweep;
     long max_q, rn;
     unsigned long changes, /*degree,*/ problemcount;
@@ -757,6 +732,7 @@ double PottsModel::HeatBathLookup(double gamma, double prob, double kT, unsigned
     double norm, r, beta, minweight, prefac = 0;
     bool found;
     long int num_of_nodes;
+    load_spins();
     sweep = 0;
     changes = 0;
     num_of_nodes = net->node_list->Size();
@@ -770,7 +746,7 @@ double PottsModel::HeatBathLookup(double gamma, double prob, double kT, unsigned
             }
             /* rn=long(double(num_of_nodes*double(rand())/double(RAND_MAX+1.0))); */
 
-            node = net->node_list->Get(rn);
+            v = rn;
             // initialize the neighbours and the weights
             problemcount = 0;
             for (unsigned int i = 0; i <= q; i++) {
@@ -778,24 +754,15 @@ double PottsModel::HeatBathLookup(double gamma, double prob, double kT, unsigned
                 weights[i] = 0.0;
             }
             norm = 0.0;
-            degree = node->Get_Weight();
-            //Loop over all links (=neighbours)
-            l_cur = l_iter.First(node->Get_Links());
-            while (!l_iter.End()) {
-                //printf("%s %s\n",node->Get_Name(),n_cur->Get_Name());
-                w = l_cur->Get_Weight();
-                if (node == l_cur->Get_Start()) {
-                    n_cur = l_cur->Get_End();
-                } else {
-                    n_cur = l_cur->Get_Start();
-                }
-                neighbours[n_cur->Get_ClusterIndex()] += w;
-                l_cur = l_iter.Next();
+            degree = node_weight[v];
+            //Loop over all neighbours
+            for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                neighbours[spins[adj_node[k]]] += adj_weight[k];
             }
 
             //Look for optimal spin
 
-            old_spin = node->Get_ClusterIndex();
+            old_spin = spins[v];
             //degree=node->Get_Degree();
             switch (operation_mode) {
             case 0: {
@@ -855,28 +822,22 @@ double PottsModel::HeatBathLookup(double gamma, double prob, double kT, unsigned
             new_spin = spin_opt;
             if (new_spin != old_spin) { // Did we really change something??
                 changes++;
-                node->Set_ClusterIndex(new_spin);
+                set_spin(v, new_spin);
                 color_field[old_spin] -= delta;
                 color_field[new_spin] += delta;
 
                 //Qmatrix update
                 //iteration over all neighbours
-                l_cur = l_iter.First(node->Get_Links());
-                while (!l_iter.End()) {
-                    w = l_cur->Get_Weight();
-                    if (node == l_cur->Get_Start()) {
-                        n_cur = l_cur->Get_End();
-                    } else {
-                        n_cur = l_cur->Get_Start();
-                    }
-                    Qmatrix[old_spin][n_cur->Get_ClusterIndex()] -= w;
-                    Qmatrix[new_spin][n_cur->Get_ClusterIndex()] += w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][old_spin] -= w;
-                    Qmatrix[n_cur->Get_ClusterIndex()][new_spin] += w;
+                for (k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                    w = adj_weight[k];
+                    s = spins[adj_node[k]];
+                    Qmatrix[old_spin][s] -= w;
+                    Qmatrix[new_spin][s] += w;
+                    Qmatrix[s][old_spin] -= w;
+                    Qmatrix[s][new_spin] += w;
                     Qa[old_spin] -= w;
                     Qa[new_spin] += w;
-                    l_cur = l_iter.Next();
-                }  // while l_iter
+                }  // for k
             }
         } // for n
     }  // while markov
@@ -1151,14 +1112,15 @@ long PottsModel::WriteClusters(igraph_real_t *modularity,
                                igraph_vector_t *csize,
                                igraph_vector_t *membership,
                                double kT, double gamma) {
-    NNode *n_cur, *n_cur2;
+    NNode *n_cur;
     /*
     double a1,a2,a3,p,p1,p2;
     long n,N,lin,lout;
     */
-    DLList_Iter<NNode*> iter, iter2;
-    HugeArray<int> inner_links;
-    HugeArray<int> outer_links;
+    DLList_Iter<NNode*> iter;
+    // link weights, so that the modularity of a weighted network is normalized by its total weight
+    HugeArray<double> inner_links;
+    HugeArray<double> outer_links;
     HugeArray<int> nodes;
 
     //den Header schreiben
@@ -1181,21 +1143,17 @@ long PottsModel::WriteClusters(igraph_real_t *modularity,
             inner_links[spin] = 0;
             outer_links[spin] = 0;
             nodes[spin] = 0;
-            n_cur = iter.First(net->node_list);
-            while (!iter.End()) {
-                if (n_cur->Get_ClusterIndex() == spin) {
+            for (unsigned long v = 0; v < num_of_nodes; v++) {
+                if (node_ptr[v]->Get_ClusterIndex() == spin) {
                     nodes[spin]++;
-                    n_cur2 = iter2.First(n_cur->Get_Neighbours());
-                    while (!iter2.End()) {
-                        if (n_cur2->Get_ClusterIndex() == spin) {
-                            inner_links[spin]++;
+                    for (unsigned long k = adj_start[v]; k < adj_start[v + 1]; k++) {
+                        if (node_ptr[adj_node[k]]->Get_ClusterIndex() == spin) {
+                            inner_links[spin] += adj_weight[k];
                         } else {
-                            outer_links[spin]++;
+                            outer_links[spin] += adj_weight[k];
                         }
-                        n_cur2 = iter2.Next();
                     }
                 }
-                n_cur = iter.Next();
             }
         }
     }
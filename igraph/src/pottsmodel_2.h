@@ -57,8 +57,16 @@ class PottsModel {
 private:
     //  HugeArray<double> neg_gammalookup;
     //  HugeArray<double> pos_gammalookup;
-    DL_Indexed_List<unsigned int*> *new_spins;
-    DL_Indexed_List<unsigned int*> *previous_spins;
+    unsigned int *new_spins;
+    unsigned int *previous_spins;
+    // Read-only copy of the network in adjacency arrays, indexed by
+    // node index, and the spin of each node, used by the heat bath
+    NNode **node_ptr;
+    unsigned long *adj_start;
+    unsigned int *adj_node;
+    double *adj_weight;
+    double *node_weight;
+    unsigned int *spins;
     HugeArray<HugeArray<double>*> correlation;
     network *net;
     unsigned int q;
@@ -74,6 +82,11 @@ private:
     double energy;
     double acceptance;
     double *neighbours;
+    void load_spins(void);
+    void set_spin(unsigned long i, unsigned int s) {
+        spins[i] = s;
+        node_ptr[i]->Set_ClusterIndex(s);
+    }
 public:
     PottsModel(network *net, unsigned int q, int norm_by_degree);
     ~PottsModel();
@@ -92,6 +105,7 @@ public:
     double GammaSweepZeroTemp(double gamma_start, double gamma_stop, double prob, unsigned int steps, bool non_parallel = true, int repetitions = 1);
     long   WriteCorrelationMatrix(char *filename);
     double calculate_energy(double gamma);
+    double calculate_hamiltonian(double gamma, double prob);
     long   WriteClusters(igraph_real_t *modularity,
                          igraph_real_t *temperature,
                          igraph_vector_t *csize, igraph_vector_t *membership,
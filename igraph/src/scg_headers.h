@@ -104,6 +104,9 @@ int igraph_i_optimal_partition(const igraph_real_t *v, int *gr, int n, int nt,
 int igraph_i_kmeans_Lloyd(const igraph_vector_t *x, int n,
                           int p, igraph_vector_t *centers,
                           int k, int *cl, int maxiter);
+int igraph_i_kmeans_plusplus(const igraph_vector_t *x, int n,
+                             int p, igraph_vector_t *centers,
+                             int k, int *cl, int maxiter);
 
 /*-------------------------------------------------
 ------------DEFINED IN scg_exact_scg.c-------------
@@ -29,47 +29,93 @@
  *    The group label to which each object belongs is stored in 'cl'.
  *    Labels are positive consecutive integers starting from 0.
  *    See also Section 5.3.3 of the above reference.
+ *
+ *    igraph_i_kmeans_plusplus chooses the initial centers by k-means++
+ *    and then runs the same iterations with zero based labels.
  */
 
 #include "igraph_memory.h"
+#include "igraph_random.h"
 
 #include "scg_headers.h"
 
+/* Points are processed in blocks of this many for the distances */
+#define KMEANS_BLOCK 64
+
+/* Squared distances of the points i0, ..., i0 + len - 1 to the k centers,
+   the distance of point i0 + i to center j goes to dist[j * len + i]. Every
+   distance is summed over the coordinates in order; the innermost loop
+   goes over consecutive points of a coordinate, so it vectorizes. */
+static void igraph_i_kmeans_distances(const igraph_real_t *x, int n, int p,
+                                      const igraph_real_t *cen, int k,
+                                      int i0, int len, igraph_real_t *dist) {
+    int i, j, c;
+
+    for (i = 0; i < k * len; i++) {
+        dist[i] = 0.0;
+    }
+    for (c = 0; c < p; c++) {
+        const igraph_real_t *xc = x + i0 + (long int) n * c;
+        for (j = 0; j < k; j++) {
+            igraph_real_t cv = cen[j + k * c];
+            igraph_real_t *dj = dist + j * len;
+            for (i = 0; i < len; i++) {
+                igraph_real_t tmp = xc[i] - cv;
+                dj[i] += tmp * tmp;
+            }
+        }
+    }
+}
+
+/* Assigns every point to its nearest center, 'offset' is added to the
+   center index. Returns whether any label changed. */
+static int igraph_i_kmeans_assign(const igraph_vector_t *x, int n, int p,
+                                  const igraph_vector_t *cen, int k, int *cl,
+                                  int offset, igraph_real_t *dist) {
+    int i0, i, j, len, inew = 0;
+    int updated = 0;
+    igraph_real_t best;
+
+    for (i0 = 0; i0 < n; i0 += KMEANS_BLOCK) {
+        len = n - i0 < KMEANS_BLOCK ? n - i0 : KMEANS_BLOCK;
+        igraph_i_kmeans_distances(VECTOR(*x), n, p, VECTOR(*cen), k, i0, len,
+                                  dist);
+        for (i = 0; i < len; i++) {
+            /* find nearest centre for each point */
+            best = IGRAPH_INFINITY;
+            for (j = 0; j < k; j++) {
+                if (dist[j * len + i] < best) {
+                    best = dist[j * len + i];
+                    inew = j + offset;
+                }
+            }
+            if (cl[i0 + i] != inew) {
+                updated = 1;
+                cl[i0 + i] = inew;
+            }
+        }
+    }
+
+    return updated;
+}
+
 int igraph_i_kmeans_Lloyd(const igraph_vector_t *x, int n, int p,
                           igraph_vector_t *cen, int k, int *cl, int maxiter) {
 
-    int iter, i, j, c, it, inew = 0;
-    igraph_real_t best, dd, tmp;
+    int iter, i, j, c, it;
     int updated;
     igraph_vector_int_t nc;
+    igraph_vector_t dist;
 
     IGRAPH_CHECK(igraph_vector_int_init(&nc, k));
     IGRAPH_FINALLY(igraph_vector_int_destroy, &nc);
+    IGRAPH_VECTOR_INIT_FINALLY(&dist, k * KMEANS_BLOCK);
 
     for (i = 0; i < n; i++) {
         cl[i] = -1;
     }
     for (iter = 0; iter < maxiter; iter++) {
-        updated = 0;
-        for (i = 0; i < n; i++) {
-            /* find nearest centre for each point */
-            best = IGRAPH_INFINITY;
-            for (j = 0; j < k; j++) {
-                dd = 0.0;
-                for (c = 0; c < p; c++) {
-                    tmp = VECTOR(*x)[i + n * c] - VECTOR(*cen)[j + k * c];
-                    dd += tmp * tmp;
-                }
-                if (dd < best) {
-                    best = dd;
-                    inew = j + 1;
-                }
-            }
-            if (cl[i] != inew) {
-                updated = 1;
-                cl[i] = inew;
-            }
-        }
+        updated = igraph_i_kmeans_assign(x, n, p, cen, k, cl, 1, VECTOR(dist));
         if (!updated) {
             break;
         }
@@ -92,8 +138,9 @@ int igraph_i_kmeans_Lloyd(const igraph_vector_t *x, int n, int p,
             VECTOR(*cen)[j] /= VECTOR(nc)[j % k];
         }
     }
+    igraph_vector_destroy(&dist);
     igraph_vector_int_destroy(&nc);
-    IGRAPH_FINALLY_CLEAN(1);
+    IGRAPH_FINALLY_CLEAN(2);
 
     /* convervenge check */
     if (iter >= maxiter - 1) {
@@ -103,3 +150,109 @@ int igraph_i_kmeans_Lloyd(const igraph_vector_t *x, int n, int p,
     return 0;
 }
 
+/* k-means of the n points of 'x' (stored as in igraph_i_kmeans_Lloyd) with
+   k-means++ initial centers: the first one is a random point, every next one
+   a point drawn with probability proportional to its squared distance to the
+   nearest center so far. Labels in 'cl' start from 0, 'cen' is resized to
+   the k * p final centers. A center losing all of its points stays where it
+   is. Stops after 'maxiter' iterations without an error. */
+int igraph_i_kmeans_plusplus(const igraph_vector_t *x, int n, int p,
+                             igraph_vector_t *cen, int k, int *cl,
+                             int maxiter) {
+
+    int iter, i, j, c, i0, len;
+    igraph_vector_int_t nc;
+    igraph_vector_t dist, mindist, center;
+    igraph_real_t total, r;
+
+    if (k < 1 || k > n) {
+        IGRAPH_ERROR("Invalid number of clusters for k-means", IGRAPH_EINVAL);
+    }
+
+    IGRAPH_CHECK(igraph_vector_resize(cen, k * p));
+    IGRAPH_CHECK(igraph_vector_int_init(&nc, k));
+    IGRAPH_FINALLY(igraph_vector_int_destroy, &nc);
+    IGRAPH_VECTOR_INIT_FINALLY(&dist, k * KMEANS_BLOCK);
+    IGRAPH_VECTOR_INIT_FINALLY(&mindist, n);
+    IGRAPH_VECTOR_INIT_FINALLY(&center, p);
+    igraph_vector_fill(&mindist, IGRAPH_INFINITY);
+
+    RNG_BEGIN();
+
+    for (j = 0; j < k; j++) {
+        /* choose the next center */
+        if (j == 0) {
+            i = RNG_INTEGER(0, n - 1);
+        } else {
+            total = igraph_vector_sum(&mindist);
+            if (total > 0) {
+                r = RNG_UNIF(0, total);
+                for (i = 0; i < n - 1 && r >= VECTOR(mindist)[i]; i++) {
+                    r -= VECTOR(mindist)[i];
+                }
+                /* rounding may end the walk on a point that is a center */
+                while (i > 0 && VECTOR(mindist)[i] == 0) {
+                    i--;
+                }
+            } else {
+                i = RNG_INTEGER(0, n - 1);
+            }
+        }
+        for (c = 0; c < p; c++) {
+            VECTOR(center)[c] = VECTOR(*x)[i + n * c];
+            VECTOR(*cen)[j + k * c] = VECTOR(center)[c];
+        }
+
+        /* squared distances to the nearest center */
+        for (i0 = 0; i0 < n; i0 += KMEANS_BLOCK) {
+            len = n - i0 < KMEANS_BLOCK ? n - i0 : KMEANS_BLOCK;
+            igraph_i_kmeans_distances(VECTOR(*x), n, p, VECTOR(center), 1,
+                                      i0, len, VECTOR(dist));
+            for (i = 0; i < len; i++) {
+                if (VECTOR(dist)[i] < VECTOR(mindist)[i0 + i]) {
+                    VECTOR(mindist)[i0 + i] = VECTOR(dist)[i];
+                }
+            }
+        }
+    }
+
+    RNG_END();
+
+    for (i = 0; i < n; i++) {
+        cl[i] = -1;
+    }
+    for (iter = 0; iter < maxiter; iter++) {
+        if (!igraph_i_kmeans_assign(x, n, p, cen, k, cl, 0, VECTOR(dist))) {
+            break;
+        }
+
+        /* update each centre, an empty one keeps its position */
+        igraph_vector_int_null(&nc);
+        for (i = 0; i < n; i++) {
+            VECTOR(nc)[cl[i]]++;
+        }
+        for (j = 0; j < k * p; j++) {
+            if (VECTOR(nc)[j % k] > 0) {
+                VECTOR(*cen)[j] = 0.0;
+            }
+        }
+        for (i = 0; i < n; i++) {
+            for (c = 0; c < p; c++) {
+                VECTOR(*cen)[cl[i] + c * k] += VECTOR(*x)[i + c * n];
+            }
+        }
+        for (j = 0; j < k * p; j++) {
+            if (VECTOR(nc)[j % k] > 0) {
+                VECTOR(*cen)[j] /= VECTOR(nc)[j % k];
+            }
+        }
+    }
+
+    igraph_vector_destroy(&center);
+    igraph_vector_destroy(&mindist);
+    igraph_vector_destroy(&dist);
+    igraph_vector_int_destroy(&nc);
+    IGRAPH_FINALLY_CLEAN(4);
+
+    return 0;
+}
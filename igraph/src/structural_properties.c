@@ -249,7 +249,7 @@ int igraph_average_path_length(const igraph_t *graph, igraph_real_t *res,
     if (already_added == 0) {
         IGRAPH_ERROR("average path length failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, already_added); /* TODO: hack */
+    IGRAPH_FINALLY(igraph_free, already_added); /* TODO: hack */
     IGRAPH_DQUEUE_INIT_FINALLY(&q, 100);
 
     igraph_adjlist_init(graph, &allneis, dirmode);
@@ -509,7 +509,7 @@ int igraph_shortest_paths(const igraph_t *graph, igraph_matrix_t *res,
     if (already_counted == 0) {
         IGRAPH_ERROR("shortest paths failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, already_counted);
+    IGRAPH_FINALLY(igraph_free, already_counted);
     IGRAPH_DQUEUE_INIT_FINALLY(&q, 100);
 
     if ( (all_to = igraph_vs_is_all(&to)) ) {
@@ -1289,7 +1289,7 @@ int igraph_subcomponent(const igraph_t *graph, igraph_vector_t *res, igraph_real
     if (already_added == 0) {
         IGRAPH_ERROR("subcomponent failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, already_added); /* TODO: hack */
+    IGRAPH_FINALLY(igraph_free, already_added); /* TODO: hack */
 
     igraph_vector_clear(res);
 
@@ -1811,7 +1811,7 @@ int igraph_i_subgraph_copy_and_delete(const igraph_t *graph, igraph_t *res,
     if (remain == 0) {
         IGRAPH_ERROR("subgraph failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, remain); /* TODO: hack */
+    IGRAPH_FINALLY(igraph_free, remain); /* TODO: hack */
     IGRAPH_CHECK(igraph_vector_reserve(&delete, no_of_nodes - IGRAPH_VIT_SIZE(vit)));
 
     for (IGRAPH_VIT_RESET(vit); !IGRAPH_VIT_END(vit); IGRAPH_VIT_NEXT(vit)) {
@@ -2190,8 +2190,8 @@ int igraph_subgraph_edges(const igraph_t *graph, igraph_t *res,
     if (eremain == 0) {
         IGRAPH_ERROR("subgraph_edges failed", IGRAPH_ENOMEM);
     }
-    IGRAPH_FINALLY(free, vremain);    /* TODO: hack */
-    IGRAPH_FINALLY(free, eremain);    /* TODO: hack */
+    IGRAPH_FINALLY(igraph_free, vremain);    /* TODO: hack */
+    IGRAPH_FINALLY(igraph_free, eremain);    /* TODO: hack */
     IGRAPH_CHECK(igraph_vector_reserve(&delete, no_of_edges - IGRAPH_EIT_SIZE(eit)));
 
     /* Collect the vertex and edge IDs that will remain */
@@ -5318,7 +5318,7 @@ int igraph_get_all_shortest_paths_dijkstra(const igraph_t *graph,
                 j++;
             } else {
                 /* we don't need this path, free it */
-                igraph_vector_destroy(path); free(path);
+                igraph_vector_destroy(path); igraph_Free(path);
             }
         }
         IGRAPH_CHECK(igraph_vector_ptr_resize(res, j));
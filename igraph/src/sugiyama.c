@@ -765,7 +765,7 @@ static int igraph_i_layout_sugiyama_order_nodes_horizontally(const igraph_t* gra
         for (i = 0; i < no_of_vertices; i++) {
             MATRIX(*layout, i, 0) = xs[(long int)MATRIX(*layout, i, 1)]++;
         }
-        free(xs);
+        igraph_Free(xs);
     }
 
     IGRAPH_VECTOR_INIT_FINALLY(&barycenters, 0);
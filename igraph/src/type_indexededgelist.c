@@ -32,6 +32,8 @@
 
 int igraph_i_create_start(igraph_vector_t *res, igraph_vector_t *el, igraph_vector_t *index,
                           igraph_integer_t nodes);
+static int igraph_i_create_index(const igraph_vector_t *from, const igraph_vector_t *to,
+                                 igraph_vector_t *oi, igraph_vector_t *ii, long int nodes);
 
 /**
  * \section about_basic_interface
@@ -295,15 +297,14 @@ int igraph_add_edges(igraph_t *graph, const igraph_vector_t *edges,
         igraph_set_error_handler(oldhandler);
         IGRAPH_ERROR("cannot add edges", IGRAPH_ERROR_SELECT_2(ret1, ret2));
     }
-    ret1 = igraph_vector_order(&graph->from, &graph->to, &newoi, graph->n);
-    ret2 = igraph_vector_order(&graph->to, &graph->from, &newii, graph->n);
-    if (ret1 != 0 || ret2 != 0) {
+    ret1 = igraph_i_create_index(&graph->from, &graph->to, &newoi, &newii, graph->n);
+    if (ret1 != 0) {
         igraph_vector_resize(&graph->from, no_of_edges);
         igraph_vector_resize(&graph->to, no_of_edges);
         igraph_vector_destroy(&newoi);
         igraph_vector_destroy(&newii);
         igraph_set_error_handler(oldhandler);
-        IGRAPH_ERROR("cannot add edges", IGRAPH_ERROR_SELECT_2(ret1, ret2));
+        IGRAPH_ERROR("cannot add edges", ret1);
     }
 
     /* Attributes */
@@ -458,8 +459,7 @@ int igraph_delete_edges(igraph_t *graph, igraph_es_t edges) {
 
     /* Create index, this might require additional memory */
     IGRAPH_VECTOR_INIT_FINALLY(&newoi, remaining_edges);
-    IGRAPH_CHECK(igraph_vector_order(&newfrom, &newto, &newoi, no_of_nodes));
-    IGRAPH_CHECK(igraph_vector_order(&newto, &newfrom, &graph->ii, no_of_nodes));
+    IGRAPH_CHECK(igraph_i_create_index(&newfrom, &newto, &newoi, &graph->ii, no_of_nodes));
 
     /* Edge attributes, we need an index that gives the ids of the
        original edges for every new edge.
@@ -607,10 +607,8 @@ int igraph_delete_vertices_idx(igraph_t *graph, const igraph_vs_t vertices,
         }
     }
     /* update oi & ii */
-    IGRAPH_CHECK(igraph_vector_order(&newgraph.from, &newgraph.to, &newgraph.oi,
-                                     remaining_vertices));
-    IGRAPH_CHECK(igraph_vector_order(&newgraph.to, &newgraph.from, &newgraph.ii,
-                                     remaining_vertices));
+    IGRAPH_CHECK(igraph_i_create_index(&newgraph.from, &newgraph.to, &newgraph.oi,
+                                       &newgraph.ii, remaining_vertices));
 
     IGRAPH_CHECK(igraph_i_create_start(&newgraph.os, &newgraph.from,
                                        &newgraph.oi, (igraph_integer_t)
@@ -824,6 +822,86 @@ int igraph_neighbors(const igraph_t *graph, igraph_vector_t *neis, igraph_intege
     return 0;
 }
 
+/* Start of every key in an order by `key`, stored to start[0..nodes] */
+static void igraph_i_create_index_starts(const int *key, int *start,
+                                         long int edges, long int nodes) {
+    long int i;
+
+    memset(start, 0, sizeof(int) * (size_t) (nodes + 1));
+    for (i = 0; i < edges; i++) {
+        start[key[i] + 1]++;
+    }
+    for (i = 0; i < nodes; i++) {
+        start[i + 1] += start[i];
+    }
+}
+
+/* Orders the edges by `key`, then by `key2` with two counting sort passes */
+static void igraph_i_create_index_order(const int *key, const int *key2, int *tmp,
+                                        int *start, igraph_vector_t *res,
+                                        long int edges, long int nodes) {
+    long int i;
+
+    igraph_i_create_index_starts(key2, start, edges, nodes);
+    for (i = edges - 1; i >= 0; i--) {
+        tmp[start[key2[i]]++] = (int) i;
+    }
+
+    igraph_i_create_index_starts(key, start, edges, nodes);
+    for (i = 0; i < edges; i++) {
+        int edge = tmp[i];
+        VECTOR(*res)[start[key[edge]]++] = edge;
+    }
+}
+
+/**
+ * \ingroup internal
+ *
+ * Computes the oi and ii indices of an edge list. It gives the same
+ * result as igraph_vector_order() on from/to and on to/from, edges
+ * with both endpoints equal are in decreasing id order, but the
+ * endpoints are converted to int keys once and sorted with counting
+ * sort passes over flat int arrays.
+ */
+
+static int igraph_i_create_index(const igraph_vector_t *from, const igraph_vector_t *to,
+                                 igraph_vector_t *oi, igraph_vector_t *ii, long int nodes) {
+    long int edges = igraph_vector_size(from);
+    int *keys, *start;
+    long int i;
+
+    IGRAPH_CHECK(igraph_vector_resize(oi, edges));
+    IGRAPH_CHECK(igraph_vector_resize(ii, edges));
+
+    /* from keys, to keys and the order by the secondary key */
+    keys = igraph_Calloc(3 * edges + 1, int);
+    if (keys == 0) {
+        IGRAPH_ERROR("Cannot create edge index", IGRAPH_ENOMEM);
+    }
+    IGRAPH_FINALLY(igraph_free, keys);
+    start = igraph_Calloc(nodes + 1, int);
+    if (start == 0) {
+        IGRAPH_ERROR("Cannot create edge index", IGRAPH_ENOMEM);
+    }
+    IGRAPH_FINALLY(igraph_free, start);
+
+    for (i = 0; i < edges; i++) {
+        keys[i] = (int) VECTOR(*from)[i];
+        keys[edges + i] = (int) VECTOR(*to)[i];
+    }
+
+    igraph_i_create_index_order(keys, keys + edges, keys + 2 * edges, start,
+                                oi, edges, nodes);
+    igraph_i_create_index_order(keys + edges, keys, keys + 2 * edges, start,
+                                ii, edges, nodes);
+
+    igraph_Free(start);
+    igraph_Free(keys);
+    IGRAPH_FINALLY_CLEAN(2);
+
+    return 0;
+}
+
 /**
  * \ingroup internal
  *
@@ -60,6 +60,7 @@
 #include <algorithm>
 
 #include "config.h"
+#include "igraph_simd_internal.h"
 
 namespace igraph {
 
@@ -318,45 +319,33 @@ double Probabilities::compute_distance(const Probabilities* P2) const {
                 j++;
             }
             if (i == size) {
-                for (; j < P2->size; j++) {
-                    r += P2->P[j] * P2->P[j];
-                }
+                r = igraph_i_add_squared_distance_float(r, P2->P + j, 0, P2->size - j);
             } else {
-                for (; i < size; i++) {
-                    r += P[i] * P[i];
-                }
+                r = igraph_i_add_squared_distance_float(r, P + i, 0, size - i);
             }
         } else { // P1 partial vector, P2 full vector
 
             int i = 0;
             for (int j = 0; j < size; j++) {
-                for (; i < vertices[j]; i++) {
-                    r += P2->P[i] * P2->P[i];
-                }
+                r = igraph_i_add_squared_distance_float(r, P2->P + i, 0, vertices[j] - i);
+                i = vertices[j];
                 r += (P[j] - P2->P[i]) * (P[j] - P2->P[i]);
                 i++;
             }
-            for (; i < P2->size; i++) {
-                r += P2->P[i] * P2->P[i];
-            }
+            r = igraph_i_add_squared_distance_float(r, P2->P + i, 0, P2->size - i);
         }
     } else {
         if (P2->vertices) { // P1 full vector, P2 partial vector
             int i = 0;
             for (int j = 0; j < P2->size; j++) {
-                for (; i < P2->vertices[j]; i++) {
-                    r += P[i] * P[i];
-                }
+                r = igraph_i_add_squared_distance_float(r, P + i, 0, P2->vertices[j] - i);
+                i = P2->vertices[j];
                 r += (P[i] - P2->P[j]) * (P[i] - P2->P[j]);
                 i++;
             }
-            for (; i < size; i++) {
-                r += P[i] * P[i];
-            }
+            r = igraph_i_add_squared_distance_float(r, P + i, 0, size - i);
         } else { // two full vectors
-            for (int i = 0; i < size; i++) {
-                r += (P[i] - P2->P[i]) * (P[i] - P2->P[i]);
-            }
+            r = igraph_i_add_squared_distance_float(r, P, P2->P, size);
         }
     }
     return r;
@@ -1,3 +1,5 @@
+const { BINARY_GRAPH_HEADER_SIZE, writeBinaryGraph, readBinaryGraphHeader, binaryChunks } = require('./binary-graph');
+
 const IGRAPH_ALGORITHM_NAMES = [
     'edgeBetweenness',
     'fastGreedy',
@@ -8,7 +10,10 @@ const IGRAPH_ALGORITHM_NAMES = [
     'leiden',
     'optimal',
     'spinglass',
-    'walktrap'
+    'walktrap',
+    'fluidCommunities',
+    'hrg',
+    'spectral'
 ];
 
 const SEED_ALGORITHM_NAMES = [
@@ -22,120 +27,441 @@ const ALL_ALGORITHM_NAMES = [
     ...SEED_ALGORITHM_NAMES
 ];
 
+const GENERATOR_NAMES = [
+    'sbm',
+    'staticPowerLaw',
+    'barabasi'
+];
+
 const COMPARE_COMMUNITIES_METHODS = {
     NMI: 'NMI',
     RI: 'RI',
     ARI: 'ARI'
 };
 
-let publicAPI = null;
+const SCORE_METRIC_NAMES = [
+    'modularity',
+    'coverage',
+    'conductance',
+    'edgeCounts',
+    'density'
+];
+
+// Randomized algorithms a consensus can be built from
+const CONSENSUS_ALGORITHM_NAMES = [
+    'infomap',
+    'labelPropagation',
+    'louvain',
+    'leiden'
+];
+
+// Algorithms taking the `edgeWeights` option
+const WEIGHTED_ALGORITHM_NAMES = [
+    'fastGreedy',
+    'infomap',
+    'labelPropagation',
+    'leadingEigenvector',
+    'louvain',
+    'leiden',
+    'optimal',
+    'spinglass',
+    'walktrap',
+    'louvainSeed'
+];
 
-const getAPI = ({ wasm = true, onLoad = () => {} } = {}) =>
+// Algorithms of a dynamic graph session, the order is the mode number of the C side
+const SESSION_MODE_NAMES = [
+    'modularity',
+    'labelPropagation'
+];
+
+const SWEEP_OBJECTIVE_NAMES = [
+    'modularity',
+    'cpm'
+];
+
+const BACKEND_NAMES = [
+    'wasm-simd',
+    'wasm',
+    'asm',
+    'native'
+];
+
+// Smallest module using a SIMD instruction, it validates only where Wasm SIMD is supported
+const SIMD_TEST_MODULE = new Uint8Array([
+    0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+]);
+
+const publicAPIs = {};
+
+// @backend: 'wasm', 'wasm-simd', 'asm' or 'native'; the older `wasm` flag picks between 'wasm' and 'asm'
+const getAPI = ({ wasm = true, backend = wasm ? 'wasm' : 'asm', onLoad = () => {} } = {}) =>
     new Promise(((resolve, reject) => {
-        if (publicAPI) {
-            resolve(publicAPI);
-            onLoad(publicAPI)
+        if (!BACKEND_NAMES.includes(backend)) {
+            reject(new Error(`Unknown backend: '${backend}'. Possible options are: ${BACKEND_NAMES}`));
+            return;
+        }
+
+        const loadedBackend = backend === 'wasm-simd' && !isSimdAvailable() ? 'wasm' : backend;
+
+        if (publicAPIs[loadedBackend]) {
+            resolve(publicAPIs[loadedBackend]);
+            onLoad(publicAPIs[loadedBackend])
         } else {
             loadPublicAPI((api) => {
-                publicAPI = api;
+                publicAPIs[loadedBackend] = api;
                 resolve(api);
                 onLoad(api)
-            }, wasm)
+            }, loadedBackend)
         }
     }));
 
-function loadPublicAPI(onLoaded, wasm) {
-    const Module = wasm ? require('./dist/wasm/community-detection.js') : require('./dist/asm/community-detection.js');
+// The SIMD build is not shipped, it is used only when it was built with `./build.sh --simd` and the engine supports it
+function isSimdAvailable() {
+    try {
+        require.resolve('./dist/wasm-simd/community-detection.js');
+        return typeof WebAssembly === 'object' && WebAssembly.validate(SIMD_TEST_MODULE);
+    } catch (e) {
+        return false;
+    }
+}
+
+// Calls onLoaded with the module functions and accessors of its memory
+function loadModule(onLoaded, backend) {
+    if (backend === 'native') {
+        const addon = require('./dist/native/community-detection.node');
+        onLoaded({
+            cwrap: (name) => addon[name],
+            hasFunction: (name) => typeof addon[name] === 'function',
+            writeData: addon.writeBuffer,
+            writeBytes: addon.writeBytes,
+            readData: addon.readBuffer,
+            // Peak resident set size of the process, the native heap is not separate from it
+            getHeapSize: () => process.resourceUsage().maxRSS * 1024
+        });
+        return;
+    }
+
+    let Module;
+    if (backend === 'wasm-simd') {
+        Module = require('./dist/wasm-simd/community-detection.js');
+    } else if (backend === 'wasm') {
+        Module = require('./dist/wasm/community-detection.js');
+    } else {
+        Module = require('./dist/asm/community-detection.js');
+    }
+
+    Module.onRuntimeInitialized = () => onLoaded({
+        cwrap: Module.cwrap,
+        // cwrap of a function missing from the build fails only when it is called
+        hasFunction: (name) => typeof Module['_' + name] === 'function',
+        writeData: (pointer, data) => Module.HEAP8.set(new Uint8Array(data.buffer), pointer),
+        writeBytes: (pointer, bytes) => Module.HEAP8.set(new Int8Array(bytes.buffer, bytes.byteOffset, bytes.length), pointer),
+        readData: (pointer, size) => new Float64Array(new Float64Array(Module.HEAP8.buffer, pointer, size)),
+        // Size of the module memory; it never shrinks, so it is the peak usage so far
+        getHeapSize: () => Module.HEAP8.buffer.byteLength
+    });
+}
 
-    Module.onRuntimeInitialized = () => {
+function loadPublicAPI(onLoaded, backend) {
+    loadModule(({ cwrap, hasFunction, writeData, writeBytes, readData, getHeapSize }) => {
         const api = {
             // Main algorithms API
-            edgeBetweenness: Module.cwrap('edgeBetweenness', 'number', ['number', 'number', 'number']),
-            fastGreedy: Module.cwrap('fastGreedy', 'number', ['number', 'number', 'number']),
-            infomap: Module.cwrap('infomap', 'number', ['number', 'number', 'number']),
-            labelPropagation: Module.cwrap('labelPropagation', 'number', ['number', 'number', 'number']),
-            leadingEigenvector: Module.cwrap('leadingEigenvector', 'number', ['number', 'number', 'number']),
-            louvain: Module.cwrap('louvain', 'number', ['number', 'number', 'number']),
-            leiden: Module.cwrap('leiden', 'number', ['number', 'number', 'number']),
-            optimal: Module.cwrap('optimal', 'number', ['number', 'number', 'number']),
-            spinglass: Module.cwrap('spinglass', 'number', ['number', 'number', 'number']),
-            walktrap: Module.cwrap('walktrap', 'number', ['number', 'number', 'number']),
+            edgeBetweenness: cwrap('edgeBetweenness', 'number', ['number', 'number', 'number']),
+            fastGreedy: cwrap('fastGreedy', 'number', ['number', 'number', 'number']),
+            infomap: cwrap('infomap', 'number', ['number', 'number', 'number']),
+            labelPropagation: cwrap('labelPropagation', 'number', ['number', 'number', 'number', 'number']),
+            leadingEigenvector: cwrap('leadingEigenvector', 'number', ['number', 'number', 'number', 'number', 'number']),
+            louvain: cwrap('louvain', 'number', ['number', 'number', 'number']),
+            leiden: cwrap('leiden', 'number', ['number', 'number', 'number']),
+            optimal: cwrap('optimal', 'number', ['number', 'number', 'number']),
+            spinglass: cwrap('spinglass', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            walktrap: cwrap('walktrap', 'number', ['number', 'number', 'number']),
+            fluidCommunities: cwrap('fluidCommunities', 'number', ['number', 'number', 'number', 'number', 'number', 'number']),
+            hrg: cwrap('hrg', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            spectral: cwrap('spectral', 'number', ['number', 'number', 'number', 'number', 'number', 'number']),
 
             // Seed algorithms API
-            fastGreedySeed: Module.cwrap('fastGreedySeed', 'number', ['number', 'number', 'number', 'number']),
-            louvainSeed: Module.cwrap('louvainSeed', 'number', ['number', 'number', 'number', 'number']),
-            edgeBetweennessSeed: Module.cwrap('edgeBetweennessSeed', 'number', ['number', 'number', 'number', 'number']),
+            fastGreedySeed: cwrap('fastGreedySeed', 'number', ['number', 'number', 'number', 'number']),
+            louvainSeed: cwrap('louvainSeed', 'number', ['number', 'number', 'number', 'number']),
+            edgeBetweennessSeed: cwrap('edgeBetweennessSeed', 'number', ['number', 'number', 'number', 'number']),
 
             // Compare communities API
-            compareCommunitiesNMI: Module.cwrap('compareCommunitiesNMI', 'number', ['number', 'number', 'number']),
-            compareCommunitiesRI: Module.cwrap('compareCommunitiesRI', 'number', ['number', 'number', 'number']),
-            compareCommunitiesARI: Module.cwrap('compareCommunitiesARI', 'number', ['number', 'number', 'number']),
+            compareCommunitiesNMI: cwrap('compareCommunitiesNMI', 'number', ['number', 'number', 'number']),
+            compareCommunitiesRI: cwrap('compareCommunitiesRI', 'number', ['number', 'number', 'number']),
+            compareCommunitiesARI: cwrap('compareCommunitiesARI', 'number', ['number', 'number', 'number']),
+
+            // Partition quality API
+            scoreMembership: cwrap('scoreMembership', 'number', ['number', 'number', 'number', 'number', 'number', 'number']),
+            cliquePercolation: cwrap('cliquePercolation', 'number', ['number', 'number', 'number', 'number']),
+            consensusCommunities: cwrap('consensusCommunities', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            resolutionSweep: cwrap('resolutionSweep', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            personalizedPageRank: cwrap('personalizedPageRank', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            localCommunities: cwrap('localCommunities', 'number', ['number', 'number', 'number', 'number', 'number', 'number', 'number']),
+            countTriangles: cwrap('countTriangles', 'number', ['number', 'number', 'number']),
+
+            // Graph generators API
+            sbm: cwrap('sbmGraph', 'number', ['number', 'number', 'number', 'number', 'number']),
+            staticPowerLaw: cwrap('staticPowerLawGraph', 'number', ['number', 'number', 'number', 'number']),
+            barabasi: cwrap('barabasiGraph', 'number', ['number', 'number', 'number']),
 
             // Helpers
-            createBuffer: Module.cwrap('createBuffer', 'number', ['number']),
-            create_buffer: Module.cwrap('create_buffer', 'number', ['number', 'number']),
-            destroyBuffer: Module.cwrap('destroyBuffer', '', ['number']),
+            createBuffer: cwrap('createBuffer', 'number', ['number']),
+            create_buffer: cwrap('create_buffer', 'number', ['number', 'number']),
+            destroyBuffer: cwrap('destroyBuffer', '', ['number']),
+            createGraphLoader: cwrap('createGraphLoader', 'number', ['number', 'number', 'number']),
+            finishGraphLoader: cwrap('finishGraphLoader', 'number', ['number', 'number', 'number', 'number']),
+            getLoadedGraphWeightsPointer: cwrap('getLoadedGraphWeightsPointer', 'number', ['number']),
+            destroyLoadedGraph: cwrap('destroyLoadedGraph', '', ['number']),
+
+            createGraphBuilder: cwrap('createGraphBuilder', 'number', []),
+            appendGraphBuilderEdges: cwrap('appendGraphBuilderEdges', 'number', ['number', 'number']),
+            getGraphBuilderVertexCount: cwrap('getGraphBuilderVertexCount', 'number', ['number']),
+            getGraphBuilderSize: cwrap('getGraphBuilderSize', 'number', ['number']),
+            finishGraphBuilder: cwrap('finishGraphBuilder', 'number', ['number', 'number']),
+            destroyGraphBuilder: cwrap('destroyGraphBuilder', '', ['number']),
+
+            createSession: cwrap('createSession', 'number', ['number', 'number', 'number', 'number']),
+            sessionAddEdges: cwrap('sessionAddEdges', 'number', ['number', 'number', 'number']),
+            sessionDeleteEdges: cwrap('sessionDeleteEdges', 'number', ['number', 'number', 'number']),
+            sessionDetect: cwrap('sessionDetect', 'number', ['number', 'number']),
+            getSessionVertexCount: cwrap('getSessionVertexCount', 'number', ['number']),
+            getSessionResultPointer: cwrap('getSessionResultPointer', 'number', ['number']),
+            destroySession: cwrap('destroySession', '', ['number']),
+
+            getMembershipPointer: cwrap('getMembershipPointer', 'number', []),
+            getMembershipModularity: cwrap('getMembershipModularity', 'number', []),
+            getDendrogramPointer: cwrap('getDendrogramPointer', 'number', []),
+            getDendrogramSize: cwrap('getDendrogramSize', 'number', []),
+            getDendrogramLoglikelihood: cwrap('getDendrogramLoglikelihood', 'number', []),
+            getModularitiesFoundPointer: cwrap('getModularitiesFoundPointer', 'number', []),
+            getModularitiesFoundSize: cwrap('getModularitiesFoundSize', 'number', []),
 
-            getMembershipPointer: Module.cwrap('getMembershipPointer', 'number', []),
-            getMembershipModularity: Module.cwrap('getMembershipModularity', 'number', []),
-            getModularitiesFoundPointer: Module.cwrap('getModularitiesFoundPointer', 'number', []),
-            getModularitiesFoundSize: Module.cwrap('getModularitiesFoundSize', 'number', []),
+            getScorePointer: cwrap('getScorePointer', 'number', []),
+            freeScore: cwrap('freeScore', '', []),
+            getOverlappingPointer: cwrap('getOverlappingPointer', 'number', []),
+            getOverlappingSize: cwrap('getOverlappingSize', 'number', []),
+            freeOverlapping: cwrap('freeOverlapping', '', []),
+            getSweepPointer: cwrap('getSweepPointer', 'number', []),
+            getSweepSize: cwrap('getSweepSize', 'number', []),
+            freeSweep: cwrap('freeSweep', '', []),
+            getConsensusPointer: cwrap('getConsensusPointer', 'number', []),
+            freeConsensus: cwrap('freeConsensus', '', []),
+            getPageRankPointer: cwrap('getPageRankPointer', 'number', []),
+            getPageRankSize: cwrap('getPageRankSize', 'number', []),
+            freePageRank: cwrap('freePageRank', '', []),
+            getTrianglePointer: cwrap('getTrianglePointer', 'number', []),
+            freeTriangles: cwrap('freeTriangles', '', []),
 
-            freeResult: Module.cwrap('freeResult', '', [])
+            getGeneratedEdgesPointer: cwrap('getGeneratedEdgesPointer', 'number', []),
+            getGeneratedEdgesSize: cwrap('getGeneratedEdgesSize', 'number', []),
+            getPlantedMembershipPointer: cwrap('getPlantedMembershipPointer', 'number', []),
+
+            setArenaMode: cwrap('setArenaMode', '', ['number']),
+            setComponentMode: cwrap('setComponentMode', '', ['number', 'number']),
+            setCorePruning: cwrap('setCorePruning', '', ['number']),
+            setEdgeWeights: cwrap('setEdgeWeights', '', ['number']),
+            setRunGraph: cwrap('setRunGraph', '', ['number']),
+            getArenaPeak: cwrap('getArenaPeak', 'number', []),
+            getArenaReserved: cwrap('getArenaReserved', 'number', []),
+
+            freeResult: cwrap('freeResult', '', []),
+            freeGeneratedGraph: cwrap('freeGeneratedGraph', '', [])
         };
 
-        // @edges: undirected edges list, the first two elements are the first edge, etc.
+        // @edges: undirected edges list, the first two elements are the first edge, etc.,
+        // or a graph returned by loadBinaryGraph
         function runCommunityDetection(algorithmName, n, edges, options = {}) {
             if (!ALL_ALGORITHM_NAMES.includes(algorithmName)) {
                 throw new Error(`Uknown algorithm name: '${algorithmName}'. Possible options are:  ${ALL_ALGORITHM_NAMES}`);
             }
 
-            const { seedMembership = null, progressHandler = null } = options;
+            // A missing function aborts the whole Emscripten module, so older builds are checked first
+            if (!hasFunction(algorithmName)) {
+                throw new Error(`Algorithm '${algorithmName}' is not supported by this build of the module, rebuild it with build.sh`);
+            }
+
+            const {
+                seedMembership = null,
+                progressHandler = null,
+                arpackOptions = {},
+                spinglassOptions = {},
+                labelPropagationOptions = {},
+                fluidOptions = {},
+                hrgOptions = {},
+                spectralOptions = {},
+                useArena = false,
+                perComponent = false,
+                minComponentSize = 3,
+                kCore = 0,
+                edgeWeights = null
+            } = options;
 
             if (SEED_ALGORITHM_NAMES.includes(algorithmName) && !seedMembership) {
                 throw new Error(`Option 'seedMembership' required`);
             }
 
+            if (algorithmName === 'fluidCommunities' && !fluidOptions.communities) {
+                throw new Error(`Option 'fluidOptions.communities' required`);
+            }
+
+            if (algorithmName === 'spectral' && !spectralOptions.communities) {
+                throw new Error(`Option 'spectralOptions.communities' required`);
+            }
+
+            const loadedGraph = isLoadedGraph(edges);
+            const graph = loadedGraph ? edges : { n, edges };
+            const edgesLength = loadedGraph ? 2 * edges.m : edges.length;
+
+            if (edgeWeights) {
+                if (!WEIGHTED_ALGORITHM_NAMES.includes(algorithmName)) {
+                    throw new Error(`Option 'edgeWeights' is supported by ${WEIGHTED_ALGORITHM_NAMES} only`);
+                }
+                if (edgeWeights.length !== edgesLength / 2 || Array.prototype.some.call(edgeWeights, (w) => !(w > 0))) {
+                    throw new Error(`Option 'edgeWeights' has to hold a positive weight for every edge`);
+                }
+            }
+
             if (progressHandler) {
                 console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER = progressHandler;
             }
 
-            const edgesPointer = allocateBuffer(edges);
+            // The modes are global to the module; a build without one fails here, before anything is allocated
+            setRunMode('setArenaMode', 'useArena', useArena, useArena ? 1 : 0);
+            setRunMode('setComponentMode', 'perComponent', perComponent, perComponent ? 1 : 0, minComponentSize);
+            setRunMode('setCorePruning', 'kCore', kCore, kCore);
+            setRunMode('setEdgeWeights', 'edgeWeights', edgeWeights, 0);
+
+            const { edgesPointer } = acquireGraphEdges(graph);
 
-            const args = [n, edgesPointer, edges.length];
+            const args = [n, edgesPointer, edgesLength];
             let seedMembershipPointer;
             if (seedMembership) {
                 seedMembershipPointer = api.createBuffer(seedMembership.length);
-                const reindexedSeeds = reindexSeedMembership(seedMembership);
-                const uint8SeedMembership = new Uint8Array(reindexedSeeds.buffer);
-                Module.HEAP8.set(uint8SeedMembership, seedMembershipPointer);
+                writeData(seedMembershipPointer, reindexSeedMembership(seedMembership));
 
                 args.push(seedMembershipPointer);
             }
-            api[algorithmName](...args);
+
+            if (algorithmName === 'labelPropagation') {
+                const { semiSynchronous = false } = labelPropagationOptions;
+                args.push(semiSynchronous ? 1 : 0);
+            }
+
+            if (algorithmName === 'fluidCommunities') {
+                const { communities, seed = -1, semiSynchronous = false } = fluidOptions;
+                args.push(communities, seed, semiSynchronous ? 1 : 0);
+            }
+
+            if (algorithmName === 'hrg') {
+                const { chains = 4, steps = 0, exchangePeriod = 262144, samples = 100, seed = -1 } = hrgOptions;
+                args.push(chains, steps, exchangePeriod, samples, seed);
+            }
+
+            if (algorithmName === 'spectral') {
+                const { communities, dimensions = 0, seed = -1 } = spectralOptions;
+                args.push(communities, dimensions, seed);
+            }
+
+            if (algorithmName === 'leadingEigenvector') {
+                const { tol = 0, ncv = 0 } = arpackOptions;
+                args.push(tol, ncv);
+            }
+
+            if (algorithmName === 'spinglass') {
+                const {
+                    spins = 25, startTemp = 1.0, stopTemp = 0.01, coolFact = 0.99, gamma = 1.0, replicas = 1
+                } = spinglassOptions;
+                args.push(spins, startTemp, stopTemp, coolFact, gamma, replicas);
+            }
+
+            // The weights of a weighted loaded graph, unless others are given, stay in module memory
+            const edgeWeightsPointer = edgeWeights ? allocateBuffer(edgeWeights) :
+                getLoadedGraphWeights(graph, algorithmName);
+            let error;
+            try {
+                if (edgeWeightsPointer) {
+                    api.setEdgeWeights(edgeWeightsPointer);
+                }
+                error = api[algorithmName](...args);
+            } finally {
+                // No weights pointer outlives its buffer, whether the run returns or throws
+                if (edgeWeightsPointer) {
+                    api.setEdgeWeights(0);
+                }
+                if (edgeWeights) {
+                    freeBuffer(edgeWeightsPointer);
+                }
+                releaseGraphEdges(graph, edgesPointer);
+                if (seedMembershipPointer) {
+                    api.destroyBuffer(seedMembershipPointer);
+                }
+            }
+
+            // A failed run leaves no result behind
+            if (error) {
+                throw new Error(`runCommunityDetection: '${algorithmName}' failed`);
+            }
 
             const membership = getResultData(api.getMembershipPointer(), n);
             const modularity = api.getMembershipModularity();
             const modularitiesFound = getResultData(api.getModularitiesFoundPointer(), api.getModularitiesFoundSize());
+            const dendrogram = getDendrogram(n);
 
             api.freeResult();
-            freeBuffer(edgesPointer);
 
-            if (seedMembershipPointer) {
-                api.destroyBuffer(seedMembershipPointer);
-            }
-
-            return {
+            const result = {
                 membership: Array.from(membership),
                 modularity,
                 modularitiesFound: Array.from(modularitiesFound)
             };
+            if (dendrogram) {
+                result.dendrogram = dendrogram;
+            }
+
+            return result;
+        }
+
+        // Sets a global mode of the module for the next run; builds older than the mode only support it disabled
+        function setRunMode(setterName, optionName, enabled, ...values) {
+            if (hasFunction(setterName)) {
+                api[setterName](...values);
+            } else if (enabled) {
+                throw new Error(`Option '${optionName}' is not supported by this build of the module, rebuild it with build.sh`);
+            }
+        }
+
+        // Builds older than an API lack its C function, calling it through cwrap would abort the whole module
+        function requireFunction(apiName, functionName = apiName) {
+            if (!hasFunction(functionName)) {
+                throw new Error(`'${apiName}' is not supported by this build of the module, rebuild it with build.sh`);
+            }
+        }
+
+        // Consensus tree of the hrg algorithm: parents of the n vertices and of the internal vertices, then the
+        // weights of the internal vertices
+        function getDendrogram(n) {
+            if (!hasFunction('getDendrogramSize')) {
+                return null;
+            }
+
+            const size = api.getDendrogramSize();
+            if (size === 0) {
+                return null;
+            }
+
+            const data = getResultData(api.getDendrogramPointer(), size);
+            const internal = (size - n) / 2;
+            return {
+                parents: Array.from(data.subarray(0, n + internal)),
+                weights: Array.from(data.subarray(n + internal)),
+                logLikelihood: api.getDendrogramLoglikelihood()
+            };
         }
 
         function allocateBuffer(array) {
             const pointer = api.createBuffer(array.length);
-            const uint8Data = new Uint8Array(new Float64Array(array).buffer);
-            Module.HEAP8.set(uint8Data, pointer);
+            writeData(pointer, new Float64Array(array));
             return pointer;
         }
 
@@ -143,9 +469,266 @@ function loadPublicAPI(onLoaded, wasm) {
             api.destroyBuffer(pointer);
         }
 
+        function isLoadedGraph(edges) {
+            return edges !== null && typeof edges === 'object' && typeof edges.graphPointer === 'number';
+        }
+
+        // Edges buffer of a C call on @graph, { n, edges } or a loaded graph. A graph from loadBinaryGraph or
+        // createGraphBuilder is indexed already, it is set as the graph of the call in place of a buffer until
+        // releaseGraphEdges.
+        function acquireGraphEdges(graph) {
+            if (!isLoadedGraph(graph)) {
+                setRunMode('setRunGraph', 'loadBinaryGraph', false, 0);
+                return { edgesPointer: allocateBuffer(graph.edges), edgesLength: graph.edges.length };
+            }
+            if (!graph.graphPointer) {
+                throw new Error('The graph has already been freed');
+            }
+
+            setRunMode('setRunGraph', 'loadBinaryGraph', true, graph.graphPointer);
+            return { edgesPointer: 0, edgesLength: 2 * graph.m };
+        }
+
+        function releaseGraphEdges(graph, edgesPointer) {
+            if (!isLoadedGraph(graph)) {
+                freeBuffer(edgesPointer);
+            } else {
+                api.setRunGraph(0);
+            }
+        }
+
+        // Weights kept with a weighted loaded @graph, for the algorithms taking weights; zero otherwise
+        function getLoadedGraphWeights(graph, algorithmName) {
+            if (!graph || !graph.weighted || !WEIGHTED_ALGORITHM_NAMES.includes(algorithmName)) {
+                return 0;
+            }
+            return api.getLoadedGraphWeightsPointer(graph.graphPointer);
+        }
+
+        // Streams a graph in the binary format (see binary-graph.js) into module memory, where it is indexed once
+        // and stays for any number of runCommunityDetection calls until freeGraph
+        async function loadBinaryGraph(source) {
+            requireFunction('loadBinaryGraph', 'createGraphLoader');
+
+            const header = new Uint8Array(BINARY_GRAPH_HEADER_SIZE);
+            let headerSize = 0;
+            let graph = null;
+            let pointer = 0;
+            let size = 0;
+            let written = 0;
+
+            try {
+                for await (let chunk of binaryChunks(source)) {
+                    if (headerSize < BINARY_GRAPH_HEADER_SIZE) {
+                        const part = chunk.subarray(0, BINARY_GRAPH_HEADER_SIZE - headerSize);
+                        header.set(part, headerSize);
+                        headerSize += part.length;
+                        chunk = chunk.subarray(part.length);
+
+                        if (headerSize < BINARY_GRAPH_HEADER_SIZE) {
+                            continue;
+                        }
+
+                        graph = readBinaryGraphHeader(header);
+                        // The offsets are int32, C checks the size of the buffer as well
+                        if (graph.n >= 0x7fffffff || graph.m > 0x7fffffff) {
+                            throw new Error('loadBinaryGraph: n and m have to be smaller than 2^31.');
+                        }
+                        size = 4 * (graph.n + 1 + (graph.weighted ? 2 : 1) * graph.m);
+                        pointer = api.createGraphLoader(graph.n, graph.m, graph.weighted ? 1 : 0);
+                        if (!pointer) {
+                            throw new Error('loadBinaryGraph: cannot allocate the graph.');
+                        }
+                    }
+
+                    // Offsets, targets and weights are copied as they are
+                    if (written < size && chunk.length > 0) {
+                        const part = chunk.subarray(0, size - written);
+                        writeBytes(pointer + written, part);
+                        written += part.length;
+                    }
+                }
+            } catch (e) {
+                if (pointer) {
+                    api.destroyBuffer(pointer);
+                }
+                throw e;
+            }
+
+            if (!graph || written < size) {
+                if (pointer) {
+                    api.destroyBuffer(pointer);
+                }
+                throw new Error('loadBinaryGraph: unexpected end of data.');
+            }
+
+            // Frees the loader buffer in any case
+            const graphPointer = api.finishGraphLoader(pointer, graph.n, graph.m, graph.weighted ? 1 : 0);
+            if (!graphPointer) {
+                throw new Error('loadBinaryGraph: invalid offsets, targets or weights.');
+            }
+
+            return { n: graph.n, m: graph.m, weighted: graph.weighted, graphPointer };
+        }
+
+        // Builds a graph from edges appended in chunks; only the int32 endpoints are kept in module memory until
+        // finalize, which indexes them once and returns a graph like loadBinaryGraph does
+        function createGraphBuilder() {
+            requireFunction('createGraphBuilder');
+
+            let builder = api.createGraphBuilder();
+
+            const checkBuilder = () => {
+                if (!builder) {
+                    throw new Error('The graph builder has already been finalized');
+                }
+            };
+
+            return {
+                // @edges: chunk of the undirected edges list, an array or a typed array of even length
+                appendEdges(edges) {
+                    checkBuilder();
+                    if (edges.length % 2 !== 0) {
+                        throw new Error('appendEdges: edges length has to be even.');
+                    }
+                    // Int32Array.from would truncate fractions and wrap ids from 2^31 on, the builder keeps none
+                    // of a rejected chunk
+                    for (let i = 0; i < edges.length; i++) {
+                        if (!Number.isInteger(edges[i]) || edges[i] < 0 || edges[i] >= 0x7fffffff) {
+                            throw new Error(`appendEdges: edge ${Math.floor(i / 2)} has a vertex id that is not an integer in [0, 2^31 - 1).`);
+                        }
+                    }
+
+                    const pointer = api.appendGraphBuilderEdges(builder, edges.length);
+                    if (!pointer) {
+                        throw new Error('appendEdges: cannot allocate the edges.');
+                    }
+
+                    const chunk = edges instanceof Int32Array ? edges : Int32Array.from(edges);
+                    writeBytes(pointer, new Uint8Array(chunk.buffer, chunk.byteOffset, chunk.byteLength));
+                },
+
+                // @vertexCount: number of vertices, by default the largest vertex id plus one
+                finalize(vertexCount) {
+                    checkBuilder();
+                    const n = vertexCount === undefined ? api.getGraphBuilderVertexCount(builder) : vertexCount;
+                    const m = api.getGraphBuilderSize(builder) / 2;
+                    if (n === 0 && m === 0) {
+                        api.destroyGraphBuilder(builder);
+                        builder = 0;
+                        throw new Error('finalize: the graph is empty, append edges or pass the number of vertices.');
+                    }
+
+                    // Destroys the builder in any case
+                    const graphPointer = api.finishGraphBuilder(builder, Math.max(n, 0));
+                    builder = 0;
+
+                    if (!graphPointer) {
+                        throw new Error('finalize: vertex ids have to be in the range [0, n).');
+                    }
+
+                    return { n, m, weighted: false, graphPointer };
+                },
+
+                // Frees the appended edges without creating the graph
+                destroy() {
+                    if (builder) {
+                        api.destroyGraphBuilder(builder);
+                        builder = 0;
+                    }
+                }
+            };
+        }
+
+        // A graph kept in module memory with its partition: edge changes mark their endpoints and detect() revisits
+        // only the marked vertices, and the neighbors of those changing community, from the previous partition
+        function createSession(graph, options = {}) {
+            requireFunction('createSession');
+
+            const { mode = 'modularity' } = options;
+
+            if (!SESSION_MODE_NAMES.includes(mode)) {
+                throw new Error(`Unknown session mode: '${mode}'. Possible options are: ${SESSION_MODE_NAMES}`);
+            }
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+
+            let session;
+            try {
+                session = api.createSession(graph.n, edgesPointer, edgesLength, SESSION_MODE_NAMES.indexOf(mode));
+            } finally {
+                releaseGraphEdges(graph, edgesPointer);
+            }
+            if (!session) {
+                throw new Error('createSession: failed, edge endpoints have to be vertex ids in [0, n).');
+            }
+
+            const checkSession = () => {
+                if (!session) {
+                    throw new Error('The session has already been freed');
+                }
+            };
+
+            const withEdges = (name, edges, call) => {
+                checkSession();
+                if (edges.length % 2 !== 0) {
+                    throw new Error(`${name}: edges length has to be even.`);
+                }
+
+                const pointer = allocateBuffer(edges);
+                const result = call(pointer, edges.length);
+                freeBuffer(pointer);
+                return result;
+            };
+
+            return {
+                // @edges: undirected edges list, vertex ids from the current vertex count on add vertices
+                addEdges(edges) {
+                    const error = withEdges('addEdges', edges, (pointer, length) => api.sessionAddEdges(session, pointer, length));
+                    if (error) {
+                        throw new Error('addEdges: vertex ids have to be non-negative.');
+                    }
+                },
+
+                // Removes one edge of every endpoint pair, missing edges are skipped; returns the number removed
+                removeEdges(edges) {
+                    return withEdges('removeEdges', edges, (pointer, length) => api.sessionDeleteEdges(session, pointer, length));
+                },
+
+                // The first call, or one with @full, runs the algorithm on the whole graph
+                detect({ full = false } = {}) {
+                    checkSession();
+                    if (api.sessionDetect(session, full ? 1 : 0)) {
+                        throw new Error(`detect: '${mode}' failed`);
+                    }
+
+                    const n = api.getSessionVertexCount(session);
+                    const data = getResultData(api.getSessionResultPointer(session), 2 + n);
+                    return {
+                        membership: Array.from(data.subarray(2)),
+                        modularity: data[0],
+                        moved: data[1]
+                    };
+                },
+
+                free() {
+                    if (session) {
+                        api.destroySession(session);
+                        session = 0;
+                    }
+                }
+            };
+        }
+
+        function freeGraph(graph) {
+            if (graph.graphPointer) {
+                api.destroyLoadedGraph(graph.graphPointer);
+                graph.graphPointer = 0;
+            }
+        }
+
         function getResultData(pointer, size) {
-            const resultView = new Float64Array(Module.HEAP8.buffer, pointer, size); // move data from buffer to js
-            return new Float64Array(resultView);
+            return readData(pointer, size); // move data from module memory to js
         }
 
         function reindexSeedMembership(seedMembership) {
@@ -195,17 +778,398 @@ function loadPublicAPI(onLoaded, wasm) {
             return value;
         }
 
+        // Scores a partition given by @membership, community ids are integers from 0, of @graph, which is
+        // { n, edges } or a graph returned by loadBinaryGraph or createGraphBuilder; all the metrics come
+        // from a single pass over the edges, @metrics only selects what is returned. Edges count with
+        // options.edgeWeights, else with the weights of a weighted loaded graph, else as one
+        function scoreMembership(graph, membership, metrics = SCORE_METRIC_NAMES, options = {}) {
+            requireFunction('scoreMembership');
+
+            const unknownMetric = metrics.find((metric) => !SCORE_METRIC_NAMES.includes(metric));
+            if (unknownMetric) {
+                throw new Error(`Unknown metric: '${unknownMetric}'. Possible options are: ${SCORE_METRIC_NAMES}`);
+            }
+
+            if (membership.length !== graph.n) {
+                throw new Error('scoreMembership: membership length has to equal the number of vertices.');
+            }
+
+            const { resolution = 1, edgeWeights = null } = options;
+            const edgesLength = isLoadedGraph(graph) ? 2 * graph.m : graph.edges.length;
+            if (edgeWeights &&
+                (edgeWeights.length !== edgesLength / 2 || Array.prototype.some.call(edgeWeights, (w) => !(w > 0)))) {
+                throw new Error(`Option 'edgeWeights' has to hold a positive weight for every edge`);
+            }
+
+            let communities = 0;
+            for (let i = 0; i < membership.length; i++) {
+                if (!Number.isInteger(membership[i]) || membership[i] < 0) {
+                    throw new Error('scoreMembership: community ids have to be non-negative integers.');
+                }
+                communities = Math.max(communities, membership[i] + 1);
+            }
+
+            setRunMode('setEdgeWeights', 'edgeWeights', edgeWeights, 0);
+
+            const { edgesPointer } = acquireGraphEdges(graph);
+            const membershipPointer = allocateBuffer(membership);
+            const edgeWeightsPointer = edgeWeights ? allocateBuffer(edgeWeights) :
+                graph.weighted ? api.getLoadedGraphWeightsPointer(graph.graphPointer) : 0;
+
+            let error;
+            try {
+                if (edgeWeightsPointer) {
+                    api.setEdgeWeights(edgeWeightsPointer);
+                }
+                error = api.scoreMembership(graph.n, edgesPointer, edgesLength, membershipPointer, communities,
+                    resolution);
+            } finally {
+                if (edgeWeightsPointer) {
+                    api.setEdgeWeights(0);
+                }
+                if (edgeWeights) {
+                    freeBuffer(edgeWeightsPointer);
+                }
+                freeBuffer(membershipPointer);
+                releaseGraphEdges(graph, edgesPointer);
+            }
+
+            if (error) {
+                throw new Error('scoreMembership: edge endpoints have to be vertex ids from 0 to n - 1.');
+            }
+
+            const score = getResultData(api.getScorePointer(), 2 + 5 * communities);
+            api.freeScore();
+
+            const perCommunity = (i) => Array.from(score.subarray(2 + i * communities, 2 + (i + 1) * communities));
+            const result = {};
+            metrics.forEach((metric) => {
+                if (metric === 'modularity') {
+                    result.modularity = score[0];
+                } else if (metric === 'coverage') {
+                    result.coverage = score[1];
+                } else if (metric === 'conductance') {
+                    result.conductance = perCommunity(3);
+                } else if (metric === 'edgeCounts') {
+                    result.internalEdges = perCommunity(1);
+                    result.externalEdges = perCommunity(2);
+                } else {
+                    result.sizes = perCommunity(0);
+                    result.density = perCommunity(4);
+                }
+            });
+
+            return result;
+        }
+
+        // Overlapping communities of @graph, { n, edges } or a loaded graph, by k-clique percolation; the
+        // communities of vertex v are communities[offsets[v]] ... communities[offsets[v + 1] - 1]
+        function cliquePercolation(graph, k = 3) {
+            requireFunction('cliquePercolation');
+
+            if (!Number.isInteger(k) || k < 2) {
+                throw new Error('cliquePercolation: k has to be an integer of at least 2.');
+            }
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+
+            let error;
+            try {
+                error = api.cliquePercolation(graph.n, edgesPointer, edgesLength, k);
+            } finally {
+                releaseGraphEdges(graph, edgesPointer);
+            }
+            if (error) {
+                throw new Error('cliquePercolation: failed, edge endpoints have to be vertex ids in [0, n).');
+            }
+
+            const data = getResultData(api.getOverlappingPointer(), api.getOverlappingSize());
+            api.freeOverlapping();
+
+            return {
+                count: data[0],
+                offsets: Int32Array.from(data.subarray(1, graph.n + 2)),
+                communities: Int32Array.from(data.subarray(graph.n + 2))
+            };
+        }
+
+        // Consensus of @replicates runs of the algorithm on @graph, { n, edges } or a loaded graph: edges are weighed by
+        // the fraction of runs putting their endpoints together, those below @threshold dropped, and the weighted
+        // graph is clustered by Louvain
+        function consensusCommunities(graph, algorithmName = 'louvain', options = {}) {
+            requireFunction('consensusCommunities');
+
+            const { replicates = 25, threshold = 0.5, seed = -1, progressHandler = null } = options;
+
+            if (!CONSENSUS_ALGORITHM_NAMES.includes(algorithmName)) {
+                throw new Error(`Unknown algorithm name: '${algorithmName}'. Possible options are: ${CONSENSUS_ALGORITHM_NAMES}`);
+            }
+            if (!Number.isInteger(replicates) || replicates < 1) {
+                throw new Error('consensusCommunities: replicates has to be a positive integer.');
+            }
+            if (progressHandler) {
+                console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER = progressHandler;
+            }
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+
+            // The C side numbers the algorithms in the order of IGRAPH_ALGORITHM_NAMES
+            let error;
+            try {
+                error = api.consensusCommunities(graph.n, edgesPointer, edgesLength,
+                    IGRAPH_ALGORITHM_NAMES.indexOf(algorithmName), replicates, threshold, seed);
+            } finally {
+                releaseGraphEdges(graph, edgesPointer);
+            }
+            if (error) {
+                throw new Error(`consensusCommunities: '${algorithmName}' failed, edge endpoints have to be vertex ids in [0, n).`);
+            }
+
+            const data = getResultData(api.getConsensusPointer(), 1 + 2 * graph.n);
+            api.freeConsensus();
+
+            return {
+                membership: Array.from(data.subarray(1, 1 + graph.n)),
+                modularity: data[0],
+                stability: Array.from(data.subarray(1 + graph.n))
+            };
+        }
+
+        // Leiden on @graph, { n, edges } or a loaded graph, for every resolution in order, each run starting from
+        // the partition of the previous one; the membership of resolutions[i] is memberships[i * n] ...
+        // memberships[(i + 1) * n - 1]
+        function resolutionSweep(graph, resolutions, options = {}) {
+            requireFunction('resolutionSweep');
+
+            const { objective = 'modularity', stableSteps = 0, progressHandler = null } = options;
+
+            if (!SWEEP_OBJECTIVE_NAMES.includes(objective)) {
+                throw new Error(`Unknown objective: '${objective}'. Possible options are: ${SWEEP_OBJECTIVE_NAMES}`);
+            }
+            if (progressHandler) {
+                console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER = progressHandler;
+            }
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+            const resolutionsPointer = allocateBuffer(resolutions);
+
+            let error;
+            try {
+                error = api.resolutionSweep(graph.n, edgesPointer, edgesLength, resolutionsPointer,
+                    resolutions.length, objective === 'cpm' ? 1 : 0, stableSteps);
+            } finally {
+                freeBuffer(resolutionsPointer);
+                releaseGraphEdges(graph, edgesPointer);
+            }
+
+            // A failed sweep leaves no result behind
+            if (error) {
+                throw new Error('resolutionSweep: failed, edge endpoints have to be vertex ids in [0, n).');
+            }
+
+            const data = getResultData(api.getSweepPointer(), api.getSweepSize());
+            api.freeSweep();
+
+            const count = data[0];
+            const perResolution = (offset) => Array.from({ length: count }, (_, i) => data[1 + 3 * i + offset]);
+            return {
+                resolutions: Array.from(resolutions).slice(0, count),
+                quality: perResolution(0),
+                modularity: perResolution(1),
+                communities: perResolution(2),
+                memberships: Int32Array.from(data.subarray(1 + 3 * count))
+            };
+        }
+
+        // Runs the C side on every seed set of @seedSets, arrays of vertex ids, and returns its result buffer
+        function runSeedSets(functionName, graph, seedSets, run) {
+            // Offsets of the sets and the end, then their vertices
+            const sets = [0];
+            const seeds = [];
+            seedSets.forEach((seedSet) => {
+                seeds.push(...seedSet);
+                sets.push(seeds.length);
+            });
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+            const setsPointer = allocateBuffer(sets.concat(seeds));
+
+            const error = run(edgesPointer, edgesLength, setsPointer);
+            freeBuffer(setsPointer);
+            releaseGraphEdges(graph, edgesPointer);
+            if (error) {
+                throw new Error(`${functionName}: seed vertices and edge endpoints have to be vertex ids in [0, n).`);
+            }
+
+            const data = getResultData(api.getPageRankPointer(), api.getPageRankSize());
+            api.freePageRank();
+
+            return data;
+        }
+
+        // Communities of a sweep cut result: conductances, offsets of the communities and the end, then the vertices
+        function readSweepCommunities(data, count) {
+            const vertices = data.subarray(2 * count + 1);
+
+            return Array.from({ length: count }, (_, i) => ({
+                vertices: Int32Array.from(vertices.subarray(data[count + i], data[count + i + 1])),
+                conductance: data[i]
+            }));
+        }
+
+        function runPersonalizedPageRank(functionName, graph, seedSets, options, sweep) {
+            requireFunction(functionName, 'personalizedPageRank');
+
+            const { damping = 0.85, tolerance = 1e-9, maxIterations = 100, progressHandler = null } = options;
+
+            if (!(damping >= 0 && damping < 1)) {
+                throw new Error(`${functionName}: damping has to be in [0, 1).`);
+            }
+            if (!Number.isInteger(maxIterations) || maxIterations < 1) {
+                throw new Error(`${functionName}: maxIterations has to be a positive integer.`);
+            }
+            if (progressHandler) {
+                console.__IGRAPH_COMMUNITY__PROGRESS_HANDLER = progressHandler;
+            }
+
+            return runSeedSets(functionName, graph, seedSets, (edgesPointer, edgesLength, setsPointer) =>
+                api.personalizedPageRank(graph.n, edgesPointer, edgesLength, setsPointer, seedSets.length,
+                    damping, tolerance, maxIterations, sweep ? 1 : 0));
+        }
+
+        // Personalized PageRank on @graph, { n, edges } or a loaded graph, restarting uniformly on every seed set
+        // of @seedSets; the scores of seedSets[i] are scores[i * n] ... scores[(i + 1) * n - 1]
+        function personalizedPageRank(graph, seedSets, options = {}) {
+            return runPersonalizedPageRank('personalizedPageRank', graph, seedSets, options, false);
+        }
+
+        // The community of lowest conductance around every seed set of @seedSets, by a sweep over the vertices in
+        // decreasing order of personalized PageRank over degree; the scores themselves never leave the C side
+        function pageRankCommunities(graph, seedSets, options = {}) {
+            const data = runPersonalizedPageRank('pageRankCommunities', graph, seedSets, options, true);
+            return readSweepCommunities(data, seedSets.length);
+        }
+
+        // As pageRankCommunities, with the personalized PageRank approximated by pushes out of the seeds, so that
+        // only the neighborhood of every seed set is explored
+        function localCommunities(graph, seedSets, options = {}) {
+            requireFunction('localCommunities');
+
+            const { damping = 0.85, epsilon = 1e-4 } = options;
+
+            if (!(damping >= 0 && damping < 1)) {
+                throw new Error('localCommunities: damping has to be in [0, 1).');
+            }
+            if (!(epsilon > 0)) {
+                throw new Error('localCommunities: epsilon has to be positive.');
+            }
+
+            const data = runSeedSets('localCommunities', graph, seedSets, (edgesPointer, edgesLength, setsPointer) =>
+                api.localCommunities(graph.n, edgesPointer, edgesLength, setsPointer, seedSets.length, damping, epsilon));
+            return readSweepCommunities(data, seedSets.length);
+        }
+
+        // Triangles of @graph, { n, edges } or a loaded graph, with loops dropped and multiple edges merged: the
+        // number of triangles, those of every vertex and every edge, and the local clustering coefficients. The
+        // edge counts plus one are positive weights for the `edgeWeights` option.
+        function countTriangles(graph) {
+            requireFunction('countTriangles');
+
+            const { edgesPointer, edgesLength } = acquireGraphEdges(graph);
+
+            const error = api.countTriangles(graph.n, edgesPointer, edgesLength);
+            releaseGraphEdges(graph, edgesPointer);
+            if (error) {
+                throw new Error('countTriangles: edge endpoints have to be vertex ids in [0, n).');
+            }
+
+            const data = getResultData(api.getTrianglePointer(), 1 + 2 * graph.n + edgesLength / 2);
+            api.freeTriangles();
+
+            return {
+                count: data[0],
+                vertexTriangles: data.subarray(1, 1 + graph.n),
+                clustering: data.subarray(1 + graph.n, 1 + 2 * graph.n),
+                edgeTriangles: data.subarray(1 + 2 * graph.n)
+            };
+        }
+
+        // Generates an undirected graph with igraph's generators, the same seed gives the same graph
+        function generateGraph(generatorName, n, options = {}) {
+            if (!GENERATOR_NAMES.includes(generatorName)) {
+                throw new Error(`Unknown generator name: '${generatorName}'. Possible options are: ${GENERATOR_NAMES}`);
+            }
+            requireFunction('generateGraph', `${generatorName}Graph`);
+
+            const { seed = 42 } = options;
+
+            if (generatorName === 'sbm') {
+                const { blocks = 2, pIn = 0.3, pOut = 0.01 } = options;
+                api.sbm(n, blocks, pIn, pOut, seed);
+            } else if (generatorName === 'staticPowerLaw') {
+                const { m = 5 * n, exponent = 2.5 } = options;
+                api.staticPowerLaw(n, m, exponent, seed);
+            } else {
+                const { m = 5 } = options;
+                api.barabasi(n, m, seed);
+            }
+
+            const edges = getResultData(api.getGeneratedEdgesPointer(), api.getGeneratedEdgesSize());
+            const plantedMembershipPointer = api.getPlantedMembershipPointer();
+            const plantedMembership = plantedMembershipPointer ? getResultData(plantedMembershipPointer, n) : null;
+
+            api.freeGeneratedGraph();
+
+            return {
+                n,
+                edges: Array.from(edges),
+                plantedMembership: plantedMembership && Array.from(plantedMembership)
+            };
+        }
+
+        // Arena usage: the peak of the last run with `useArena` and the memory kept for the next one
+        function getArenaStats() {
+            return {
+                peakBytes: api.getArenaPeak(),
+                reservedBytes: api.getArenaReserved()
+            };
+        }
+
         onLoaded({
+            backend,
             runCommunityDetection,
-            compareCommunities
+            compareCommunities,
+            scoreMembership,
+            cliquePercolation,
+            resolutionSweep,
+            consensusCommunities,
+            personalizedPageRank,
+            pageRankCommunities,
+            localCommunities,
+            countTriangles,
+            generateGraph,
+            loadBinaryGraph,
+            createGraphBuilder,
+            createSession,
+            freeGraph,
+            getHeapSize,
+            getArenaStats
         });
-    };
+    }, backend);
 }
 
 module.exports = {
     getAPI,
+    writeBinaryGraph,
     IGRAPH_ALGORITHM_NAMES,
     SEED_ALGORITHM_NAMES,
     ALL_ALGORITHM_NAMES,
+    GENERATOR_NAMES,
+    BACKEND_NAMES,
+    SCORE_METRIC_NAMES,
+    CONSENSUS_ALGORITHM_NAMES,
+    WEIGHTED_ALGORITHM_NAMES,
+    SESSION_MODE_NAMES,
+    SWEEP_OBJECTIVE_NAMES,
     COMPARE_COMMUNITIES_METHODS
 };
@@ -0,0 +1,398 @@
+/* -*- mode: C -*-  */
+
+// Node.js N-API binding of the community detection runners, built by `build.sh --native`.
+//
+// The runners are compiled in the same translation unit, so the addon exports exactly the
+// functions the Wasm module does. Pointers into the native heap are passed to JS as numbers,
+// just like Emscripten does, and writeBuffer/readBuffer replace direct access to Module.HEAP8.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <node_api.h>
+
+#include "../community_detection.c"
+
+#define MAX_ARGS 9
+
+// Environment of the call in progress, used by the progress handler
+static napi_env current_env;
+
+void native_progress_handler(igraph_real_t percent) {
+    napi_env env = current_env;
+    napi_value global, console, handler, argv[1], result;
+    napi_valuetype type;
+
+    if (napi_get_global(env, &global) != napi_ok ||
+        napi_get_named_property(env, global, "console", &console) != napi_ok ||
+        napi_typeof(env, console, &type) != napi_ok || type != napi_object ||
+        napi_get_named_property(env, console, "__IGRAPH_COMMUNITY__PROGRESS_HANDLER", &handler) != napi_ok ||
+        napi_typeof(env, handler, &type) != napi_ok || type != napi_function) {
+        return;
+    }
+
+    napi_create_double(env, percent, &argv[0]);
+    napi_call_function(env, console, handler, 1, argv, &result);
+}
+
+// First igraph error of the call in progress. igraph's default handler aborts the process, this one frees the
+// temporary memory of the failed function, whose error code then unwinds to the wrapper, which throws it to JS
+static char error_message[256];
+static int error_raised;
+
+static void native_error_handler(const char *reason, const char *file, int line, int igraph_errno) {
+    IGRAPH_FINALLY_FREE();
+    if (!error_raised) {
+        snprintf(error_message, sizeof(error_message), "igraph: %s (%s, %s:%d)", reason, igraph_strerror(igraph_errno),
+                 file, line);
+        error_raised = 1;
+    }
+}
+
+// Throws the igraph error raised during the call, if any
+static int throw_igraph_error(napi_env env) {
+    if (!error_raised) {
+        return 0;
+    }
+
+    error_raised = 0;
+    napi_throw_error(env, NULL, error_message);
+    return 1;
+}
+
+// Reads numeric arguments of the call, missing ones are zero
+static int get_numbers(napi_env env, napi_callback_info info, double *values, size_t count) {
+    napi_value argv[MAX_ARGS];
+    size_t argc = MAX_ARGS;
+    size_t i;
+
+    if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        values[i] = 0;
+        if (i < argc && napi_get_value_double(env, argv[i], &values[i]) != napi_ok) {
+            napi_throw_type_error(env, NULL, "Expected a number argument");
+            return 0;
+        }
+    }
+
+    current_env = env;
+    error_raised = 0;
+    return 1;
+}
+
+static napi_value make_number(napi_env env, double value) {
+    napi_value result;
+    napi_create_double(env, value, &result);
+    return result;
+}
+
+#define POINTER(x) ((void *) (uintptr_t) (x))
+#define POINTER_TO_NUMBER(p) ((double) (uintptr_t) (p))
+
+// Wrappers of the exported functions, `a` holds the numeric arguments
+
+#define NUMBER_FUNCTION(name, argc, call) \
+    static napi_value js_##name(napi_env env, napi_callback_info info) { \
+        double a[MAX_ARGS], value; \
+        if (!get_numbers(env, info, a, argc)) return NULL; \
+        value = (double) (call); \
+        return throw_igraph_error(env) ? NULL : make_number(env, value); \
+    }
+
+#define POINTER_FUNCTION(name, argc, call) \
+    static napi_value js_##name(napi_env env, napi_callback_info info) { \
+        double a[MAX_ARGS], value; \
+        if (!get_numbers(env, info, a, argc)) return NULL; \
+        value = POINTER_TO_NUMBER(call); \
+        return throw_igraph_error(env) ? NULL : make_number(env, value); \
+    }
+
+#define VOID_FUNCTION(name, argc, call) \
+    static napi_value js_##name(napi_env env, napi_callback_info info) { \
+        double a[MAX_ARGS]; \
+        if (!get_numbers(env, info, a, argc)) return NULL; \
+        call; \
+        throw_igraph_error(env); \
+        return NULL; \
+    }
+
+#define GRAPH_ARGS (igraph_integer_t) a[0], POINTER(a[1]), (size_t) a[2]
+
+NUMBER_FUNCTION(edgeBetweenness, 3, edgeBetweenness(GRAPH_ARGS))
+NUMBER_FUNCTION(fastGreedy, 3, fastGreedy(GRAPH_ARGS))
+NUMBER_FUNCTION(infomap, 3, infomap(GRAPH_ARGS))
+NUMBER_FUNCTION(labelPropagation, 4, labelPropagation(GRAPH_ARGS, (int) a[3]))
+NUMBER_FUNCTION(leadingEigenvector, 5, leadingEigenvector(GRAPH_ARGS, a[3], (int) a[4]))
+NUMBER_FUNCTION(louvain, 3, louvain(GRAPH_ARGS))
+NUMBER_FUNCTION(leiden, 3, leiden(GRAPH_ARGS))
+NUMBER_FUNCTION(optimal, 3, optimal(GRAPH_ARGS))
+NUMBER_FUNCTION(spinglass, 9, spinglass(GRAPH_ARGS, (int) a[3], a[4], a[5], a[6], a[7], (int) a[8]))
+NUMBER_FUNCTION(walktrap, 3, walktrap(GRAPH_ARGS))
+NUMBER_FUNCTION(fluidCommunities, 6, fluidCommunities(GRAPH_ARGS, (int) a[3], a[4], (int) a[5]))
+NUMBER_FUNCTION(hrg, 8, hrg(GRAPH_ARGS, (int) a[3], (int) a[4], (int) a[5], (int) a[6], a[7]))
+NUMBER_FUNCTION(spectral, 6, spectral(GRAPH_ARGS, (int) a[3], (int) a[4], a[5]))
+
+NUMBER_FUNCTION(fastGreedySeed, 4, fastGreedySeed(GRAPH_ARGS, POINTER(a[3])))
+NUMBER_FUNCTION(louvainSeed, 4, louvainSeed(GRAPH_ARGS, POINTER(a[3])))
+NUMBER_FUNCTION(edgeBetweennessSeed, 4, edgeBetweennessSeed(GRAPH_ARGS, POINTER(a[3])))
+
+NUMBER_FUNCTION(compareCommunitiesNMI, 3, compareCommunitiesNMI(POINTER(a[0]), POINTER(a[1]), (size_t) a[2]))
+NUMBER_FUNCTION(compareCommunitiesRI, 3, compareCommunitiesRI(POINTER(a[0]), POINTER(a[1]), (size_t) a[2]))
+NUMBER_FUNCTION(compareCommunitiesARI, 3, compareCommunitiesARI(POINTER(a[0]), POINTER(a[1]), (size_t) a[2]))
+
+NUMBER_FUNCTION(scoreMembership, 6, scoreMembership(GRAPH_ARGS, POINTER(a[3]), (igraph_integer_t) a[4], a[5]))
+NUMBER_FUNCTION(cliquePercolation, 4, cliquePercolation(GRAPH_ARGS, (igraph_integer_t) a[3]))
+NUMBER_FUNCTION(consensusCommunities, 7, consensusCommunities(GRAPH_ARGS, (int) a[3], (int) a[4], a[5], a[6]))
+NUMBER_FUNCTION(resolutionSweep, 7, resolutionSweep(GRAPH_ARGS, POINTER(a[3]), (size_t) a[4], (int) a[5], (int) a[6]))
+NUMBER_FUNCTION(personalizedPageRank, 9,
+                personalizedPageRank(GRAPH_ARGS, POINTER(a[3]), (int) a[4], a[5], a[6], (int) a[7], (int) a[8]))
+NUMBER_FUNCTION(localCommunities, 7, localCommunities(GRAPH_ARGS, POINTER(a[3]), (int) a[4], a[5], a[6]))
+NUMBER_FUNCTION(countTriangles, 3, countTriangles(GRAPH_ARGS))
+
+NUMBER_FUNCTION(sbmGraph, 5, sbmGraph((igraph_integer_t) a[0], (int) a[1], a[2], a[3], (unsigned long) a[4]))
+NUMBER_FUNCTION(staticPowerLawGraph, 4,
+                staticPowerLawGraph((igraph_integer_t) a[0], (igraph_integer_t) a[1], a[2], (unsigned long) a[3]))
+NUMBER_FUNCTION(barabasiGraph, 3, barabasiGraph((igraph_integer_t) a[0], (igraph_integer_t) a[1], (unsigned long) a[2]))
+
+POINTER_FUNCTION(createBuffer, 1, createBuffer((int) a[0]))
+POINTER_FUNCTION(create_buffer, 2, create_buffer((int) a[0], (int) a[1]))
+VOID_FUNCTION(destroyBuffer, 1, destroyBuffer(POINTER(a[0])))
+
+POINTER_FUNCTION(createGraphLoader, 3, createGraphLoader((igraph_integer_t) a[0], (size_t) a[1], (int) a[2]))
+POINTER_FUNCTION(finishGraphLoader, 4, finishGraphLoader(POINTER(a[0]), (igraph_integer_t) a[1], (size_t) a[2],
+                                                         (int) a[3]))
+POINTER_FUNCTION(getLoadedGraphWeightsPointer, 1, getLoadedGraphWeightsPointer(POINTER(a[0])))
+VOID_FUNCTION(destroyLoadedGraph, 1, destroyLoadedGraph(POINTER(a[0])))
+
+POINTER_FUNCTION(createGraphBuilder, 0, createGraphBuilder())
+POINTER_FUNCTION(appendGraphBuilderEdges, 2, appendGraphBuilderEdges(POINTER(a[0]), (size_t) a[1]))
+NUMBER_FUNCTION(getGraphBuilderVertexCount, 1, getGraphBuilderVertexCount(POINTER(a[0])))
+NUMBER_FUNCTION(getGraphBuilderSize, 1, getGraphBuilderSize(POINTER(a[0])))
+POINTER_FUNCTION(finishGraphBuilder, 2, finishGraphBuilder(POINTER(a[0]), (igraph_integer_t) a[1]))
+VOID_FUNCTION(destroyGraphBuilder, 1, destroyGraphBuilder(POINTER(a[0])))
+POINTER_FUNCTION(createSession, 4, createSession(GRAPH_ARGS, (int) a[3]))
+NUMBER_FUNCTION(sessionAddEdges, 3, sessionAddEdges(POINTER(a[0]), POINTER(a[1]), (size_t) a[2]))
+NUMBER_FUNCTION(sessionDeleteEdges, 3, sessionDeleteEdges(POINTER(a[0]), POINTER(a[1]), (size_t) a[2]))
+NUMBER_FUNCTION(sessionDetect, 2, sessionDetect(POINTER(a[0]), (int) a[1]))
+NUMBER_FUNCTION(getSessionVertexCount, 1, getSessionVertexCount(POINTER(a[0])))
+POINTER_FUNCTION(getSessionResultPointer, 1, getSessionResultPointer(POINTER(a[0])))
+VOID_FUNCTION(destroySession, 1, destroySession(POINTER(a[0])))
+
+POINTER_FUNCTION(getMembershipPointer, 0, getMembershipPointer())
+NUMBER_FUNCTION(getMembershipModularity, 0, getMembershipModularity())
+POINTER_FUNCTION(getDendrogramPointer, 0, getDendrogramPointer())
+NUMBER_FUNCTION(getDendrogramSize, 0, getDendrogramSize())
+NUMBER_FUNCTION(getDendrogramLoglikelihood, 0, getDendrogramLoglikelihood())
+POINTER_FUNCTION(getModularitiesFoundPointer, 0, getModularitiesFoundPointer())
+NUMBER_FUNCTION(getModularitiesFoundSize, 0, getModularitiesFoundSize())
+
+POINTER_FUNCTION(getScorePointer, 0, getScorePointer())
+VOID_FUNCTION(freeScore, 0, freeScore())
+POINTER_FUNCTION(getOverlappingPointer, 0, getOverlappingPointer())
+NUMBER_FUNCTION(getOverlappingSize, 0, getOverlappingSize())
+VOID_FUNCTION(freeOverlapping, 0, freeOverlapping())
+POINTER_FUNCTION(getSweepPointer, 0, getSweepPointer())
+NUMBER_FUNCTION(getSweepSize, 0, getSweepSize())
+VOID_FUNCTION(freeSweep, 0, freeSweep())
+POINTER_FUNCTION(getConsensusPointer, 0, getConsensusPointer())
+VOID_FUNCTION(freeConsensus, 0, freeConsensus())
+POINTER_FUNCTION(getPageRankPointer, 0, getPageRankPointer())
+NUMBER_FUNCTION(getPageRankSize, 0, getPageRankSize())
+VOID_FUNCTION(freePageRank, 0, freePageRank())
+POINTER_FUNCTION(getTrianglePointer, 0, getTrianglePointer())
+VOID_FUNCTION(freeTriangles, 0, freeTriangles())
+
+POINTER_FUNCTION(getGeneratedEdgesPointer, 0, getGeneratedEdgesPointer())
+NUMBER_FUNCTION(getGeneratedEdgesSize, 0, getGeneratedEdgesSize())
+POINTER_FUNCTION(getPlantedMembershipPointer, 0, getPlantedMembershipPointer())
+
+VOID_FUNCTION(setArenaMode, 1, setArenaMode((int) a[0]))
+VOID_FUNCTION(setComponentMode, 2, setComponentMode((int) a[0], (int) a[1]))
+VOID_FUNCTION(setCorePruning, 1, setCorePruning((int) a[0]))
+VOID_FUNCTION(setEdgeWeights, 1, setEdgeWeights(POINTER(a[0])))
+VOID_FUNCTION(setRunGraph, 1, setRunGraph(POINTER(a[0])))
+NUMBER_FUNCTION(getArenaPeak, 0, getArenaPeak())
+NUMBER_FUNCTION(getArenaReserved, 0, getArenaReserved())
+
+VOID_FUNCTION(freeResult, 0, freeResult())
+VOID_FUNCTION(freeGeneratedGraph, 0, freeGeneratedGraph())
+
+// writeBuffer(pointer, Float64Array): copies the array to native memory
+static napi_value js_writeBuffer(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    size_t argc = 2;
+    double pointer;
+    napi_typedarray_type type;
+    size_t length;
+    void *data;
+
+    if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok || argc < 2 ||
+        napi_get_value_double(env, argv[0], &pointer) != napi_ok ||
+        napi_get_typedarray_info(env, argv[1], &type, &length, &data, NULL, NULL) != napi_ok ||
+        type != napi_float64_array) {
+        napi_throw_type_error(env, NULL, "writeBuffer: expected a pointer and a Float64Array");
+        return NULL;
+    }
+
+    memcpy(POINTER(pointer), data, length * sizeof(double));
+    return NULL;
+}
+
+// writeBytes(pointer, typedArray): copies the bytes of any typed array to native memory
+static napi_value js_writeBytes(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    size_t argc = 2;
+    double pointer;
+    napi_typedarray_type type;
+    size_t length;
+    void *data;
+
+    if (napi_get_cb_info(env, info, &argc, argv, NULL, NULL) != napi_ok || argc < 2 ||
+        napi_get_value_double(env, argv[0], &pointer) != napi_ok ||
+        napi_get_typedarray_info(env, argv[1], &type, &length, &data, NULL, NULL) != napi_ok ||
+        (type != napi_uint8_array && type != napi_int8_array)) {
+        napi_throw_type_error(env, NULL, "writeBytes: expected a pointer and a Uint8Array");
+        return NULL;
+    }
+
+    memcpy(POINTER(pointer), data, length);
+    return NULL;
+}
+
+// readBuffer(pointer, size): copies `size` doubles from native memory to a new Float64Array
+static napi_value js_readBuffer(napi_env env, napi_callback_info info) {
+    double a[2];
+    size_t size;
+    void *data;
+    napi_value buffer, result;
+
+    if (!get_numbers(env, info, a, 2)) return NULL;
+    size = (size_t) a[1];
+
+    if (napi_create_arraybuffer(env, size * sizeof(double), &data, &buffer) != napi_ok ||
+        napi_create_typedarray(env, napi_float64_array, size, buffer, 0, &result) != napi_ok) {
+        napi_throw_error(env, NULL, "readBuffer: cannot allocate the result");
+        return NULL;
+    }
+
+    if (size > 0) {
+        memcpy(data, POINTER(a[0]), size * sizeof(double));
+    }
+    return result;
+}
+
+#define EXPORT(name) { #name, NULL, js_##name, NULL, NULL, NULL, napi_enumerable, NULL }
+
+static napi_value init(napi_env env, napi_value exports) {
+    napi_property_descriptor properties[] = {
+        EXPORT(edgeBetweenness),
+        EXPORT(fastGreedy),
+        EXPORT(infomap),
+        EXPORT(labelPropagation),
+        EXPORT(leadingEigenvector),
+        EXPORT(louvain),
+        EXPORT(leiden),
+        EXPORT(optimal),
+        EXPORT(spinglass),
+        EXPORT(walktrap),
+        EXPORT(fluidCommunities),
+        EXPORT(hrg),
+        EXPORT(spectral),
+
+        EXPORT(fastGreedySeed),
+        EXPORT(louvainSeed),
+        EXPORT(edgeBetweennessSeed),
+
+        EXPORT(compareCommunitiesNMI),
+        EXPORT(compareCommunitiesRI),
+        EXPORT(compareCommunitiesARI),
+
+        EXPORT(scoreMembership),
+        EXPORT(cliquePercolation),
+        EXPORT(resolutionSweep),
+        EXPORT(consensusCommunities),
+        EXPORT(personalizedPageRank),
+        EXPORT(localCommunities),
+        EXPORT(countTriangles),
+
+        EXPORT(sbmGraph),
+        EXPORT(staticPowerLawGraph),
+        EXPORT(barabasiGraph),
+
+        EXPORT(createBuffer),
+        EXPORT(create_buffer),
+        EXPORT(destroyBuffer),
+        EXPORT(writeBuffer),
+        EXPORT(writeBytes),
+        EXPORT(createGraphLoader),
+        EXPORT(finishGraphLoader),
+        EXPORT(getLoadedGraphWeightsPointer),
+        EXPORT(destroyLoadedGraph),
+
+        EXPORT(createGraphBuilder),
+        EXPORT(appendGraphBuilderEdges),
+        EXPORT(getGraphBuilderVertexCount),
+        EXPORT(getGraphBuilderSize),
+        EXPORT(finishGraphBuilder),
+        EXPORT(destroyGraphBuilder),
+        EXPORT(createSession),
+        EXPORT(sessionAddEdges),
+        EXPORT(sessionDeleteEdges),
+        EXPORT(sessionDetect),
+        EXPORT(getSessionVertexCount),
+        EXPORT(getSessionResultPointer),
+        EXPORT(destroySession),
+        EXPORT(readBuffer),
+
+        EXPORT(getMembershipPointer),
+        EXPORT(getMembershipModularity),
+        EXPORT(getDendrogramPointer),
+        EXPORT(getDendrogramSize),
+        EXPORT(getDendrogramLoglikelihood),
+        EXPORT(getModularitiesFoundPointer),
+        EXPORT(getModularitiesFoundSize),
+
+        EXPORT(getScorePointer),
+        EXPORT(freeScore),
+        EXPORT(getOverlappingPointer),
+        EXPORT(getOverlappingSize),
+        EXPORT(freeOverlapping),
+        EXPORT(getSweepPointer),
+        EXPORT(getSweepSize),
+        EXPORT(freeSweep),
+        EXPORT(getConsensusPointer),
+        EXPORT(freeConsensus),
+        EXPORT(getPageRankPointer),
+        EXPORT(getPageRankSize),
+        EXPORT(freePageRank),
+        EXPORT(getTrianglePointer),
+        EXPORT(freeTriangles),
+
+        EXPORT(getGeneratedEdgesPointer),
+        EXPORT(getGeneratedEdgesSize),
+        EXPORT(getPlantedMembershipPointer),
+
+        EXPORT(setArenaMode),
+        EXPORT(setComponentMode),
+        EXPORT(setCorePruning),
+        EXPORT(setEdgeWeights),
+        EXPORT(setRunGraph),
+        EXPORT(getArenaPeak),
+        EXPORT(getArenaReserved),
+
+        EXPORT(freeResult),
+        EXPORT(freeGeneratedGraph)
+    };
+
+    igraph_set_error_handler(native_error_handler);
+
+    if (napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties) != napi_ok) {
+        return NULL;
+    }
+    return exports;
+}
+
+NAPI_MODULE(community_detection, init)
@@ -0,0 +1,71 @@
+const { getAPI } = require('../../index');
+
+// Usage: node OPTIMAL-modularity-benchmark.js [maxN] [--asm]
+// Connected graphs above maxN are skipped, one of 90 vertices already takes minutes; the disconnected ones split
+// into components of 20 vertices and are solved at every size
+const MAX_N = Number(process.argv[2]) || 60;
+const SIZES = [30, 60, 90, 120, 150];
+const COMMUNITY_SIZE = 10;
+const P_IN = 0.3;
+const P_OUT = 0.02;
+
+getAPI({ wasm: !process.argv.includes('--asm') }).then((api) => {
+    const { runCommunityDetection } = api;
+
+    SIZES.forEach((n) => {
+        [false, true].forEach((disconnected) => {
+            if (!disconnected && n > MAX_N) {
+                return;
+            }
+
+            const edges = plantedPartitionGraph(n, disconnected, n);
+
+            const start = process.hrtime();
+            const { modularity } = runCommunityDetection('optimal', n, edges);
+            const [s, ns] = process.hrtime(start);
+
+            console.log(
+                `n: ${n}; m: ${edges.length / 2}; ${disconnected ? 'disconnected' : 'connected'}; ` +
+                `modularity: ${modularity.toFixed(4)}; time: ${(s + ns / 1e9).toFixed(3)}s`
+            );
+        });
+    });
+});
+
+// Groups of COMMUNITY_SIZE vertices; in the disconnected variant only
+// pairs of neighbouring groups are linked, giving n / 20 components.
+function plantedPartitionGraph(n, disconnected, seed) {
+    const random = mulberry32(seed);
+    const edges = [];
+
+    for (let i = 0; i < n; i++) {
+        for (let j = i + 1; j < n; j++) {
+            const gi = Math.floor(i / COMMUNITY_SIZE);
+            const gj = Math.floor(j / COMMUNITY_SIZE);
+            let p = P_OUT;
+
+            if (gi === gj) {
+                p = P_IN;
+            } else if (disconnected && !(gj - gi === 1 && gi % 2 === 0)) {
+                p = 0;
+            }
+
+            if (random() < p) {
+                edges.push(i, j);
+            }
+        }
+    }
+
+    return edges;
+}
+
+// Small seeded PRNG so every run benchmarks the same graphs
+function mulberry32(seed) {
+    let a = seed;
+    return () => {
+        a = (a + 0x6D2B79F5) | 0;
+        let t = Math.imul(a ^ (a >>> 15), 1 | a);
+        t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
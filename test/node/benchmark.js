@@ -0,0 +1,212 @@
+const fs = require('fs');
+const path = require('path');
+const { fork } = require('child_process');
+const { getAPI, ALL_ALGORITHM_NAMES, SEED_ALGORITHM_NAMES } = require('../../index');
+const { version } = require('../../package.json');
+
+// Usage: node benchmark.js [--out report.json] [--sizes 50,500,5000] [--builds wasm-simd,wasm,asm,native] [--timeout 300]
+//
+// Every (build, graph, algorithm) run happens in a fresh child process, so the reported
+// heap size is the peak of that single run and a crash or timeout does not stop the suite.
+// `backend` in the results is the module actually loaded, wasm-simd falls back to wasm
+// when the engine has no SIMD support or the SIMD build is missing. A build that cannot load
+// or lacks the graph generators is skipped with one message and listed in the report.
+
+const DEFAULT_SIZES = [50, 500, 5000];
+const DEFAULT_BUILDS = ['wasm', 'asm', 'native'];
+const DEFAULT_TIMEOUT_S = 300;
+const SEED = 42;
+
+// Larger graphs would take hours with these algorithms
+const MAX_N = {
+    edgeBetweenness: 500,
+    edgeBetweennessSeed: 500,
+    spinglass: 500,
+    hrg: 500
+};
+
+// Exact optimal modularity takes minutes from 50 vertices of the power law graphs on, it runs once per build on the
+// planted partition graph of OPTIMAL_N vertices instead of the sizes
+const OPTIMAL_N = 30;
+
+// Every 10th vertex of the planted partition is revealed to the seed algorithms
+const SEED_STEP = 10;
+
+if (process.argv[2] === '--child') {
+    process.on('message', (job) => {
+        (job.probe ? probeBuild(job) : runJob(job)).then((result) => process.send(result));
+    });
+} else {
+    runSuite(parseArgs(process.argv.slice(2)));
+}
+
+function parseArgs(argv) {
+    const args = {
+        out: 'benchmark-report.json',
+        sizes: DEFAULT_SIZES,
+        builds: DEFAULT_BUILDS,
+        timeout: DEFAULT_TIMEOUT_S
+    };
+
+    for (let i = 0; i < argv.length; i += 2) {
+        const value = argv[i + 1];
+        switch (argv[i]) {
+            case '--out':
+                args.out = value;
+                break;
+            case '--sizes':
+                args.sizes = value.split(',').map(Number);
+                break;
+            case '--builds':
+                args.builds = value.split(',');
+                break;
+            case '--timeout':
+                args.timeout = Number(value);
+                break;
+            default:
+                throw new Error(`Unknown argument: ${argv[i]}`);
+        }
+    }
+
+    return args;
+}
+
+function graphSpecs(n) {
+    const blocks = Math.max(2, Math.round(n / 50));
+    return [
+        { generator: 'sbm', n, options: { blocks, pIn: 0.3, pOut: 2 / n, seed: SEED } },
+        { generator: 'staticPowerLaw', n, options: { m: 5 * n, exponent: 2.5, seed: SEED } },
+        { generator: 'barabasi', n, options: { m: 5, seed: SEED } }
+    ];
+}
+
+async function runSuite({ out, sizes, builds, timeout }) {
+    const results = [];
+    const skippedBuilds = [];
+
+    for (const build of builds) {
+        const { error } = await runInChild({ build, probe: true }, timeout * 1000);
+        if (error) {
+            console.log(`${build}: skipped, ${error}`);
+            skippedBuilds.push({ build, error });
+            continue;
+        }
+
+        const jobs = [{ build, graph: graphSpecs(OPTIMAL_N)[0], algorithm: 'optimal' }];
+        for (const n of sizes) {
+            for (const graph of graphSpecs(n)) {
+                for (const algorithm of ALL_ALGORITHM_NAMES) {
+                    if (algorithm !== 'optimal' && !(MAX_N[algorithm] && n > MAX_N[algorithm])) {
+                        jobs.push({ build, graph, algorithm });
+                    }
+                }
+            }
+        }
+
+        for (const job of jobs) {
+            const result = await runInChild(job, timeout * 1000);
+            results.push(result);
+            printResult(result);
+        }
+    }
+
+    const report = {
+        version,
+        node: process.version,
+        createdAt: new Date().toISOString(),
+        sizes,
+        builds,
+        skippedBuilds,
+        timeoutSeconds: timeout,
+        results
+    };
+
+    fs.writeFileSync(path.resolve(out), JSON.stringify(report, null, 2));
+    console.log(`\nReport written to ${path.resolve(out)}`);
+}
+
+function runInChild(job, timeoutMs) {
+    return new Promise((resolve) => {
+        const child = fork(__filename, ['--child'], { stdio: ['ignore', 'ignore', 'pipe', 'ipc'] });
+        let stderr = '';
+        let done = false;
+
+        const finish = (result) => {
+            if (!done) {
+                done = true;
+                clearTimeout(timer);
+                child.kill();
+                resolve({ ...job, ...result });
+            }
+        };
+
+        const timer = setTimeout(() => finish({ error: `timeout after ${timeoutMs / 1000}s` }), timeoutMs);
+
+        child.stderr.on('data', (data) => { stderr += data; });
+        child.on('message', finish);
+        child.on('exit', (code) => finish({ error: `exited with code ${code}: ${stderr.trim().split('\n')[0].slice(0, 300)}` }));
+        child.send(job);
+    });
+}
+
+// Whether the build loads and has the generators of the graphs; older bundles predate them
+async function probeBuild({ build }) {
+    try {
+        const { generateGraph } = await getAPI({ backend: build });
+        graphSpecs(OPTIMAL_N).forEach((graph) => generateGraph(graph.generator, graph.n, graph.options));
+        return {};
+    } catch (e) {
+        return { error: e.message };
+    }
+}
+
+async function runJob({ build, graph, algorithm }) {
+    const api = await getAPI({ backend: build });
+    const { runCommunityDetection, compareCommunities, generateGraph, getHeapSize } = api;
+
+    const { n, edges, plantedMembership } = generateGraph(graph.generator, graph.n, graph.options);
+
+    const options = {};
+    if (SEED_ALGORITHM_NAMES.includes(algorithm)) {
+        options.seedMembership = plantedMembership
+            ? plantedMembership.map((c, i) => (i % SEED_STEP === 0 ? c : -1))
+            : new Array(n).fill(-1);
+    }
+
+    if (algorithm === 'hrg') {
+        options.hrgOptions = { seed: SEED };
+    }
+
+    if (algorithm === 'fluidCommunities' || algorithm === 'spectral') {
+        // The planted number of communities, as many as the sbm graph of the same size has otherwise
+        const communities = graph.options.blocks || Math.max(2, Math.round(n / 50));
+        options.fluidOptions = { communities, seed: SEED };
+        options.spectralOptions = { communities, seed: SEED };
+    }
+
+    const start = process.hrtime();
+    const { membership, modularity } = runCommunityDetection(algorithm, n, edges, options);
+    const [s, ns] = process.hrtime(start);
+
+    return {
+        backend: api.backend,
+        m: edges.length / 2,
+        timeMs: (s * 1e3) + (ns / 1e6),
+        heapBytes: getHeapSize(),
+        modularity,
+        nmi: plantedMembership ? compareCommunities('NMI', plantedMembership, membership) : null
+    };
+}
+
+function printResult({ build, backend, graph, algorithm, m, timeMs, heapBytes, modularity, nmi, error }) {
+    const loaded = backend && backend !== build ? ` (${backend})` : '';
+    const prefix = `${build}${loaded} ${graph.generator} n=${graph.n} ${algorithm}:`;
+    if (error) {
+        console.log(`${prefix} ERROR ${error}`);
+    } else {
+        console.log(
+            `${prefix} m=${m} time=${timeMs.toFixed(1)}ms heap=${(heapBytes / 2 ** 20).toFixed(1)}MB ` +
+            `modularity=${modularity.toFixed(4)}${nmi === null ? '' : ` NMI=${nmi.toFixed(4)}`}`
+        );
+    }
+}
@@ -1,13 +1,14 @@
 const { ZKC } = require('../graphs');
 const { printAlgorithmName } = require('../utils');
-const { getAPI, IGRAPH_ALGORITHM_NAMES, SEED_ALGORITHM_NAMES, COMPARE_COMMUNITIES_METHODS } = require('../../index');
+const { getAPI, writeBinaryGraph, IGRAPH_ALGORITHM_NAMES, SEED_ALGORITHM_NAMES, COMPARE_COMMUNITIES_METHODS } = require('../../index');
 
 const progressHandler = (percent) => {
     console.log('PROGRESS handler test: ' + percent);
 };
 
-getAPI({ wasm: true }).then((api) => {
-    const { runCommunityDetection, compareCommunities } = api;
+// Usage: node test_api.js [wasm|asm|native]
+getAPI({ backend: process.argv[2] || 'wasm' }).then(async (api) => {
+    const { runCommunityDetection, compareCommunities, scoreMembership, cliquePercolation, resolutionSweep, consensusCommunities, personalizedPageRank, pageRankCommunities, localCommunities, countTriangles, getArenaStats, loadBinaryGraph, createGraphBuilder, createSession, freeGraph } = api;
     const { n, edges, groundTruthMembership } = ZKC;
     const getCompareMeasures = (m1, m2) => ({
         nmi: compareCommunities(COMPARE_COMMUNITIES_METHODS.NMI, m1, m2),
@@ -19,7 +20,12 @@ getAPI({ wasm: true }).then((api) => {
 
     IGRAPH_ALGORITHM_NAMES.forEach((name) => {
         printAlgorithmName(name);
-        const { modularity, membership } = runCommunityDetection(name, n, edges);
+        const options = {
+            fluidCommunities: { fluidOptions: { communities: 2, seed: 42 } },
+            hrg: { hrgOptions: { seed: 42 } },
+            spectral: { spectralOptions: { communities: 2, seed: 42 } }
+        }[name] || {};
+        const { modularity, membership } = runCommunityDetection(name, n, edges, options);
         const {nmi, ri, ari} = getCompareMeasures(groundTruthMembership, membership);
         console.log(`membership: [${membership}]`);
         console.log(`modularity: ${modularity}`);
@@ -28,6 +34,10 @@ getAPI({ wasm: true }).then((api) => {
 
     const seedMembership = new Array(n).fill(-1);
 
+    console.log('\n\n>>> Ground truth score');
+
+    console.log(JSON.stringify(scoreMembership({ n, edges }, groundTruthMembership)));
+
     console.log('\n\n>>> Sanity checks (all seeds == -1)');
 
     [ 'fastGreedy', 'fastGreedySeed', 'louvain', 'louvainSeed','edgeBetweenness','edgeBetweennessSeed'].forEach((name) => {
@@ -53,6 +63,183 @@ getAPI({ wasm: true }).then((api) => {
         console.log(`NMI: ${nmi}; RI: ${ri}; ARI: ${ari}`);
     });
 
+    console.log('\n\n>>> ARPACK options');
+
+    printAlgorithmName('leadingEigenvector');
+    const { modularity, membership } = runCommunityDetection('leadingEigenvector', n, edges, {
+        arpackOptions: { tol: 1e-6, ncv: 10 }
+    });
+    console.log(`membership: [${membership}]`);
+    console.log(`modularity: ${modularity}`);
+
+    console.log('\n\n>>> Semi-synchronous label propagation');
+
+    printAlgorithmName('labelPropagation');
+    const labelPropagationResult = runCommunityDetection('labelPropagation', n, edges, {
+        labelPropagationOptions: { semiSynchronous: true }
+    });
+    console.log(`membership: [${labelPropagationResult.membership}]`);
+    console.log(`modularity: ${labelPropagationResult.modularity}`);
+
+    console.log('\n\n>>> Semi-synchronous fluid communities');
+
+    printAlgorithmName('fluidCommunities');
+    const fluidResult = runCommunityDetection('fluidCommunities', n, edges, {
+        fluidOptions: { communities: 2, seed: 42, semiSynchronous: true }
+    });
+    console.log(`membership: [${fluidResult.membership}]`);
+    console.log(`modularity: ${fluidResult.modularity}`);
+
+    // A whole community moving within one color class emptied it in the first case, labels oscillated forever in the
+    // second one
+    [{ size: 28, communities: 10, seed: 2008, graphSeed: 8 }, { size: 21, communities: 11, seed: 2021, graphSeed: 21 }]
+        .forEach(({ size, communities, seed, graphSeed }) => {
+            const graph = api.generateGraph('barabasi', size, { m: 2, seed: graphSeed });
+            const { membership } = runCommunityDetection('fluidCommunities', size, graph.edges, {
+                fluidOptions: { communities, seed, semiSynchronous: true }
+            });
+            console.log(`n: ${size}; communities: ${new Set(membership).size} of ${communities}`);
+        });
+
+    console.log('\n\n>>> Spinglass replicas');
+
+    printAlgorithmName('spinglass');
+    const spinglassResult = runCommunityDetection('spinglass', n, edges, {
+        spinglassOptions: { replicas: 4 }
+    });
+    console.log(`membership: [${spinglassResult.membership}]`);
+    console.log(`modularity: ${spinglassResult.modularity}`);
+    console.log(`replica modularities: [${spinglassResult.modularitiesFound}]`);
+
+    console.log('\n\n>>> HRG consensus tree');
+
+    printAlgorithmName('hrg');
+    const { dendrogram } = runCommunityDetection('hrg', n, edges, { hrgOptions: { chains: 2, samples: 50, seed: 42 } });
+    console.log(`parents: [${dendrogram.parents}]`);
+    console.log(`weights: [${dendrogram.weights}]`);
+    console.log(`log-likelihood: ${dendrogram.logLikelihood}`);
+
+    console.log('\n\n>>> Clique percolation');
+
+    const percolation = cliquePercolation({ n, edges }, 3);
+    console.log(`count: ${percolation.count}`);
+    console.log(`offsets: [${percolation.offsets}]`);
+    console.log(`communities: [${percolation.communities}]`);
+
+    console.log('\n\n>>> Resolution sweep');
+
+    const sweep = resolutionSweep({ n, edges }, [0.05, 0.1, 0.2, 0.5], { objective: 'cpm', stableSteps: 2 });
+    console.log(`resolutions: [${sweep.resolutions}]`);
+    console.log(`communities: [${sweep.communities}]`);
+    console.log(`modularity: [${sweep.modularity}]`);
+
+    console.log('\n\n>>> Consensus clustering');
+
+    const consensus = consensusCommunities({ n, edges }, 'labelPropagation', { replicates: 30, seed: 42 });
+    console.log(`membership: [${consensus.membership}]`);
+    console.log(`modularity: ${consensus.modularity}`);
+    console.log(`stability: [${consensus.stability.map((s) => s.toFixed(2))}]`);
+
+    console.log('\n\n>>> Arena allocation');
+
+    printAlgorithmName('louvain');
+    const arenaResult = runCommunityDetection('louvain', n, edges, { useArena: true });
+    const { peakBytes, reservedBytes } = getArenaStats();
+    console.log(`membership: [${arenaResult.membership}]`);
+    console.log(`modularity: ${arenaResult.modularity}`);
+    console.log(`arena peak: ${peakBytes}; reserved: ${reservedBytes}`);
+
+    console.log('\n\n>>> Connected components');
+
+    // Two copies of the karate club, a single edge and an isolated vertex
+    const componentsN = 2 * n + 3;
+    const componentsEdges = edges.concat(edges.map((v) => v + n), [2 * n, 2 * n + 1]);
+
+    printAlgorithmName('spinglass');
+    const componentsResult = runCommunityDetection('spinglass', componentsN, componentsEdges, { perComponent: true });
+    console.log(`membership: [${componentsResult.membership}]`);
+    console.log(`modularity: ${componentsResult.modularity}`);
+
+    console.log('\n\n>>> k-core pruning');
+
+    // A path hanging off vertex 0 and a triangle with a tail apart from the karate club
+    const coreN = n + 8;
+    const coreEdges = edges.concat([0, n, n, n + 1, n + 1, n + 2, n + 3, n + 4, n + 4, n + 5, n + 5, n + 3, n + 5, n + 6]);
+
+    printAlgorithmName('walktrap');
+    const coreResult = runCommunityDetection('walktrap', coreN, coreEdges, { kCore: 2 });
+    console.log(`membership: [${coreResult.membership}]`);
+    console.log(`modularity: ${coreResult.modularity}`);
+
+    console.log('\n\n>>> Personalized PageRank');
+
+    const scores = personalizedPageRank({ n, edges }, [[0], [33]]);
+    console.log(`score sums: ${scores.subarray(0, n).reduce((a, b) => a + b).toFixed(6)} ${scores.subarray(n).reduce((a, b) => a + b).toFixed(6)}`);
+    pageRankCommunities({ n, edges }, [[0], [33]]).forEach(({ vertices, conductance }) => {
+        console.log(`community: [${Array.from(vertices).sort((a, b) => a - b)}]; conductance: ${conductance}`);
+    });
+
+    console.log('\n\n>>> Local communities');
+
+    localCommunities({ n, edges }, [[0], [33]]).forEach(({ vertices, conductance }) => {
+        console.log(`community: [${Array.from(vertices).sort((a, b) => a - b)}]; conductance: ${conductance}`);
+    });
+
+    console.log('\n\n>>> Triangles');
+
+    const { count, vertexTriangles, clustering, edgeTriangles } = countTriangles({ n, edges });
+    console.log(`triangles: ${count}; of vertex 0: ${vertexTriangles[0]}; clustering of vertex 0: ${clustering[0]}`);
+
+    printAlgorithmName('louvain');
+    const weightedResult = runCommunityDetection('louvain', n, edges, { edgeWeights: edgeTriangles.map((t) => t + 1) });
+    console.log(`membership: [${weightedResult.membership}]`);
+    console.log(`modularity: ${weightedResult.modularity}`);
+
+    console.log('\n\n>>> Dynamic graph session');
+
+    const session = createSession({ n, edges });
+    const initial = session.detect();
+    // Vertex 16 loses its edges to 5 and 6 and joins the other faction
+    const removed = session.removeEdges([16, 5, 16, 6]);
+    session.addEdges([16, 32, 16, 33, 16, 30]);
+    const updated = session.detect();
+    console.log(`removed: ${removed}`);
+    console.log(`community of 16: ${initial.membership[16] === initial.membership[33]} -> ${updated.membership[16] === updated.membership[33]}`);
+    console.log(`moved: ${updated.moved}`);
+    session.free();
+
+    console.log('\n\n>>> Binary graph');
+
+    printAlgorithmName('louvain');
+    const binaryGraph = await loadBinaryGraph(writeBinaryGraph(n, edges));
+    const binaryResult = runCommunityDetection('louvain', binaryGraph.n, binaryGraph);
+    freeGraph(binaryGraph);
+    console.log(`membership: [${binaryResult.membership}]`);
+    console.log(`modularity: ${binaryResult.modularity}`);
+
+    printAlgorithmName('louvain (weights section)');
+    const binaryWeights = Array.from({ length: edges.length / 2 }, (_, e) => 1 + (e % 3));
+    const weightedGraph = await loadBinaryGraph(writeBinaryGraph(n, edges, binaryWeights));
+    const weightedBinaryResult = runCommunityDetection('louvain', weightedGraph.n, weightedGraph);
+    console.log(`weighted: ${weightedGraph.weighted}`);
+    console.log(`modularity: ${weightedBinaryResult.modularity}`);
+    console.log(`scored: ${scoreMembership(weightedGraph, weightedBinaryResult.membership, ['modularity']).modularity}`);
+    console.log(`triangles: ${countTriangles(weightedGraph).count}`);
+    freeGraph(weightedGraph);
+
+    console.log('\n\n>>> Graph builder');
+
+    printAlgorithmName('louvain');
+    const builder = createGraphBuilder();
+    for (let i = 0; i < edges.length; i += 20) {
+        builder.appendEdges(edges.slice(i, i + 20));
+    }
+    const builtGraph = builder.finalize(n);
+    const builtResult = runCommunityDetection('louvain', builtGraph.n, builtGraph);
+    freeGraph(builtGraph);
+    console.log(`membership: [${builtResult.membership}]`);
+    console.log(`modularity: ${builtResult.modularity}`);
+
     console.log();
     runCommunityDetection('fastGreedy', n, edges, { progressHandler });
 });